@@ -75,7 +75,9 @@ SOURCES += \
     codesnippetsmanager.cpp \
     colorscheme.cpp \
     compiler/compilerinfo.cpp \
+    compiler/compilerprobe.cpp \
     compiler/ojproblemcasesrunner.cpp \
+    compiler/projectbuilder.cpp \
     compiler/projectcompiler.cpp \
     compiler/runner.cpp \
     customfileiconprovider.cpp \
@@ -91,6 +93,7 @@ SOURCES += \
     parser/cpptokenizer.cpp \
     parser/parserutils.cpp \
     parser/statementmodel.cpp \
+    problems/competitivecompanionreceiver.cpp \
     problems/ojproblemset.cpp \
     problems/problemcasevalidator.cpp \
     project.cpp \
@@ -206,10 +209,12 @@ HEADERS += \
     colorscheme.h \
     compiler/compiler.h \
     compiler/compilerinfo.h \
+    compiler/compilerprobe.h \
     compiler/compilermanager.h \
     compiler/executablerunner.h \
     compiler/filecompiler.h \
     compiler/ojproblemcasesrunner.h \
+    compiler/projectbuilder.h \
     compiler/projectcompiler.h \
     compiler/runner.h \
     compiler/stdincompiler.h \
@@ -221,6 +226,7 @@ HEADERS += \
     parser/cpptokenizer.h \
     parser/parserutils.h \
     parser/statementmodel.h \
+    problems/competitivecompanionreceiver.h \
     problems/ojproblemset.h \
     problems/problemcasevalidator.h \
     project.h \
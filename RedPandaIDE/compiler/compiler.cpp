@@ -25,6 +25,7 @@
 #include <QTextCodec>
 #include <QTime>
 #include <QApplication>
+#include <QEventLoop>
 #include "../editor.h"
 #include "../mainwindow.h"
 #include "../editorlist.h"
@@ -33,8 +34,6 @@
 #include "qt_utils/charsetinfo.h"
 #include "../project.h"
 
-#define COMPILE_PROCESS_END "---//END//----"
-
 Compiler::Compiler(const QString &filename, bool silent, bool onlyCheckSyntax):
     QThread(),
     mSilent(silent),
@@ -61,7 +60,7 @@ void Compiler::run()
         mWarningCount = 0;
         QElapsedTimer timer;
         timer.start();
-        runCommand(mCompiler, mArguments, mDirectory, pipedText());
+        doCompile();
         log("");
         log(tr("Compile Result:"));
         log("------------------");
@@ -79,6 +78,11 @@ void Compiler::run()
 
 }
 
+void Compiler::doCompile()
+{
+    runCommand(mCompiler, mArguments, mDirectory, pipedText());
+}
+
 QString Compiler::getFileNameFromOutputLine(QString &line) {
     QString temp;
     line = line.trimmed();
@@ -298,6 +302,7 @@ void Compiler::processOutput(QString &line)
 void Compiler::stopCompile()
 {
     mStop = true;
+    emit stopRequested();
 }
 
 QString Compiler::getCharsetArgument(const QByteArray& encoding,FileType fileType, bool checkSyntax)
@@ -635,28 +640,14 @@ bool Compiler::parseForceUTF8ForAutolink(const QString &filename, QSet<QString>
     return false;
 }
 
-void Compiler::runCommand(const QString &cmd, const QString  &arguments, const QString &workingDir, const QByteArray& inputText)
+bool Compiler::runCommand(const QString &cmd, const QString  &arguments, const QString &workingDir, const QByteArray& inputText)
 {
     QProcess process;
     mStop = false;
     bool errorOccurred = false;
+    int errorCount = mErrorCount;
     process.setProgram(cmd);
-    QString cmdDir = extractFileDir(cmd);
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    if (!cmdDir.isEmpty()) {
-        QString path = env.value("PATH");
-        if (path.isEmpty()) {
-            path = cmdDir;
-        } else {
-            path = cmdDir + PATH_SEPARATOR + path;
-        }
-        env.insert("PATH",path);
-    }
-    env.insert("LANG","en");
-    env.insert("LDFLAGS","-Wl,--stack,12582912");
-    env.insert("CFLAGS","");
-    env.insert("CXXFLAGS","");
-    process.setProcessEnvironment(env);
+    process.setProcessEnvironment(commandEnvironment(cmd));
     process.setArguments(splitProcessCommand(arguments));
     process.setWorkingDirectory(workingDir);
 
@@ -664,11 +655,22 @@ void Compiler::runCommand(const QString &cmd, const QString  &arguments, const Q
                     [&](){
                         errorOccurred= true;
                     });
-    process.connect(&process, &QProcess::readyReadStandardError,[&process,this](){
+    //only pass complete lines to processOutput(), or messages from parallel jobs
+    //may be broken at the pipe buffer boundary
+    QByteArray errorBuffer;
+    auto flushErrorLines = [&errorBuffer,this](bool all){
+        int pos = all?errorBuffer.length():errorBuffer.lastIndexOf('\n')+1;
+        if (pos<=0)
+            return;
         if (compilerSet()->compilerType() == COMPILER_CLANG)
-            this->error(QString::fromUtf8(process.readAllStandardError()));
+            this->error(QString::fromUtf8(errorBuffer.left(pos)));
         else
-            this->error(QString::fromLocal8Bit( process.readAllStandardError()));
+            this->error(QString::fromLocal8Bit(errorBuffer.left(pos)));
+        errorBuffer.remove(0,pos);
+    };
+    process.connect(&process, &QProcess::readyReadStandardError,[&process,&errorBuffer,&flushErrorLines](){
+        errorBuffer.append(process.readAllStandardError());
+        flushErrorLines(false);
     });
     process.connect(&process, &QProcess::readyReadStandardOutput,[&process,this](){
         if (compilerSet()->compilerType() == COMPILER_CLANG)
@@ -676,30 +678,28 @@ void Compiler::runCommand(const QString &cmd, const QString  &arguments, const Q
         else
             this->log(QString::fromLocal8Bit( process.readAllStandardOutput()));
     });
-    process.connect(&process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),[this](){
+    process.connect(&process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),[&process,&errorBuffer,&flushErrorLines,this](){
+        errorBuffer.append(process.readAllStandardError());
+        flushErrorLines(true);
         this->error(COMPILE_PROCESS_END);
     });
+    QEventLoop loop;
+    process.connect(&process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                    &loop, &QEventLoop::quit);
+    process.connect(&process, &QProcess::errorOccurred,
+                    &loop, &QEventLoop::quit);
+    //stop requests come from other threads, they are queued to this thread's loop
+    connect(this, &Compiler::stopRequested, &process, [&process](){
+        process.terminate();
+    });
     process.start();
     process.waitForStarted(5000);
-    if (!inputText.isEmpty()) {
-        process.write(inputText);
-        process.waitForFinished(0);
-    }
-    bool writeChannelClosed = false;
-    while (true) {
-        if (process.bytesToWrite()==0 && !writeChannelClosed ) {
-            writeChannelClosed=true;
-            process.closeWriteChannel();
-        }
-        process.waitForFinished(100);
-        if (process.state()!=QProcess::Running) {
-            break;
-        }
-        if (mStop) {
-            process.terminate();
-        }
-        if (errorOccurred)
-            break;
+    if (process.state()==QProcess::Running) {
+        //the write channel is closed after all pending data is written
+        if (!inputText.isEmpty())
+            process.write(inputText);
+        process.closeWriteChannel();
+        loop.exec();
     }
     if (errorOccurred) {
         switch (process.error()) {
@@ -723,6 +723,52 @@ void Compiler::runCommand(const QString &cmd, const QString  &arguments, const Q
             throw CompileError(tr("An unknown error occurred."));
         }
     }
+    if (mStop)
+        return false;
+    if (process.exitStatus()!=QProcess::NormalExit || process.exitCode()!=0) {
+        commandFailed(cmd, process.exitCode(),
+                      process.exitStatus()!=QProcess::NormalExit, errorCount);
+        return false;
+    }
+    return true;
+}
+
+void Compiler::commandFailed(const QString &cmd, int exitCode, bool crashed, int errorCountBefore)
+{
+    //the command's own error messages are enough
+    if (mErrorCount>errorCountBefore)
+        return;
+    mErrorCount++;
+    PCompileIssue issue = std::make_shared<CompileIssue>();
+    issue->line = 0;
+    issue->column = -1;
+    issue->endColumn = -1;
+    issue->type = CompileIssueType::Error;
+    if (crashed)
+        issue->description = tr("'%1' crashed.").arg(extractFileName(cmd));
+    else
+        issue->description = tr("'%1' exited with code %2.").arg(extractFileName(cmd)).arg(exitCode);
+    emit compileIssue(issue);
+}
+
+QProcessEnvironment Compiler::commandEnvironment(const QString &cmd)
+{
+    QString cmdDir = extractFileDir(cmd);
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    if (!cmdDir.isEmpty()) {
+        QString path = env.value("PATH");
+        if (path.isEmpty()) {
+            path = cmdDir;
+        } else {
+            path = cmdDir + PATH_SEPARATOR + path;
+        }
+        env.insert("PATH",path);
+    }
+    env.insert("LANG","en");
+    env.insert("LDFLAGS","-Wl,--stack,12582912");
+    env.insert("CFLAGS","");
+    env.insert("CXXFLAGS","");
+    return env;
 }
 
 const std::shared_ptr<Project> &Compiler::project() const
@@ -18,10 +18,13 @@
 #define COMPILER_H
 
 #include <QThread>
+#include <QProcessEnvironment>
 #include "settings.h"
 #include "../common.h"
 #include "../parser/cppparser.h"
 
+#define COMPILE_PROCESS_END "---//END//----"
+
 class Project;
 class Compiler : public QThread
 {
@@ -48,6 +51,8 @@ signals:
     void compileOutput(const QString& msg);
     void compileIssue(PCompileIssue issue);
     void compileErrorOccured(const QString& reason);
+    //emitted by stopCompile(), to wake up the event loops waiting for processes
+    void stopRequested();
 public slots:
     void stopCompile();
 
@@ -81,7 +86,12 @@ protected:
             PCppParser& parser);
     void log(const QString& msg);
     void error(const QString& msg);
-    void runCommand(const QString& cmd, const QString& arguments, const QString& workingDir, const QByteArray& inputText=QByteArray());
+    //returns false if the command fails or is stopped
+    bool runCommand(const QString& cmd, const QString& arguments, const QString& workingDir, const QByteArray& inputText=QByteArray());
+    //report a failed command that didn't print any error we can recognize
+    void commandFailed(const QString& cmd, int exitCode, bool crashed, int errorCountBefore);
+    QProcessEnvironment commandEnvironment(const QString& cmd);
+    virtual void doCompile();
 
 protected:
     bool mSilent;
@@ -96,8 +106,6 @@ protected:
     QString mDirectory;
     bool mRebuild;
     std::shared_ptr<Project> mProject;
-
-private:
     bool mStop;
 };
 
@@ -25,6 +25,7 @@
 #include <QMessageBox>
 #include <QUuid>
 #include "projectcompiler.h"
+#include "projectbuilder.h"
 #include "qt_utils/charsetinfo.h"
 
 enum RunProgramFlag {
@@ -113,7 +114,11 @@ void CompilerManager::compileProject(std::shared_ptr<Project> project, bool rebu
         mCompileErrorCount = 0;
         mCompileIssueCount = 0;
         //deleted when thread finished
-        mCompiler = new ProjectCompiler(project,silent,onlyCheckSyntax);
+        if (pSettings->environment().useBuiltinProjectBuilder()
+                && ProjectBuilder::canBuild(project))
+            mCompiler = new ProjectBuilder(project,silent,onlyCheckSyntax);
+        else
+            mCompiler = new ProjectCompiler(project,silent,onlyCheckSyntax);
         mCompiler->setRebuild(rebuild);
         connect(mCompiler, &Compiler::finished, mCompiler, &QObject::deleteLater);
         connect(mCompiler, &Compiler::compileFinished, this, &CompilerManager::onCompileFinished);
@@ -145,7 +150,12 @@ void CompilerManager::cleanProject(std::shared_ptr<Project> project)
         mCompileErrorCount = 0;
         mCompileIssueCount = 0;
         //deleted when thread finished
-        ProjectCompiler* compiler = new ProjectCompiler(project,false,false);
+        ProjectCompiler* compiler;
+        if (pSettings->environment().useBuiltinProjectBuilder()
+                && ProjectBuilder::canBuild(project))
+            compiler = new ProjectBuilder(project,false,false);
+        else
+            compiler = new ProjectCompiler(project,false,false);
         compiler->setOnlyClean(true);
         mCompiler = compiler;
         mCompiler->setRebuild(false);
@@ -208,7 +218,7 @@ void CompilerManager::checkSyntax(const QString &filename, const QByteArray& enc
         connect(mBackgroundSyntaxChecker, &Compiler::compileStarted, pMainWindow, &MainWindow::onCompileStarted);
         connect(mBackgroundSyntaxChecker, &Compiler::compileFinished, this, &CompilerManager::onSyntaxCheckFinished);
         //connect(mBackgroundSyntaxChecker, &Compiler::compileOutput, pMainWindow, &MainWindow::logToolsOutput);
-        connect(mBackgroundSyntaxChecker, &Compiler::compileIssue, pMainWindow, &MainWindow::onCompileIssue);
+        connect(mBackgroundSyntaxChecker, &Compiler::compileIssue, pMainWindow, &MainWindow::onSyntaxCheckIssue);
         connect(mBackgroundSyntaxChecker, &Compiler::compileErrorOccured, pMainWindow, &MainWindow::onCompileErrorOccured);
         mBackgroundSyntaxChecker->start();
     }
@@ -332,6 +342,21 @@ void CompilerManager::doRunProblem(const QString &filename, const QString &argum
     mRunner = execRunner;
     if (pSettings->executor().enableCaseTimeout())
         execRunner->setExecTimeout(pSettings->executor().caseTimeout());
+    if (pSettings->executor().enableCaseMemoryLimit())
+        execRunner->setMemoryLimit(pSettings->executor().caseMemoryLimit()*1024);
+#ifdef Q_OS_LINUX
+    QString supervisorPath=includeTrailingPathDelimiter(pSettings->dirs().appLibexecDir())+"casesupervisor";
+    if (fileExists(supervisorPath))
+        execRunner->setSupervisor(supervisorPath);
+#endif
+    if (pSettings->executor().enableCaseTimeout()
+            && pSettings->executor().runTimeLimitedCasesSerially()) {
+        execRunner->setJobs(1);
+    } else if (pSettings->executor().caseRunnerJobs()>0) {
+        execRunner->setJobs(pSettings->executor().caseRunnerJobs());
+    } else {
+        execRunner->setJobs(physicalCoreCount());
+    }
     connect(mRunner, &Runner::finished, this ,&CompilerManager::onRunnerTerminated);
     connect(mRunner, &Runner::finished, mRunner ,&Runner::deleteLater);
     connect(mRunner, &Runner::finished, pMainWindow ,&MainWindow::onRunProblemFinished);
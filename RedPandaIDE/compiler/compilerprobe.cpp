@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "compilerprobe.h"
+#include "../systemconsts.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QSet>
+
+//returns false if the compiler can't be started, is killed, times out or fails
+static bool runCompiler(const QString& program, const QStringList& arguments,
+                        QByteArray& output, QByteArray& errorOutput)
+{
+    QProcessEnvironment env;
+    env.insert("LANG","en");
+    QProcess process;
+    process.setProcessEnvironment(env);
+    process.setWorkingDirectory(QFileInfo(program).absolutePath());
+    process.start(program,arguments);
+    if (!process.waitForStarted(COMPILER_PROBE_TIMEOUT))
+        return false;
+    process.closeWriteChannel();
+    if (!process.waitForFinished(COMPILER_PROBE_TIMEOUT)) {
+        process.kill();
+        process.waitForFinished();
+        return false;
+    }
+    errorOutput = process.readAllStandardError().trimmed();
+    output = process.readAllStandardOutput().trimmed();
+    return process.exitStatus() == QProcess::NormalExit
+            && process.exitCode() == 0;
+}
+
+CompilerProbeThread::CompilerProbeThread(const QString &program, QObject *parent):
+    QThread(parent),
+    mProgram(program)
+{
+}
+
+const QString &CompilerProbeThread::program() const
+{
+    return mProgram;
+}
+
+PCompilerProbe CompilerProbeThread::probe() const
+{
+    return mProbe;
+}
+
+void CompilerProbeThread::run()
+{
+    mProbe = CompilerProbeCache::runProbe(mProgram);
+}
+
+CompilerProbeCache::CompilerProbeCache(const QString &filename):
+    mFilename(filename),
+    mLoaded(false)
+{
+}
+
+PCompilerProbe CompilerProbeCache::probe(const QString &program)
+{
+    QString key = programKey(program);
+    PCompilerProbe probe = findProbe(key);
+    if (probe)
+        return probe;
+    if (!QFileInfo(key).isFile())
+        return std::make_shared<CompilerProbe>();
+    probe = runProbe(key);
+    //failures are not cached, so the compiler is probed again next time
+    if (!probe)
+        return std::make_shared<CompilerProbe>();
+    addProbe(key, probe);
+    save();
+    return probe;
+}
+
+void CompilerProbeCache::probeAll(const QStringList &programs)
+{
+    QList<CompilerProbeThread*> threads;
+    QSet<QString> keys;
+    foreach (const QString& program, programs) {
+        QString key = programKey(program);
+        if (keys.contains(key))
+            continue;
+        keys.insert(key);
+        if (findProbe(key) || !QFileInfo(key).isFile())
+            continue;
+        CompilerProbeThread* thread = new CompilerProbeThread(key);
+        thread->start();
+        threads.append(thread);
+    }
+    bool added = false;
+    foreach (CompilerProbeThread* thread, threads) {
+        thread->wait();
+        if (thread->probe()) {
+            addProbe(thread->program(), thread->probe());
+            added = true;
+        }
+        delete thread;
+    }
+    if (added)
+        save();
+}
+
+PCompilerProbe CompilerProbeCache::runProbe(const QString &program)
+{
+    PCompilerProbe probe = std::make_shared<CompilerProbe>();
+    QStringList arguments;
+    arguments.append("-v");
+    arguments.append("-E");
+    arguments.append("-dM");
+    arguments.append("-x");
+    arguments.append("c");
+    arguments.append(NULL_FILE);
+    if (!runCompiler(program, arguments, probe->cDefines, probe->cInfo)
+            || probe->cDefines.isEmpty())
+        return PCompilerProbe();
+
+    arguments.clear();
+    arguments.append("-v");
+    arguments.append("-E");
+    arguments.append("-dM");
+    arguments.append("-x");
+    arguments.append("c++");
+    arguments.append("-std=c++17");
+    arguments.append(NULL_FILE);
+    if (!runCompiler(program, arguments, probe->cppDefines, probe->cppInfo)
+            || probe->cppDefines.isEmpty())
+        return PCompilerProbe();
+
+    arguments.clear();
+    arguments.append("-print-search-dirs");
+    arguments.append(NULL_FILE);
+    QByteArray errorOutput;
+    if (!runCompiler(program, arguments, probe->searchDirs, errorOutput)
+            || probe->searchDirs.isEmpty())
+        return PCompilerProbe();
+    return probe;
+}
+
+QString CompilerProbeCache::programKey(const QString &program)
+{
+    return QDir::cleanPath(QFileInfo(program).absoluteFilePath());
+}
+
+PCompilerProbe CompilerProbeCache::findProbe(const QString &key)
+{
+    QMutexLocker locker(&mMutex);
+    if (!mLoaded) {
+        mLoaded = true;
+        load();
+    }
+    auto it = mEntries.constFind(key);
+    if (it == mEntries.constEnd())
+        return PCompilerProbe();
+    QFileInfo info(key);
+    if (!info.isFile()
+            || it->size != info.size()
+            || it->lastModified != info.lastModified().toMSecsSinceEpoch())
+        return PCompilerProbe();
+    return it->probe;
+}
+
+void CompilerProbeCache::addProbe(const QString &key, const PCompilerProbe &probe)
+{
+    QFileInfo info(key);
+    CacheEntry entry;
+    entry.size = info.size();
+    entry.lastModified = info.lastModified().toMSecsSinceEpoch();
+    entry.probe = probe;
+    QMutexLocker locker(&mMutex);
+    mEntries.insert(key, entry);
+}
+
+static QByteArray jsonToBytes(const QJsonValue& value)
+{
+    return QByteArray::fromBase64(value.toString().toLatin1());
+}
+
+static QJsonValue bytesToJson(const QByteArray& bytes)
+{
+    //outputs may contain paths in the local encoding
+    return QString::fromLatin1(bytes.toBase64());
+}
+
+void CompilerProbeCache::load()
+{
+    //the cache is only a speedup, a missing or bad file is ignored
+    QFile file(mFilename);
+    if (!file.open(QFile::ReadOnly))
+        return;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    QJsonObject root = doc.object();
+    if (root["version"].toInt() != COMPILER_PROBE_CACHE_VERSION)
+        return;
+    foreach (const QJsonValue& value, root["compilers"].toArray()) {
+        QJsonObject obj = value.toObject();
+        CacheEntry entry;
+        entry.size = obj["size"].toVariant().toLongLong();
+        entry.lastModified = obj["modified"].toVariant().toLongLong();
+        entry.probe = std::make_shared<CompilerProbe>();
+        entry.probe->cInfo = jsonToBytes(obj["cInfo"]);
+        entry.probe->cDefines = jsonToBytes(obj["cDefines"]);
+        entry.probe->cppInfo = jsonToBytes(obj["cppInfo"]);
+        entry.probe->cppDefines = jsonToBytes(obj["cppDefines"]);
+        entry.probe->searchDirs = jsonToBytes(obj["searchDirs"]);
+        mEntries.insert(obj["path"].toString(), entry);
+    }
+}
+
+void CompilerProbeCache::save()
+{
+    QMutexLocker locker(&mMutex);
+    QJsonArray array;
+    for (auto it = mEntries.constBegin(); it != mEntries.constEnd(); ++it) {
+        QJsonObject obj;
+        obj["path"] = it.key();
+        obj["size"] = QString::number(it->size);
+        obj["modified"] = QString::number(it->lastModified);
+        obj["cInfo"] = bytesToJson(it->probe->cInfo);
+        obj["cDefines"] = bytesToJson(it->probe->cDefines);
+        obj["cppInfo"] = bytesToJson(it->probe->cppInfo);
+        obj["cppDefines"] = bytesToJson(it->probe->cppDefines);
+        obj["searchDirs"] = bytesToJson(it->probe->searchDirs);
+        array.append(obj);
+    }
+    QJsonObject root;
+    root["version"] = COMPILER_PROBE_CACHE_VERSION;
+    root["compilers"] = array;
+    QFile file(mFilename);
+    if (file.open(QFile::WriteOnly | QFile::Truncate))
+        file.write(QJsonDocument(root).toJson());
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef COMPILERPROBE_H
+#define COMPILERPROBE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <memory>
+
+//increase it when the probe commands change, to drop old cache files
+#define COMPILER_PROBE_CACHE_VERSION 1
+//time (ms) a compiler may take to start, and to answer a probe command
+#define COMPILER_PROBE_TIMEOUT 30000
+
+/**
+ * @brief What a gcc/clang tells about itself.
+ *
+ * Everything is read by three runs of the compiler:
+ *  - "-v -E -dM -x c": version / target / C include dirs on stderr, C defines on stdout
+ *  - "-v -E -dM -x c++ -std=c++17": C++ include dirs on stderr, C++ defines on stdout
+ *  - "-print-search-dirs": program and library dirs
+ */
+struct CompilerProbe {
+    QByteArray cInfo;
+    QByteArray cDefines;
+    QByteArray cppInfo;
+    QByteArray cppDefines;
+    QByteArray searchDirs;
+};
+
+using PCompilerProbe = std::shared_ptr<CompilerProbe>;
+
+class CompilerProbeThread : public QThread {
+    Q_OBJECT
+public:
+    explicit CompilerProbeThread(const QString& program, QObject *parent = nullptr);
+    const QString &program() const;
+    PCompilerProbe probe() const;
+
+    // QThread interface
+protected:
+    void run() override;
+private:
+    QString mProgram;
+    PCompilerProbe mProbe;
+};
+
+/**
+ * @brief Probe results of compilers, saved in a file.
+ *
+ * Results are keyed by the compiler's path, and are only reused if the
+ * compiler's size and modification time haven't changed.
+ */
+class CompilerProbeCache
+{
+public:
+    explicit CompilerProbeCache(const QString& filename);
+    CompilerProbeCache(const CompilerProbeCache&) = delete;
+    CompilerProbeCache& operator=(const CompilerProbeCache&) = delete;
+
+    //an empty probe is returned (and not cached) if the compiler fails
+    PCompilerProbe probe(const QString& program);
+    //probe the compilers not in the cache concurrently
+    void probeAll(const QStringList& programs);
+
+    //returns nullptr if any of the commands fails or has no output
+    static PCompilerProbe runProbe(const QString& program);
+private:
+    struct CacheEntry {
+        qint64 size;
+        qint64 lastModified;
+        PCompilerProbe probe;
+    };
+
+    static QString programKey(const QString& program);
+    PCompilerProbe findProbe(const QString& key);
+    void addProbe(const QString& key, const PCompilerProbe& probe);
+    void load();
+    void save();
+private:
+    QString mFilename;
+    bool mLoaded;
+    QHash<QString,CacheEntry> mEntries;
+    QMutex mMutex;
+};
+
+#endif // COMPILERPROBE_H
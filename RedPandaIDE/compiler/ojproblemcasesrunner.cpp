@@ -20,13 +20,39 @@
 #include "../systemconsts.h"
 #include "../widgets/ojproblemsetmodel.h"
 #include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
 #include <QProcess>
+#include <QTimer>
+#include <QRunnable>
+#include <QTemporaryFile>
+#include <QThreadPool>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <signal.h>
+#endif
+
+namespace {
+class CaseWorker : public QRunnable {
+public:
+    explicit CaseWorker(std::function<void()> job):mJob(job) {}
+    void run() override {
+        mJob();
+    }
+private:
+    std::function<void()> mJob;
+};
+}
 
 
 OJProblemCasesRunner::OJProblemCasesRunner(const QString& filename, const QString& arguments, const QString& workDir,
                                            const QVector<POJProblemCase>& problemCases, QObject *parent):
     Runner(filename,arguments,workDir,parent),
-    mExecTimeout(-1)
+    mExecTimeout(-1),
+    mMemoryLimit(-1),
+    mJobs(1)
 {
     mProblemCases = problemCases;
     mBufferSize = 8192;
@@ -37,7 +63,9 @@ OJProblemCasesRunner::OJProblemCasesRunner(const QString& filename, const QStrin
 OJProblemCasesRunner::OJProblemCasesRunner(const QString& filename, const QString& arguments, const QString& workDir,
                                            POJProblemCase problemCase, QObject *parent):
     Runner(filename,arguments,workDir,parent),
-    mExecTimeout(-1)
+    mExecTimeout(-1),
+    mMemoryLimit(-1),
+    mJobs(1)
 {
     mProblemCases.append(problemCase);
     mBufferSize = 8192;
@@ -45,27 +73,38 @@ OJProblemCasesRunner::OJProblemCasesRunner(const QString& filename, const QStrin
     setWaitForFinishTime(100);
 }
 
-void OJProblemCasesRunner::runCase(int index,POJProblemCase problemCase)
+void OJProblemCasesRunner::runCase(int /* index */,POJProblemCase problemCase)
 {
-    emit caseStarted(problemCase->getId(),index, mProblemCases.count());
-    auto action = finally([this,&index, &problemCase]{
-        emit caseFinished(problemCase->getId(), index, mProblemCases.count());
-    });
     QProcess process;
     bool errorOccurred = false;
-    QByteArray readed;
     QByteArray buffer;
     QByteArray output;
-    int noOutputTime = 0;
     QElapsedTimer elapsedTimer;
     bool execTimeouted = false;
-    process.setProgram(mFilename);
-    process.setArguments(splitProcessCommand(mArguments));
+    bool failedToStart = false;
+    int termSignal = 0;
+    bool memoryLimitHit = false;
+    //the supervisor reports how the program ended and what it used in this file
+    QTemporaryFile reportFile;
+    bool supervised = !mSupervisor.isEmpty() && reportFile.open();
+    if (supervised) {
+        reportFile.close();
+        QStringList arguments;
+        arguments.append(reportFile.fileName());
+        arguments.append(QString::number(std::max(mExecTimeout,0)));
+        arguments.append(QString::number(std::max(mMemoryLimit,0)));
+        arguments.append(mFilename);
+        arguments.append(splitProcessCommand(mArguments));
+        process.setProgram(mSupervisor);
+        process.setArguments(arguments);
+    } else {
+        process.setProgram(mFilename);
+        process.setArguments(splitProcessCommand(mArguments));
+    }
     process.setWorkingDirectory(mWorkDir);
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
     QString path = env.value("PATH");
     QStringList pathAdded;
-    bool writeChannelClosed = false;
     if (pSettings->compilerSets().defaultSet()) {
         foreach(const QString& dir, pSettings->compilerSets().defaultSet()->binDirs()) {
             pathAdded.append(dir);
@@ -80,68 +119,171 @@ void OJProblemCasesRunner::runCase(int index,POJProblemCase problemCase)
     env.insert("PATH",path);
     process.setProcessEnvironment(env);
     process.setProcessChannelMode(QProcess::MergedChannels);
+
+    QEventLoop loop;
+    process.connect(&process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                    &loop, &QEventLoop::quit);
     process.connect(
                 &process, &QProcess::errorOccurred,
-                [&](){
+                [&](QProcess::ProcessError processError){
         errorOccurred= true;
+        if (processError == QProcess::FailedToStart)
+            loop.quit();
+    });
+
+    //the whole output is spooled to a file for the validator, only its
+    //start is kept in memory and shown
+    std::shared_ptr<QTemporaryFile> outputFile = std::make_shared<QTemporaryFile>();
+    if (!outputFile->open())
+        outputFile.reset();
+    bool outputTruncated = false;
+    auto keepOutput = [&](){
+        if (buffer.isEmpty())
+            return;
+        if (outputFile)
+            outputFile->write(buffer);
+        if (!outputFile || output.length()+buffer.length()<=OJ_CASE_OUTPUT_SHOWN_SIZE) {
+            emit newOutputGetted(problemCase->getId(),QString::fromLocal8Bit(buffer));
+            output.append(buffer);
+        } else if (!outputTruncated) {
+            outputTruncated = true;
+            output.append(buffer.left(OJ_CASE_OUTPUT_SHOWN_SIZE-output.length()));
+            QString note = "\n" + tr("(The output is too long, only its first %1 KB are shown.)")
+                    .arg(OJ_CASE_OUTPUT_SHOWN_SIZE/1024);
+            emit resetOutput(problemCase->getId(),QString::fromLocal8Bit(output)+note);
+        }
+        buffer.clear();
+    };
+
+    //output is read as soon as it arrives, but passed to the ui at most
+    //every mOutputRefreshTime ms or every mBufferSize bytes
+    QTimer flushTimer;
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(mOutputRefreshTime);
+    auto flushOutput = [&](){
+        flushTimer.stop();
+        keepOutput();
+    };
+    process.connect(&flushTimer, &QTimer::timeout, flushOutput);
+    process.connect(&process, &QProcess::readyRead, [&](){
+        buffer += process.readAll();
+        if (buffer.length()>=mBufferSize)
+            flushOutput();
+        else if (!flushTimer.isActive())
+            flushTimer.start();
     });
+
+    //input files are fed in chunks, so big inputs are not loaded into memory at once
+    //(inputs of saved problem sets may still be in their data files)
+    QString inputFileName = problemCase->inputFileName;
+    if (!fileExists(inputFileName))
+        inputFileName = problemCase->input.pendingDataFile();
+    QFile inputFile(inputFileName);
+    bool inputFinished = false;
+    auto feedInput = [&](){
+        while (!inputFinished && process.bytesToWrite() < mBufferSize) {
+            QByteArray chunk = inputFile.read(mBufferSize);
+            if (chunk.isEmpty()) {
+                inputFinished = true;
+                process.closeWriteChannel();
+            } else {
+                process.write(chunk);
+            }
+        }
+    };
+
+    QTimer timeoutTimer;
+    timeoutTimer.setSingleShot(true);
+    process.connect(&timeoutTimer, &QTimer::timeout, [&](){
+        execTimeouted = true;
+        process.kill();
+    });
+
     problemCase->output.clear();
+    problemCase->outputFile.reset();
+    problemCase->cpuTime = -1;
+    problemCase->peakMemory = -1;
+    problemCase->exitCode = 0;
+    problemCase->verdict = ProblemCaseVerdict::None;
     process.start();
     process.waitForStarted(5000);
-    if (process.state()==QProcess::Running) {
-        if (fileExists(problemCase->inputFileName))
-            process.write(readFileToByteArray(problemCase->inputFileName));
-        else
-            process.write(problemCase->input.toUtf8());
-        process.waitForFinished(0);
-    }
-
     elapsedTimer.start();
-    while (true) {
-        if (process.bytesToWrite()==0 && !writeChannelClosed) {
-            writeChannelClosed = true;
+#ifdef Q_OS_WIN
+    HANDLE hProcess = NULL;
+    if (process.state()==QProcess::Running)
+        hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, process.processId());
+    auto closeProcessHandle = finally([&hProcess]{
+        if (hProcess)
+            CloseHandle(hProcess);
+    });
+#endif
+    //stop requests come from other threads, they are queued to this thread's loop
+    connect(this, &Runner::stopRequested, &process, [&process](){
+        process.kill();
+    });
+    if (process.state()==QProcess::Running) {
+        if (inputFile.open(QFile::ReadOnly)) {
+            process.connect(&process, &QProcess::bytesWritten, feedInput);
+            feedInput();
+        } else {
+            process.write(problemCase->input.text().toUtf8());
             process.closeWriteChannel();
         }
-        process.waitForFinished(mWaitForFinishTime);
-        if (process.state()!=QProcess::Running) {
-            break;
-        }
-        if (mExecTimeout>0) {
-            int msec = elapsedTimer.elapsed();
-            if (msec>mExecTimeout) {
-                execTimeouted=true;
-            }
-        }
-        if (mStop || execTimeouted) {
-            process.terminate();
+        if (mExecTimeout>0)
+            timeoutTimer.start(mExecTimeout);
+        //stopped before the connection above is made
+        if (mStop)
             process.kill();
-            break;
-        }
-        if (errorOccurred)
-            break;
-        readed = process.read(mBufferSize);
-        buffer += readed;
-        if (buffer.length()>=mBufferSize || noOutputTime > mOutputRefreshTime) {
-            if (!buffer.isEmpty()) {
-                emit newOutputGetted(problemCase->getId(),QString::fromLocal8Bit(buffer));
-                output.append(buffer);
-                buffer.clear();
+        loop.exec();
+    }
+    problemCase->runningTime=elapsedTimer.elapsed();
+#ifdef Q_OS_WIN
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (hProcess && GetProcessTimes(hProcess, &creationTime, &exitTime, &kernelTime, &userTime)) {
+        ULARGE_INTEGER kernel, user;
+        kernel.LowPart = kernelTime.dwLowDateTime;
+        kernel.HighPart = kernelTime.dwHighDateTime;
+        user.LowPart = userTime.dwLowDateTime;
+        user.HighPart = userTime.dwHighDateTime;
+        //100-nanosecond intervals
+        problemCase->cpuTime = (kernel.QuadPart + user.QuadPart) / 10000;
+    }
+    PROCESS_MEMORY_COUNTERS memoryCounters;
+    if (hProcess && GetProcessMemoryInfo(hProcess, &memoryCounters, sizeof(memoryCounters)))
+        problemCase->peakMemory = memoryCounters.PeakWorkingSetSize / 1024;
+#endif
+    problemCase->exitCode = process.exitCode();
+    //on linux the cpu time is only known from the supervisor, which gets it
+    //from wait4() when the program is reaped
+    if (supervised && !execTimeouted && !mStop) {
+        //<started> <exit_code> <signal> <cpu_time_ms> <peak_memory_kb> <memory_limit_hit>
+        QList<QByteArray> fields = readFileToByteArray(reportFile.fileName()).trimmed().split(' ');
+        if (fields.length()==6) {
+            if (fields[0]=="1") {
+                problemCase->exitCode = fields[1].toInt();
+                termSignal = fields[2].toInt();
+                problemCase->cpuTime = fields[3].toInt();
+                problemCase->peakMemory = fields[4].toInt();
+                memoryLimitHit = (fields[5]=="1");
+            } else {
+                failedToStart = true;
+                emit runErrorOccurred(tr("The runner process '%1' failed to start.").arg(mFilename));
             }
-            noOutputTime = 0;
-        } else {
-            noOutputTime += mWaitForFinishTime;
         }
     }
-    problemCase->runningTime=elapsedTimer.elapsed();
     if (execTimeouted) {
+        problemCase->verdict = ProblemCaseVerdict::TimeLimitExceeded;
         problemCase->output = tr("Case Timeout");
         emit resetOutput(problemCase->getId(), problemCase->output);
     } else {
-        if (process.state() == QProcess::ProcessState::NotRunning)
-            buffer += process.readAll();
-        emit newOutputGetted(problemCase->getId(),QString::fromLocal8Bit(buffer));
-        output.append(buffer);
+        buffer += process.readAll();
+        keepOutput();
         problemCase->output = QString::fromLocal8Bit(output);
+        if (outputTruncated)
+            problemCase->output += "\n" + tr("(The output is too long, only its first %1 KB are shown.)")
+                    .arg(OJ_CASE_OUTPUT_SHOWN_SIZE/1024);
+        if (outputFile && outputFile->flush())
+            problemCase->outputFile = outputFile;
         if (errorOccurred) {
             //qDebug()<<"process error:"<<process.error();
             switch (process.error()) {
@@ -165,21 +307,97 @@ void OJProblemCasesRunner::runCase(int index,POJProblemCase problemCase)
                 break;
             }
         }
+        if (errorOccurred && process.error()==QProcess::FailedToStart)
+            failedToStart = true;
+        if (!mStop && !failedToStart)
+            problemCase->verdict = judgeVerdict(problemCase, process.exitStatus()==QProcess::CrashExit,
+                                                  termSignal, memoryLimitHit);
     }
 }
 
+ProblemCaseVerdict OJProblemCasesRunner::judgeVerdict(const POJProblemCase &problemCase, bool crashed,
+                                                      int termSignal, bool memoryLimitHit) const
+{
+#ifdef Q_OS_LINUX
+    if (termSignal == SIGXCPU)
+        return ProblemCaseVerdict::TimeLimitExceeded;
+#endif
+    if (mExecTimeout>0 && problemCase->cpuTime>mExecTimeout)
+        return ProblemCaseVerdict::TimeLimitExceeded;
+    bool failed = crashed || termSignal!=0 || problemCase->exitCode!=0;
+    if (mMemoryLimit>0) {
+        if (problemCase->peakMemory>mMemoryLimit)
+            return ProblemCaseVerdict::MemoryLimitExceeded;
+        //allocations beyond the address space limit fail before the memory is used,
+        //so the peak can't tell; the supervisor judges it from how the program ended
+        if (failed && memoryLimitHit)
+            return ProblemCaseVerdict::MemoryLimitExceeded;
+    }
+    if (failed)
+        return ProblemCaseVerdict::RuntimeError;
+    return ProblemCaseVerdict::None;
+}
+
 void OJProblemCasesRunner::run()
 {
     emit started();
     auto action = finally([this]{
         emit terminated();
     });
-    for (int i=0; i < mProblemCases.size(); i++) {
-        if (mStop)
-            break;
-        POJProblemCase problemCase = mProblemCases[i];
-        runCase(i,problemCase);
+    mNextCase = 0;
+    mNextCaseToReport = 0;
+    mCaseFinished.fill(false, mProblemCases.size());
+    int jobs = std::min(mJobs, mProblemCases.size());
+    if (jobs<=1) {
+        runCases();
+        return;
     }
+    QThreadPool pool;
+    pool.setMaxThreadCount(jobs);
+    for (int i=0;i<jobs;i++) {
+        pool.start(new CaseWorker([this](){
+            runCases();
+        }));
+    }
+    pool.waitForDone();
+}
+
+void OJProblemCasesRunner::runCases()
+{
+    while (!mStop) {
+        int index;
+        {
+            //cases are taken (and reported as started) in order
+            QMutexLocker locker(&mMutex);
+            if (mNextCase>=mProblemCases.size())
+                break;
+            index = mNextCase++;
+            emit caseStarted(mProblemCases[index]->getId(), index, mProblemCases.count());
+        }
+        runCase(index, mProblemCases[index]);
+        reportCaseFinished(index);
+    }
+}
+
+void OJProblemCasesRunner::reportCaseFinished(int index)
+{
+    //hold back finished cases until all cases before them are finished
+    QMutexLocker locker(&mMutex);
+    mCaseFinished[index] = true;
+    while (mNextCaseToReport<mNextCase && mCaseFinished[mNextCaseToReport]) {
+        emit caseFinished(mProblemCases[mNextCaseToReport]->getId(), mNextCaseToReport, mProblemCases.count());
+        mNextCaseToReport++;
+    }
+}
+
+int OJProblemCasesRunner::jobs() const
+{
+    return mJobs;
+}
+
+void OJProblemCasesRunner::setJobs(int newJobs)
+{
+    mJobs = std::max(1, newJobs);
 }
 
 int OJProblemCasesRunner::execTimeout() const
@@ -192,6 +410,26 @@ void OJProblemCasesRunner::setExecTimeout(int newExecTimeout)
     mExecTimeout = newExecTimeout;
 }
 
+int OJProblemCasesRunner::memoryLimit() const
+{
+    return mMemoryLimit;
+}
+
+void OJProblemCasesRunner::setMemoryLimit(int newMemoryLimit)
+{
+    mMemoryLimit = newMemoryLimit;
+}
+
+const QString &OJProblemCasesRunner::supervisor() const
+{
+    return mSupervisor;
+}
+
+void OJProblemCasesRunner::setSupervisor(const QString &newSupervisor)
+{
+    mSupervisor = newSupervisor;
+}
+
 int OJProblemCasesRunner::waitForFinishTime() const
 {
     return mWaitForFinishTime;
@@ -19,6 +19,7 @@
 
 #include "runner.h"
 #include <QVector>
+#include <QMutex>
 #include "../problems/ojproblemset.h"
 
 class OJProblemCasesRunner : public Runner
@@ -43,6 +44,18 @@ public:
     int execTimeout() const;
     void setExecTimeout(int newExecTimeout);
 
+    //max memory (in KB) a case can use
+    int memoryLimit() const;
+    void setMemoryLimit(int newMemoryLimit);
+
+    //program that runs the cases under resource limits and reports their usage
+    const QString &supervisor() const;
+    void setSupervisor(const QString &newSupervisor);
+
+    //max number of cases running at the same time
+    int jobs() const;
+    void setJobs(int newJobs);
+
 signals:
     void caseStarted(const QString &caseId, int current, int total);
     void caseFinished(const QString &caseId, int current, int total);
@@ -50,8 +63,16 @@ signals:
     void resetOutput(const QString &caseId, const QString &newOutputLine);
 private:
     void runCase(int index, POJProblemCase problemCase);
+    void runCases();
+    void reportCaseFinished(int index);
+    ProblemCaseVerdict judgeVerdict(const POJProblemCase& problemCase, bool crashed,
+                                    int termSignal, bool memoryLimitHit) const;
 private:
     QVector<POJProblemCase> mProblemCases;
+    QMutex mMutex;
+    int mNextCase;
+    int mNextCaseToReport;
+    QVector<bool> mCaseFinished;
 
     // QThread interface
 protected:
@@ -60,6 +81,9 @@ private:
     int mBufferSize;
     int mOutputRefreshTime;
     int mExecTimeout;
+    int mMemoryLimit;
+    QString mSupervisor;
+    int mJobs;
 };
 
 #endif // OJPROBLEMCASESRUNNER_H
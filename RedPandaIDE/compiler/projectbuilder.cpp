@@ -0,0 +1,543 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "projectbuilder.h"
+#include "../project.h"
+#include "compilermanager.h"
+#include "../systemconsts.h"
+#include "../utils.h"
+
+#include <QDir>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+
+ProjectBuilder::ProjectBuilder(std::shared_ptr<Project> project, bool silent, bool onlyCheckSyntax):
+    ProjectCompiler(project,silent,onlyCheckSyntax),
+    mNeedLink(false)
+{
+
+}
+
+bool ProjectBuilder::canBuild(const std::shared_ptr<Project> &project)
+{
+    if (project->options().useCustomMakefile)
+        return false;
+    if (!project->options().makeIncludes.isEmpty())
+        return false;
+    foreach(const PProjectUnit &unit, project->unitList()) {
+        if (unit->overrideBuildCmd() && !unit->buildCmd().isEmpty())
+            return false;
+    }
+    return true;
+}
+
+QString ProjectBuilder::objFileName(const PProjectUnit &unit) const
+{
+    if (!mProject->options().objectOutput.isEmpty()) {
+        QString fullObjFile = includeTrailingPathDelimiter(mProject->options().objectOutput)
+                + extractFileName(unit->fileName());
+        return absolutePath(changeFileExt(fullObjFile, OBJ_EXT));
+    }
+    return changeFileExt(unit->fileName(), OBJ_EXT);
+}
+
+QString ProjectBuilder::absolutePath(const QString &fileName) const
+{
+    return QDir::cleanPath(QDir(mProject->directory()).absoluteFilePath(fileName));
+}
+
+QStringList ProjectBuilder::readDependencies(const QString &depFile) const
+{
+    QStringList result;
+    QFile file(depFile);
+    if (!file.open(QFile::ReadOnly))
+        return result;
+    QByteArray content = file.readAll();
+    content.replace("\\\r\n"," ");
+    content.replace("\\\n"," ");
+    // the first rule lists all prerequisites of the object file,
+    // the rest are the empty rules generated by -MP
+    int pos = content.indexOf('\n');
+    if (pos>=0)
+        content.truncate(pos);
+    pos = content.indexOf(": ");
+    if (pos<0)
+        return result;
+    QByteArray name;
+    for (int i=pos+2;i<content.length();i++) {
+        char ch = content[i];
+        if (ch=='\\' && i+1<content.length()
+                && (content[i+1]==' ' || content[i+1]=='#')) {
+            name.append(content[i+1]);
+            i++;
+        } else if (ch=='$' && i+1<content.length() && content[i+1]=='$') {
+            name.append('$');
+            i++;
+        } else if (ch==' ' || ch=='\t' || ch=='\r') {
+            if (!name.isEmpty())
+                result.append(absolutePath(QString::fromLocal8Bit(name)));
+            name.clear();
+        } else {
+            name.append(ch);
+        }
+    }
+    if (!name.isEmpty())
+        result.append(absolutePath(QString::fromLocal8Bit(name)));
+    return result;
+}
+
+bool ProjectBuilder::isOutdated(const QString &target, const QStringList &prerequisites) const
+{
+    QFileInfo targetInfo(target);
+    if (!targetInfo.exists())
+        return true;
+    QDateTime targetTime = targetInfo.lastModified();
+    foreach (const QString& prerequisite, prerequisites) {
+        QFileInfo info(prerequisite);
+        if (!info.exists() || info.lastModified()>targetTime)
+            return true;
+    }
+    return false;
+}
+
+bool ProjectBuilder::isObjectOutdated(const QString &objFile, const QString &sourceFile) const
+{
+    QString depFile = changeFileExt(objFile, DEP_EXT);
+    //no recorded dependencies, rebuild it to get them
+    if (!fileExists(depFile))
+        return true;
+    QStringList prerequisites = readDependencies(depFile);
+    prerequisites.append(sourceFile);
+    if (!mPCHFile.isEmpty())
+        prerequisites.append(mPCHFile);
+    return isOutdated(objFile, prerequisites);
+}
+
+bool ProjectBuilder::runSteps(const QList<PBuildStep> &steps)
+{
+    QEventLoop loop;
+    QList<QProcess*> processes;
+    int next = 0;
+    int jobs = buildJobs();
+    bool failed = false;
+    bool isClang = compilerSet()->compilerType() == COMPILER_CLANG;
+
+    std::function<void()> startSteps;
+    auto stepFinished = [&](QProcess* process) {
+        processes.removeOne(process);
+        process->deleteLater();
+        if (processes.isEmpty() && (failed || mStop || next>=steps.count())) {
+            loop.quit();
+        } else {
+            startSteps();
+        }
+    };
+    startSteps = [&]() {
+        while (processes.count()<jobs && next<steps.count() && !failed && !mStop) {
+            PBuildStep step = steps[next++];
+            QProcess* process = new QProcess();
+            process->setProgram(step->program);
+            process->setArguments(splitProcessCommand(step->arguments));
+            process->setWorkingDirectory(mDirectory);
+            process->setProcessEnvironment(commandEnvironment(step->program));
+            process->setProcessChannelMode(QProcess::MergedChannels);
+            connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                    [&,process,step,isClang](int exitCode, QProcess::ExitStatus exitStatus){
+                int errorCount = mErrorCount;
+                //the whole output of a translation unit is processed at once,
+                //so messages from parallel jobs are never interleaved
+                QByteArray output = process->readAll();
+                if (isClang)
+                    this->error(QString::fromUtf8(output));
+                else
+                    this->error(QString::fromLocal8Bit(output));
+                this->error(COMPILE_PROCESS_END);
+                if (exitStatus!=QProcess::NormalExit || exitCode!=0) {
+                    if (!mStop)
+                        commandFailed(step->program, exitCode,
+                                      exitStatus!=QProcess::NormalExit, errorCount);
+                    failed = true;
+                }
+                stepFinished(process);
+            });
+            connect(process, &QProcess::errorOccurred,
+                    [&,process,step](QProcess::ProcessError processError){
+                if (processError!=QProcess::FailedToStart)
+                    return;
+                this->error(tr("The compiler process for '%1' failed to start.").arg(step->source));
+                failed = true;
+                stepFinished(process);
+            });
+            processes.append(process);
+            log(extractFileName(step->program)+" "+step->arguments);
+            process->start();
+        }
+    };
+
+    //stop requests come from other threads, they are queued to this thread's loop
+    connect(this, &Compiler::stopRequested, &loop, [&](){
+        foreach(QProcess* process, processes)
+            process->kill();
+    });
+    startSteps();
+    if (!processes.isEmpty())
+        loop.exec();
+    return !failed && !mStop;
+}
+
+QList<ProjectBuilder::PBuildStep> ProjectBuilder::linkSteps()
+{
+    QString objects;
+    foreach(const QString& objFile, mLinkObjects) {
+        objects += QString(" \"%1\"").arg(objFile);
+    }
+    foreach(const QString& objFile, mProject->options().objFiles) {
+        objects += QString(" \"%1\"").arg(absolutePath(objFile));
+    }
+    QString target = mProject->executable();
+    QList<PBuildStep> steps;
+    PBuildStep step = std::make_shared<BuildStep>();
+    step->source = target;
+    step->program = mProject->options().isCpp ?
+                compilerSet()->cppCompiler() : compilerSet()->CCompiler();
+    switch(mProject->options().type) {
+    case ProjectType::StaticLib: {
+        //ar and ranlib are in the same folder as gcc
+        QString binDir = includeTrailingPathDelimiter(extractFileDir(compilerSet()->CCompiler()));
+#ifdef Q_OS_WIN
+        step->program = binDir + "ar.exe";
+#else
+        step->program = binDir + "ar";
+#endif
+        step->arguments = QString("r \"%1\"%2").arg(target, objects);
+        steps.append(step);
+        step = std::make_shared<BuildStep>();
+        step->source = target;
+#ifdef Q_OS_WIN
+        step->program = binDir + "ranlib.exe";
+#else
+        step->program = binDir + "ranlib";
+#endif
+        step->arguments = QString("\"%1\"").arg(target);
+        break;
+    }
+    case ProjectType::DynamicLib: {
+        QString libOutputFile = includeTrailingPathDelimiter(extractFilePath(target))
+                + "lib" + extractFileName(target);
+        step->arguments = QString("-mdll%1 -o \"%2\" %3 -Wl,--output-def,\"%4\",--out-implib,\"%5\"")
+                .arg(objects, target, getLibraryArguments(FileType::Project),
+                     changeFileExt(libOutputFile, DEF_EXT),
+                     changeFileExt(libOutputFile, LIB_EXT));
+        break;
+    }
+    default:
+        step->arguments = QString("%1 -o \"%2\" %3")
+                .arg(objects.trimmed(), target, getLibraryArguments(FileType::Project));
+    }
+    steps.append(step);
+    return steps;
+}
+
+QStringList ProjectBuilder::linkLibraries(const QString &arguments) const
+{
+    QStringList result;
+    QStringList libDirs;
+    QStringList names;
+    foreach(const QString& argument, splitProcessCommand(arguments)) {
+        if (argument.startsWith("-L")) {
+            libDirs.append(absolutePath(argument.mid(2)));
+        } else if (argument.startsWith("-l")) {
+            names.append(argument.mid(2));
+        } else if (!argument.startsWith("-") && fileExists(absolutePath(argument))) {
+            result.append(absolutePath(argument));
+        }
+    }
+    //the first library found in the search dirs is the one linked
+    foreach(const QString& name, names) {
+        QStringList candidates;
+        if (name.startsWith(":"))
+            candidates.append(name.mid(1));
+        else
+            candidates<<"lib"+name+".dll.a"<<"lib"+name+".a"<<"lib"+name+".so"<<name+".lib";
+        bool found = false;
+        foreach(const QString& folder, libDirs) {
+            foreach(const QString& candidate, candidates) {
+                QString fileName = includeTrailingPathDelimiter(folder) + candidate;
+                if (fileExists(fileName)) {
+                    result.append(fileName);
+                    found = true;
+                    break;
+                }
+            }
+            if (found)
+                break;
+        }
+    }
+    return result;
+}
+
+QString ProjectBuilder::stepsCommand(const QList<PBuildStep> &steps)
+{
+    QStringList commands;
+    foreach(const PBuildStep& step, steps) {
+        commands.append(step->program+" "+step->arguments);
+    }
+    return commands.join(" && ");
+}
+
+bool ProjectBuilder::link(const QList<PBuildStep> &steps)
+{
+    foreach(const PBuildStep& step, steps) {
+        log(extractFileName(step->program)+" "+step->arguments);
+        if (!runCommand(step->program, step->arguments, mDirectory))
+            return false;
+    }
+    return true;
+}
+
+QString ProjectBuilder::buildFlagsFile() const
+{
+    QString folder = mProject->options().objectOutput.isEmpty() ?
+                mProject->directory() : absolutePath(mProject->options().objectOutput);
+    return includeTrailingPathDelimiter(folder)
+            + changeFileExt(extractFileName(mProject->filename()), BUILD_FLAGS_EXT);
+}
+
+QStringList ProjectBuilder::readBuildFlags() const
+{
+    QStringList flags;
+    QFile file(buildFlagsFile());
+    if (file.open(QFile::ReadOnly))
+        flags = QJsonDocument::fromJson(file.readAll()).array().toVariant().toStringList();
+    while (flags.count()<3)
+        flags.append(QString());
+    return flags;
+}
+
+void ProjectBuilder::writeBuildFlags(const QStringList &flags) const
+{
+    QFile file(buildFlagsFile());
+    if (file.open(QFile::WriteOnly | QFile::Truncate))
+        file.write(QJsonDocument(QJsonArray::fromStringList(flags)).toJson());
+}
+
+QStringList ProjectBuilder::generatedFiles()
+{
+    QStringList result;
+    foreach(const PProjectUnit &unit, mProject->unitList()) {
+        FileType fileType = getFileType(unit->fileName());
+        if (fileType!=FileType::CSource && fileType!=FileType::CppSource)
+            continue;
+        QString objFile = objFileName(unit);
+        result.append(objFile);
+        result.append(changeFileExt(objFile, DEP_EXT));
+    }
+#ifdef Q_OS_WIN
+    if (!mProject->options().privateResource.isEmpty()) {
+        if (!mProject->options().objectOutput.isEmpty()) {
+            result.append(absolutePath(includeTrailingPathDelimiter(mProject->options().objectOutput) +
+                  changeFileExt(mProject->options().privateResource, RES_EXT)));
+        } else
+            result.append(absolutePath(changeFileExt(mProject->options().privateResource, RES_EXT)));
+    }
+#endif
+    QString target = mProject->executable();
+    result.append(target);
+    result.append(buildFlagsFile());
+    if (mProject->options().type == ProjectType::DynamicLib) {
+        QString libOutputFile = includeTrailingPathDelimiter(extractFilePath(target))
+                + "lib" + extractFileName(target);
+        result.append(changeFileExt(libOutputFile, DEF_EXT));
+        result.append(changeFileExt(libOutputFile, LIB_EXT));
+    }
+    return result;
+}
+
+void ProjectBuilder::removeGeneratedFiles()
+{
+    foreach(const QString& fileName, generatedFiles()) {
+        QFile file(fileName);
+        if (file.exists() && !file.remove()) {
+            error(tr("Can't delete the old file \"%1\".\n").arg(fileName));
+        }
+    }
+}
+
+bool ProjectBuilder::prepareForCompile()
+{
+    if (!mProject)
+        return false;
+    log(tr("Building project..."));
+    log("--------");
+    log(tr("- Project Filename: %1").arg(mProject->filename()));
+    log(tr("- Compiler Set Name: %1").arg(compilerSet()->name()));
+    log(tr("- Parallel Jobs: %1").arg(buildJobs()));
+    log("");
+
+    mDirectory = mProject->directory();
+    if (mOnlyClean)
+        return true;
+
+    if (!mProject->options().objectOutput.isEmpty()) {
+        QDir(mProject->directory()).mkpath(mProject->options().objectOutput);
+    }
+
+    QString cCompileArguments = getCCompileArguments(mOnlyCheckSyntax);
+    QString cppCompileArguments = getCppCompileArguments(mOnlyCheckSyntax);
+    if (cCompileArguments.indexOf(" -g3")>=0
+            || cCompileArguments.startsWith("-g3")) {
+        cCompileArguments += " -D__DEBUG__";
+        cppCompileArguments+= " -D__DEBUG__";
+    }
+    mCFlags = getCIncludeArguments() + getProjectIncludeArguments() + " " + cCompileArguments;
+    mCppFlags = getCppIncludeArguments() + getProjectIncludeArguments() + " " + cppCompileArguments;
+    if (!mOnlyCheckSyntax)
+        mOutputFile = mProject->executable();
+    return true;
+}
+
+bool ProjectBuilder::prepareForRebuild()
+{
+    removeGeneratedFiles();
+    return true;
+}
+
+void ProjectBuilder::doCompile()
+{
+    mStop = false;
+    if (mOnlyClean) {
+        removeGeneratedFiles();
+        return;
+    }
+    mCompileSteps.clear();
+    mLinkObjects.clear();
+    mPCHFile.clear();
+    mNeedLink = !mOnlyCheckSyntax && !fileExists(mProject->executable());
+    //objects made with other flags are outdated
+    QStringList oldFlags = readBuildFlags();
+    bool cFlagsChanged = !mOnlyCheckSyntax && oldFlags[0]!=mCFlags;
+    bool cppFlagsChanged = !mOnlyCheckSyntax && oldFlags[1]!=mCppFlags;
+
+    if (mProject->options().usePrecompiledHeader && !mOnlyCheckSyntax) {
+        QString header = absolutePath(mProject->options().precompiledHeader);
+        mPCHFile = changeFileExt(header, GCH_EXT);
+        if (cppFlagsChanged || isOutdated(mPCHFile, QStringList{header})) {
+            QString arguments = QString("-x c++-header \"%1\" -o \"%2\" %3")
+                    .arg(header, mPCHFile, mCppFlags);
+            log(extractFileName(compilerSet()->cppCompiler())+" "+arguments);
+            if (!runCommand(compilerSet()->cppCompiler(), arguments, mDirectory))
+                return;
+        }
+    }
+
+    foreach(const PProjectUnit &unit, mProject->unitList()) {
+        FileType fileType = getFileType(unit->fileName());
+        if (fileType!=FileType::CSource && fileType!=FileType::CppSource)
+            continue;
+        if (!unit->compile() && !unit->link())
+            continue;
+        QString objFile = objFileName(unit);
+        if (unit->link())
+            mLinkObjects.append(objFile);
+        if (!unit->compile())
+            continue;
+        bool flagsChanged = unit->compileCpp() ? cppFlagsChanged : cFlagsChanged;
+        if (!mOnlyCheckSyntax && !flagsChanged && !isObjectOutdated(objFile, unit->fileName()))
+            continue;
+        PBuildStep step = std::make_shared<BuildStep>();
+        step->source = unit->fileName();
+        QString flags;
+        if (unit->compileCpp()) {
+            step->program = compilerSet()->cppCompiler();
+            flags = mCppFlags;
+        } else {
+            step->program = compilerSet()->CCompiler();
+            flags = mCFlags;
+        }
+        if (mOnlyCheckSyntax) {
+            step->arguments = QString("-c \"%1\" %2%3")
+                    .arg(unit->fileName(), flags, getUnitCharsetArguments(unit));
+        } else {
+            step->arguments = QString("-c \"%1\" -o \"%2\" -MMD -MP %3%4")
+                    .arg(unit->fileName(), objFile, flags, getUnitCharsetArguments(unit));
+        }
+        mCompileSteps.append(step);
+    }
+
+#ifdef Q_OS_WIN
+    if (!mProject->options().privateResource.isEmpty() && !mOnlyCheckSyntax) {
+        QString resFile = absolutePath(mProject->options().privateResource);
+        if (!mProject->options().objectOutput.isEmpty()) {
+            mResObjFile = absolutePath(includeTrailingPathDelimiter(mProject->options().objectOutput) +
+                  changeFileExt(mProject->options().privateResource, RES_EXT));
+        } else
+            mResObjFile = absolutePath(changeFileExt(mProject->options().privateResource, RES_EXT));
+        QStringList prerequisites{resFile};
+        foreach(const PProjectUnit& unit, mProject->unitList()) {
+            if (getFileType(unit->fileName())==FileType::WindowsResourceSource)
+                prerequisites.append(unit->fileName());
+        }
+        if (isOutdated(mResObjFile, prerequisites)) {
+            QString arguments = QString("-i \"%1\"").arg(resFile);
+            if (getCCompileArguments(false).contains("-m32"))
+                arguments += " -F pe-i386";
+            arguments += QString(" --input-format=rc -o \"%1\" -O coff").arg(mResObjFile);
+            foreach(const QString& folder, mProject->options().resourceIncludes) {
+                if (!folder.isEmpty())
+                    arguments += QString(" --include-dir \"%1\"").arg(folder);
+            }
+            log(extractFileName(compilerSet()->resourceCompiler())+" "+arguments);
+            if (!runCommand(compilerSet()->resourceCompiler(), arguments, mDirectory))
+                return;
+            mNeedLink = true;
+        }
+        mLinkObjects.append(mResObjFile);
+    }
+#endif
+
+    if (!mCompileSteps.isEmpty()) {
+        if (!runSteps(mCompileSteps))
+            return;
+        mNeedLink = true;
+    }
+    if (mOnlyCheckSyntax)
+        return;
+    if (cFlagsChanged || cppFlagsChanged)
+        writeBuildFlags(QStringList{mCFlags, mCppFlags, oldFlags[2]});
+
+    QList<PBuildStep> steps = linkSteps();
+    QString linkCommand = stepsCommand(steps);
+    QStringList prerequisites = mLinkObjects;
+    foreach(const QString& objFile, mProject->options().objFiles) {
+        prerequisites.append(absolutePath(objFile));
+    }
+    if (mProject->options().type != ProjectType::StaticLib)
+        prerequisites.append(linkLibraries(getLibraryArguments(FileType::Project)));
+    if (!mNeedLink && linkCommand == oldFlags[2]
+            && !isOutdated(mProject->executable(), prerequisites)) {
+        log(tr("Nothing to be done for '%1'.").arg(extractFileName(mProject->executable())));
+        return;
+    }
+    if (!link(steps)) {
+        //don't leave a half written target, or it will look up to date next time
+        QFile::remove(mProject->executable());
+        return;
+    }
+    writeBuildFlags(QStringList{mCFlags, mCppFlags, linkCommand});
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef PROJECTBUILDER_H
+#define PROJECTBUILDER_H
+
+#include "projectcompiler.h"
+#include <QDateTime>
+
+/**
+ * @brief Builds a project without generating and running a makefile.
+ *
+ * Out-of-date objects are found from file timestamps and the dependency
+ * files (.d) recorded by the compiler, compiled by at most buildJobs()
+ * concurrent compiler processes, and then linked.
+ *
+ * The compile flags and link commands of the last build are kept in a
+ * flags file, so a change of options rebuilds what it affects.
+ */
+class ProjectBuilder : public ProjectCompiler
+{
+    Q_OBJECT
+public:
+    ProjectBuilder(std::shared_ptr<Project> project, bool silent,bool onlyCheckSyntax);
+
+    //projects that rely on makefile features must be built by make
+    static bool canBuild(const std::shared_ptr<Project>& project);
+
+private:
+    struct BuildStep {
+        QString source;
+        QString program;
+        QString arguments;
+    };
+    using PBuildStep = std::shared_ptr<BuildStep>;
+
+    QString objFileName(const PProjectUnit& unit) const;
+    QString absolutePath(const QString& fileName) const;
+    QStringList readDependencies(const QString& depFile) const;
+    bool isOutdated(const QString& target, const QStringList& prerequisites) const;
+    bool isObjectOutdated(const QString& objFile, const QString& sourceFile) const;
+    bool runSteps(const QList<PBuildStep>& steps);
+    QList<PBuildStep> linkSteps();
+    //library files the link arguments refer to, found in their -L dirs
+    QStringList linkLibraries(const QString& arguments) const;
+    static QString stepsCommand(const QList<PBuildStep>& steps);
+    bool link(const QList<PBuildStep>& steps);
+    QString buildFlagsFile() const;
+    //C flags, C++ flags and link command of the last build
+    QStringList readBuildFlags() const;
+    void writeBuildFlags(const QStringList& flags) const;
+    QStringList generatedFiles();
+    void removeGeneratedFiles();
+
+    // Compiler interface
+protected:
+    bool prepareForCompile() override;
+    bool prepareForRebuild() override;
+    void doCompile() override;
+
+private:
+    QString mCFlags;
+    QString mCppFlags;
+    QString mPCHFile;
+    QDateTime mPCHTime;
+    QString mResObjFile;
+    QStringList mLinkObjects;
+    QList<PBuildStep> mCompileSteps;
+    bool mNeedLink;
+};
+
+#endif // PROJECTBUILDER_H
@@ -20,8 +20,11 @@
 #include "../systemconsts.h"
 #include "qt_utils/charsetinfo.h"
 #include "../editor.h"
+#include "../utils.h"
 
 #include <QDir>
+#include <QMutex>
+#include <QRegularExpression>
 
 ProjectCompiler::ProjectCompiler(std::shared_ptr<Project> project, bool silent, bool onlyCheckSyntax):
     Compiler("",silent,onlyCheckSyntax),
@@ -139,6 +142,7 @@ void ProjectCompiler::writeMakeDefines(QFile &file)
     QString Objects;
     QString LinkObjects;
     QString cleanObjects;
+    QString depFiles;
 
     // Create a list of object files
     foreach(const PProjectUnit &unit, mProject->unitList()) {
@@ -156,20 +160,26 @@ void ProjectCompiler::writeMakeDefines(QFile &file)
                 QString relativeObjFile = extractRelativePath(mProject->directory(), changeFileExt(fullObjFile, OBJ_EXT));
                 QString ObjFile = genMakePath2(relativeObjFile);
                 Objects += ' ' + ObjFile;
+                depFiles += ' ' + genMakePath2(changeFileExt(relativeObjFile, DEP_EXT));
 #ifdef Q_OS_WIN
                 cleanObjects += ' ' + genMakePath1(relativeObjFile).replace("/",QDir::separator());
+                cleanObjects += ' ' + genMakePath1(changeFileExt(relativeObjFile, DEP_EXT)).replace("/",QDir::separator());
 #else
                 cleanObjects += ' ' + genMakePath1(relativeObjFile);
+                cleanObjects += ' ' + genMakePath1(changeFileExt(relativeObjFile, DEP_EXT));
 #endif
                 if (unit->link()) {
                     LinkObjects += ' ' + genMakePath1(relativeObjFile);
                 }
             } else {
                 Objects += ' ' + genMakePath2(changeFileExt(RelativeName, OBJ_EXT));
+                depFiles += ' ' + genMakePath2(changeFileExt(RelativeName, DEP_EXT));
 #ifdef Q_OS_WIN
                 cleanObjects += ' ' + genMakePath1(changeFileExt(RelativeName, OBJ_EXT)).replace("/",QDir::separator());
+                cleanObjects += ' ' + genMakePath1(changeFileExt(RelativeName, DEP_EXT)).replace("/",QDir::separator());
 #else
                 cleanObjects += ' ' + genMakePath1(changeFileExt(RelativeName, OBJ_EXT));
+                cleanObjects += ' ' + genMakePath1(changeFileExt(RelativeName, DEP_EXT));
 #endif
                 if (unit->link())
                     LinkObjects = LinkObjects + ' ' + genMakePath1(changeFileExt(RelativeName, OBJ_EXT));
@@ -179,6 +189,7 @@ void ProjectCompiler::writeMakeDefines(QFile &file)
 
     Objects = Objects.trimmed();
     LinkObjects = LinkObjects.trimmed();
+    depFiles = depFiles.trimmed();
 
     // Get windres file
     QString ObjResFile;
@@ -239,6 +250,8 @@ void ProjectCompiler::writeMakeDefines(QFile &file)
               + " " + genMakePath1(extractRelativePath(mProject->makeFileName(), mProject->executable())));
 #endif
     };
+    // dependency files generated by the compiler (-MMD -MP)
+    writeln(file,"DEPS     = " + depFiles);
     libraryArguments.replace('\\', '/');
     writeln(file,"LIBS     = " + libraryArguments);
     cIncludeArguments.replace('\\', '/');
@@ -318,12 +331,17 @@ void ProjectCompiler::writeMakeClean(QFile &file)
 
 void ProjectCompiler::writeMakeObjFilesRules(QFile &file)
 {
-    PCppParser parser = mProject->cppParser();
     QString precompileStr;
     if (mProject->options().usePrecompiledHeader)
         precompileStr = " $(PCH) ";
 
-    QList<PProjectUnit> projectUnits;
+    //header dependencies are generated by the compiler (-MMD -MP) while building,
+    //and included at the end of the makefile
+    QString depGenStr;
+    if (!mOnlyCheckSyntax)
+        depGenStr = " -MMD -MP";
+
+    QList<PProjectUnit> projectUnits=mProject->unitList();
     foreach(const PProjectUnit &unit, projectUnits) {
         FileType fileType = getFileType(unit->fileName());
         // Only process source files
@@ -334,29 +352,6 @@ void ProjectCompiler::writeMakeObjFilesRules(QFile &file)
 
         writeln(file);
         QString objStr=genMakePath2(shortFileName);
-        // if we have scanned it, use scanned info
-        if (parser && parser->scannedFiles().contains(unit->fileName())) {
-            QSet<QString> fileIncludes = parser->getFileIncludes(unit->fileName());
-            foreach (const QString& headerName, fileIncludes) {
-                if (headerName == unit->fileName())
-                    continue;
-                if (!parser->isSystemHeaderFile(headerName)
-                        && ! parser->isProjectHeaderFile(headerName)) {
-                    foreach(const PProjectUnit &unit2, projectUnits) {
-                        if (unit2->fileName()==headerName) {
-                            objStr = objStr + ' ' + genMakePath2(extractRelativePath(mProject->makeFileName(),headerName));
-                            break;
-                        }
-                    }
-                }
-            }
-        } else {
-            foreach(const PProjectUnit &unit2, projectUnits) {
-                FileType fileType = getFileType(unit2->fileName());
-                if (fileType == FileType::CHeader || fileType==FileType::CppHeader)
-                    objStr = objStr + ' ' + genMakePath2(extractRelativePath(mProject->makeFileName(),unit2->fileName()));
-            }
-        }
         QString ObjFileName;
         QString ObjFileName2;
         if (!mProject->options().objectOutput.isEmpty()) {
@@ -383,41 +378,7 @@ void ProjectCompiler::writeMakeObjFilesRules(QFile &file)
             writeln(file, '\t' + BuildCmd);
             // Or roll our own
         } else {
-            QString encodingStr;
-            if (compilerSet()->compilerType() != COMPILER_CLANG && mProject->options().addCharset) {
-                QByteArray defaultSystemEncoding=pCharsetInfoManager->getDefaultSystemEncoding();
-                QByteArray encoding = mProject->options().execEncoding;
-                QByteArray targetEncoding;
-                QByteArray sourceEncoding;
-                if ( encoding == ENCODING_SYSTEM_DEFAULT || encoding.isEmpty()) {
-                    targetEncoding = defaultSystemEncoding;
-                } else if (encoding == ENCODING_UTF8_BOM) {
-                    targetEncoding = "UTF-8";
-                } else {
-                    targetEncoding = encoding;
-                }
-
-                if (unit->encoding() == ENCODING_AUTO_DETECT) {
-                    Editor* editor = mProject->unitEditor(unit);
-                    if (editor && editor->fileEncoding()!=ENCODING_ASCII
-                            && editor->fileEncoding()!=targetEncoding) {
-                        sourceEncoding = editor->fileEncoding();
-                    } else {
-                        sourceEncoding = targetEncoding;
-                    }
-                } else if (unit->encoding()==ENCODING_SYSTEM_DEFAULT) {
-                    sourceEncoding = defaultSystemEncoding;
-                } else if (unit->encoding()!=ENCODING_ASCII && !unit->encoding().isEmpty()
-                           && unit->encoding()!=targetEncoding) {
-                    sourceEncoding = unit->encoding();
-                }
-
-                if (sourceEncoding!=targetEncoding) {
-                    encodingStr = QString(" -finput-charset=%1 -fexec-charset=%2")
-                            .arg(QString(sourceEncoding),
-                                 QString(targetEncoding));
-                }
-            }
+            QString encodingStr = getUnitCharsetArguments(unit);
 
             if (mOnlyCheckSyntax) {
                 if (unit->compileCpp())
@@ -426,9 +387,9 @@ void ProjectCompiler::writeMakeObjFilesRules(QFile &file)
                     writeln(file, "\t(CC) -c " + genMakePath1(unit->fileName()) + " $(CFLAGS) " + encodingStr);
             } else {
                 if (unit->compileCpp())
-                    writeln(file, "\t$(CPP) -c " + genMakePath1(unit->fileName()) + " -o " + ObjFileName2 + " $(CXXFLAGS) " + encodingStr);
+                    writeln(file, "\t$(CPP) -c " + genMakePath1(unit->fileName()) + " -o " + ObjFileName2 + depGenStr + " $(CXXFLAGS) " + encodingStr);
                 else
-                    writeln(file, "\t$(CC) -c " + genMakePath1(unit->fileName()) + " -o " + ObjFileName2 + " $(CFLAGS) " + encodingStr);
+                    writeln(file, "\t$(CC) -c " + genMakePath1(unit->fileName()) + " -o " + ObjFileName2 + depGenStr + " $(CFLAGS) " + encodingStr);
             }
         }
     }
@@ -487,6 +448,51 @@ void ProjectCompiler::writeMakeObjFilesRules(QFile &file)
         writeln(file);
     }
 #endif
+
+    if (!mOnlyCheckSyntax) {
+        writeln(file);
+        writeln(file, "-include $(DEPS)");
+    }
+}
+
+QString ProjectCompiler::getUnitCharsetArguments(const PProjectUnit &unit)
+{
+    QString encodingStr;
+    if (compilerSet()->compilerType() != COMPILER_CLANG && mProject->options().addCharset) {
+        QByteArray defaultSystemEncoding=pCharsetInfoManager->getDefaultSystemEncoding();
+        QByteArray encoding = mProject->options().execEncoding;
+        QByteArray targetEncoding;
+        QByteArray sourceEncoding;
+        if ( encoding == ENCODING_SYSTEM_DEFAULT || encoding.isEmpty()) {
+            targetEncoding = defaultSystemEncoding;
+        } else if (encoding == ENCODING_UTF8_BOM) {
+            targetEncoding = "UTF-8";
+        } else {
+            targetEncoding = encoding;
+        }
+
+        if (unit->encoding() == ENCODING_AUTO_DETECT) {
+            Editor* editor = mProject->unitEditor(unit);
+            if (editor && editor->fileEncoding()!=ENCODING_ASCII
+                    && editor->fileEncoding()!=targetEncoding) {
+                sourceEncoding = editor->fileEncoding();
+            } else {
+                sourceEncoding = targetEncoding;
+            }
+        } else if (unit->encoding()==ENCODING_SYSTEM_DEFAULT) {
+            sourceEncoding = defaultSystemEncoding;
+        } else if (unit->encoding()!=ENCODING_ASCII && !unit->encoding().isEmpty()
+                   && unit->encoding()!=targetEncoding) {
+            sourceEncoding = unit->encoding();
+        }
+
+        if (sourceEncoding!=targetEncoding) {
+            encodingStr = QString(" -finput-charset=%1 -fexec-charset=%2")
+                    .arg(QString(sourceEncoding),
+                         QString(targetEncoding));
+        }
+    }
+    return encodingStr;
 }
 
 void ProjectCompiler::writeln(QFile &file, const QString &s)
@@ -508,8 +514,40 @@ void ProjectCompiler::setOnlyClean(bool newOnlyClean)
 
 bool ProjectCompiler::prepareForRebuild()
 {
-    //we use make argument to clean
-    return true;
+    //clean in a separate make run, "clean all" is not safe for parallel builds
+    QString arguments = QString("-f \"%1\" clean").arg(extractRelativePath(
+                                                        mProject->directory(),
+                                                        mProject->makeFileName()));
+    log(tr("- Command: %1 %2").arg(extractFileName(mCompiler),arguments));
+    return runCommand(mCompiler, arguments, mDirectory);
+}
+
+int ProjectCompiler::buildJobs() const
+{
+    int jobs = pSettings->environment().buildJobs();
+    if (jobs<=0)
+        jobs = QThread::idealThreadCount();
+    return std::max(jobs,1);
+}
+
+bool ProjectCompiler::makeSupportsOutputSync(const QString &make)
+{
+    //--output-sync is available since GNU make 4.0
+    static QMutex mutex;
+    static QHash<QString,bool> supported;
+    QMutexLocker locker(&mutex);
+    auto it = supported.find(make);
+    if (it!=supported.end())
+        return it.value();
+    bool result = false;
+    QByteArray output = runAndGetOutput(make, extractFileDir(make), QStringList{"--version"},
+                                        QByteArray(), true);
+    QRegularExpression regexp("GNU Make (\\d+)\\.");
+    QRegularExpressionMatch match = regexp.match(QString::fromLocal8Bit(output));
+    if (match.hasMatch())
+        result = match.captured(1).toInt()>=4;
+    supported.insert(make,result);
+    return result;
 }
 
 bool ProjectCompiler::prepareForCompile()
@@ -526,16 +564,22 @@ bool ProjectCompiler::prepareForCompile()
     buildMakeFile();
 
     mCompiler = compilerSet()->make();
+    QString parallelArgs;
+    if (!mOnlyClean) {
+        int jobs = buildJobs();
+        if (jobs>1) {
+            parallelArgs = QString("-j%1 ").arg(jobs);
+            // keep the output of each object file together
+            if (makeSupportsOutputSync(mCompiler))
+                parallelArgs += "--output-sync=target ";
+        }
+    }
     if (mOnlyClean) {
         mArguments = QString("-f \"%1\" clean").arg(extractRelativePath(
                                                             mProject->directory(),
                                                             mProject->makeFileName()));
-    } else if (mRebuild) {
-        mArguments = QString("-f \"%1\" clean all").arg(extractRelativePath(
-                                                            mProject->directory(),
-                                                            mProject->makeFileName()));
     } else {
-        mArguments = QString("-f \"%1\" all").arg(extractRelativePath(
+        mArguments = parallelArgs + QString("-f \"%1\" all").arg(extractRelativePath(
                                                       mProject->directory(),
                                                       mProject->makeFileName()));
     }
@@ -22,6 +22,8 @@
 #include <QFile>
 
 class Project;
+class ProjectUnit;
+using PProjectUnit = std::shared_ptr<ProjectUnit>;
 class ProjectCompiler : public Compiler
 {
     Q_OBJECT
@@ -44,8 +46,12 @@ private:
     void writeMakeClean(QFile& file);
     void writeMakeObjFilesRules(QFile& file);
     void writeln(QFile& file, const QString& s="");
+    static bool makeSupportsOutputSync(const QString& make);
+protected:
+    QString getUnitCharsetArguments(const PProjectUnit& unit);
+    int buildJobs() const;
     // Compiler interface
-private:
+protected:
     bool mOnlyClean;
 protected:
     bool prepareForCompile() override;
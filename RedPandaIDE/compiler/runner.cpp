@@ -33,6 +33,7 @@ void Runner::stop()
 {
     mStop = true;
     doStop();
+    emit stopRequested();
 }
 
 void Runner::doStop()
@@ -36,6 +36,8 @@ signals:
     void terminated();
     void runErrorOccurred(const QString& reason);
     void pausingForFinish(); // finish but pausing
+    //emitted by stop(), to wake up the event loops waiting for processes
+    void stopRequested();
 
 public slots:
     void stop();
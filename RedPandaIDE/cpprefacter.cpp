@@ -198,16 +198,34 @@ PSearchResultTreeItem CppRefacter::findOccurenceInFile(
     PSearchResultTreeItem parentItem = std::make_shared<SearchResultTreeItem>();
     parentItem->filename = filename;
     parentItem->parent = nullptr;
-    QStringList buffer;
+    QVector<IdentifierPosition> positions;
+    bool indexed = findIndexedPositions(filename, statement->command, parser, positions);
+    //the symbol is not used in the file
+    if (indexed && positions.isEmpty())
+        return parentItem;
     Editor editor(nullptr);
-    if (pMainWindow->editorList()->getContentFromOpenedEditor(
-                filename,buffer)){
-        editor.document()->setContents(buffer);
-    } else {
-        QByteArray encoding;
-        editor.document()->loadFromFile(filename,ENCODING_AUTO_DETECT,encoding);
-    }
+    loadContents(editor, filename);
     editor.setHighlighter(HighlighterManager().getCppHighlighter());
+    if (indexed && !isIndexStale(editor, statement->command, positions)) {
+        //only check where the name appears
+        foreach (const IdentifierPosition& pos, positions) {
+            QSynedit::BufferCoord p;
+            p.line = pos.line;
+            p.ch = pos.column+1;
+            if (isOccurence(editor, filename, p, statement, parser)) {
+                PSearchResultTreeItem item = std::make_shared<SearchResultTreeItem>();
+                item->filename = filename;
+                item->line = p.line;
+                item->start = pos.column;
+                item->len = statement->command.length();
+                item->parent = parentItem.get();
+                item->text = editor.document()->getString(pos.line-1);
+                item->text.replace('\t',' ');
+                parentItem->results.append(item);
+            }
+        }
+        return parentItem;
+    }
     int posY = 0;
     while (posY < editor.document()->count()) {
         QString line = editor.document()->getString(posY);
@@ -234,13 +252,7 @@ PSearchResultTreeItem CppRefacter::findOccurenceInFile(
                     p.line = posY+1;
                     p.ch = start+1;
 
-                    QStringList expression = editor.getExpressionAtPosition(p);
-                    PStatement tokenStatement = parser->findStatementOf(
-                                filename,
-                                expression, p.line);
-                    if (tokenStatement
-                            && (tokenStatement->line == statement->line)
-                            && (tokenStatement->fileName == statement->fileName)) {
+                    if (isOccurence(editor, filename, p, statement, parser)) {
                         PSearchResultTreeItem item = std::make_shared<SearchResultTreeItem>();
                         item->filename = filename;
                         item->line = p.line;
@@ -262,53 +274,54 @@ PSearchResultTreeItem CppRefacter::findOccurenceInFile(
 
 void CppRefacter::renameSymbolInFile(const QString &filename, const PStatement &statement,  const QString &newWord, const PCppParser &parser)
 {
-    QStringList buffer;
     Editor editor(nullptr);
-    if (pMainWindow->editorList()->getContentFromOpenedEditor(
-                filename,buffer)){
-        editor.document()->setContents(buffer);
-    } else {
-        QByteArray encoding;
-        editor.document()->loadFromFile(filename,ENCODING_AUTO_DETECT,encoding);
-    }
+    loadContents(editor, filename);
     QStringList newContents;
     editor.setHighlighter(HighlighterManager().getCppHighlighter());
-    int posY = 0;
-    while (posY < editor.document()->count()) {
-        QString line = editor.document()->getString(posY);
-
-        if (posY == 0) {
-            editor.highlighter()->resetState();
-        } else {
-            editor.highlighter()->setState(
-                        editor.document()->ranges(posY-1));
+    QVector<IdentifierPosition> positions;
+    if (findIndexedPositions(filename, statement->command, parser, positions)
+            && !isIndexStale(editor, statement->command, positions)) {
+        newContents = editor.contents();
+        //replace from the end, so columns of the positions before are not changed
+        for (int i=positions.count()-1;i>=0;i--) {
+            const IdentifierPosition& pos = positions[i];
+            QSynedit::BufferCoord p;
+            p.line = pos.line;
+            p.ch = pos.column;
+            if (isOccurence(editor, filename, p, statement, parser))
+                newContents[pos.line-1].replace(pos.column-1, statement->command.length(), newWord);
         }
-        editor.highlighter()->setLine(line,posY);
-        QString newLine;
-        while (!editor.highlighter()->eol()) {
-            int start = editor.highlighter()->getTokenPos() + 1;
-            QString token = editor.highlighter()->getToken();
-            if (token == statement->command) {
-                //same name symbol , test if the same statement;
-                QSynedit::BufferCoord p;
-                p.line = posY+1;
-                p.ch = start;
+    } else {
+        int posY = 0;
+        while (posY < editor.document()->count()) {
+            QString line = editor.document()->getString(posY);
+
+            if (posY == 0) {
+                editor.highlighter()->resetState();
+            } else {
+                editor.highlighter()->setState(
+                            editor.document()->ranges(posY-1));
+            }
+            editor.highlighter()->setLine(line,posY);
+            QString newLine;
+            while (!editor.highlighter()->eol()) {
+                int start = editor.highlighter()->getTokenPos() + 1;
+                QString token = editor.highlighter()->getToken();
+                if (token == statement->command) {
+                    //same name symbol , test if the same statement;
+                    QSynedit::BufferCoord p;
+                    p.line = posY+1;
+                    p.ch = start;
 
-                QStringList expression = editor.getExpressionAtPosition(p);
-                PStatement tokenStatement = parser->findStatementOf(
-                            filename,
-                            expression, p.line);
-                if (tokenStatement
-                        && (tokenStatement->line == statement->line)
-                        && (tokenStatement->fileName == statement->fileName)) {
-                    token = newWord;
+                    if (isOccurence(editor, filename, p, statement, parser))
+                        token = newWord;
                 }
+                newLine += token;
+                editor.highlighter()->next();
             }
-            newLine += token;
-            editor.highlighter()->next();
+            newContents.append(newLine);
+            posY++;
         }
-        newContents.append(newLine);
-        posY++;
     }
 
     Editor * oldEditor = pMainWindow->editorList()->getOpenedEditorByFilename(filename);
@@ -327,8 +340,53 @@ void CppRefacter::renameSymbolInFile(const QString &filename, const PStatement &
     } else {
         QByteArray realEncoding;
         QFile file(filename);
+        editor.document()->setContents(newContents);
         editor.document()->saveToFile(file,ENCODING_AUTO_DETECT,
                                    pSettings->editor().defaultEncoding(),
                                    realEncoding);
     }
 }
+
+bool CppRefacter::findIndexedPositions(const QString &filename, const QString &identifier, const PCppParser &parser, QVector<IdentifierPosition> &positions)
+{
+    //unsaved changes may not be parsed yet
+    Editor * openedEditor = pMainWindow->editorList()->getOpenedEditorByFilename(filename);
+    if (openedEditor && openedEditor->modified())
+        return false;
+    return parser->findIdentifierPositions(filename, identifier, positions);
+}
+
+bool CppRefacter::isIndexStale(Editor &editor, const QString &identifier, const QVector<IdentifierPosition> &positions)
+{
+    //the file is changed after it's parsed
+    foreach (const IdentifierPosition& pos, positions) {
+        if (pos.line > editor.document()->count())
+            return true;
+        if (editor.document()->getString(pos.line-1).midRef(pos.column-1, identifier.length())!=identifier)
+            return true;
+    }
+    return false;
+}
+
+bool CppRefacter::isOccurence(Editor &editor, const QString &filename, const QSynedit::BufferCoord &pos, const PStatement &statement, const PCppParser &parser)
+{
+    QStringList expression = editor.getExpressionAtPosition(pos);
+    PStatement tokenStatement = parser->findStatementOf(
+                filename,
+                expression, pos.line);
+    return tokenStatement
+            && (tokenStatement->line == statement->line)
+            && (tokenStatement->fileName == statement->fileName);
+}
+
+void CppRefacter::loadContents(Editor &editor, const QString &filename)
+{
+    QStringList buffer;
+    if (pMainWindow->editorList()->getContentFromOpenedEditor(
+                filename,buffer)){
+        editor.document()->setContents(buffer);
+    } else {
+        QByteArray encoding;
+        editor.document()->loadFromFile(filename,ENCODING_AUTO_DETECT,encoding);
+    }
+}
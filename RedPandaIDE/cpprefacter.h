@@ -49,6 +49,22 @@ private:
             const PStatement& statement,
             const QString& newWord,
             const PCppParser& parser);
+    bool findIndexedPositions(
+            const QString& filename,
+            const QString& identifier,
+            const PCppParser& parser,
+            QVector<IdentifierPosition>& positions);
+    bool isIndexStale(
+            Editor& editor,
+            const QString& identifier,
+            const QVector<IdentifierPosition>& positions);
+    bool isOccurence(
+            Editor& editor,
+            const QString& filename,
+            const QSynedit::BufferCoord& pos,
+            const PStatement& statement,
+            const PCppParser& parser);
+    void loadContents(Editor& editor, const QString& filename);
 };
 
 #endif // CPPREFACTER_H
@@ -26,8 +26,10 @@
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QPlainTextEdit>
+#include <QColor>
 #include <QDebug>
 #include <QDir>
+#include <QEventLoop>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
@@ -45,6 +47,8 @@ Debugger::Debugger(QObject *parent) : QObject(parent),
 
     connect(mMemoryModel,&MemoryModel::setMemoryData,
             this, &Debugger::setMemoryData);
+    connect(mMemoryModel,&MemoryModel::fetchPage,
+            this, &Debugger::fetchMemoryPage);
     connect(mWatchModel, &WatchModel::setWatchVarValue,
             this, &Debugger::setWatchVarValue);
     mExecuting = false;
@@ -52,9 +56,25 @@ Debugger::Debugger(QObject *parent) : QObject(parent),
     mTarget = nullptr;
     mCommandChanged = false;
     mLeftPageIndexBackup = -1;
+    mCurrentAddress = 0;
+    mTraceRecorder = new TraceRecorder(this);
+    mTraceSampling = false;
+    connect(&mTraceTimer, &QTimer::timeout,
+            this, &Debugger::sampleTrace);
 
     connect(mWatchModel, &WatchModel::fetchChildren,
             this, &Debugger::fetchVarChildren);
+    connect(mWatchModel, &WatchModel::releaseChildren,
+            this, &Debugger::releaseVarChildren);
+    connect(mWatchModel, &WatchModel::releaseVar,
+            this, &Debugger::releaseVar);
+    connect(mBacktraceModel, &BacktraceModel::fetchTraces,
+            this, &Debugger::fetchStackFrames);
+    connect(mBreakpointModel, &BreakpointModel::breakpointsRemoved,
+            this, &Debugger::sendClearBreakpointsCommand);
+    mLocalsOutdated = false;
+    mMemoryOutdated = false;
+    mStackFramesOutdated = false;
 }
 
 Debugger::~Debugger()
@@ -122,6 +142,10 @@ bool Debugger::start(int compilerSetIndex, const QString& inferior, const QStrin
     }
     mMemoryModel->reset();
     mWatchModel->resetAllVarInfos();
+    mCurrentAddress = 0;
+    mDisassemblyCache.clear();
+    mTraceRecorder->clear();
+    mTraceSampling = false;
     if (pSettings->debugger().useGDBServer()) {
         //deleted when thread finished
         mTarget = new DebugTarget(inferior,compilerSet->debugServer(),pSettings->debugger().GDBServerPort());
@@ -156,8 +180,10 @@ bool Debugger::start(int compilerSetIndex, const QString& inferior, const QStrin
             &BreakpointModel::updateBreakpointNumber);
     connect(mReader, &DebugReader::localsUpdated, pMainWindow,
             &MainWindow::onLocalsReady);
-    connect(mReader, &DebugReader::memoryUpdated,this,
-            &Debugger::updateMemory);
+    connect(mReader, &DebugReader::memoryPageUpdated,mMemoryModel,
+            &MemoryModel::updatePage);
+    connect(mReader, &DebugReader::memoryAddressLocated,this,
+            &Debugger::onMemoryAddressLocated);
     connect(mReader, &DebugReader::evalUpdated,this,
             &Debugger::updateEval);
     connect(mReader, &DebugReader::disassemblyUpdate,this,
@@ -172,18 +198,29 @@ bool Debugger::start(int compilerSetIndex, const QString& inferior, const QStrin
             &WatchModel::prepareVarChildren);
     connect(mReader, &DebugReader::addVarChild,mWatchModel,
             &WatchModel::addVarChild);
+    connect(mReader, &DebugReader::varChildrenFetched,mWatchModel,
+            &WatchModel::finishVarChildren);
     connect(mReader, &DebugReader::varValueUpdated,mWatchModel,
             &WatchModel::updateVarValue);
     connect(mReader, &DebugReader::varsValueUpdated,mWatchModel,
             &WatchModel::updateAllHasMoreVars);
     connect(mReader, &DebugReader::inferiorContinued,pMainWindow,
             &MainWindow::removeActiveBreakpoints);
+    connect(mReader, &DebugReader::inferiorContinued,mMemoryModel,
+            &MemoryModel::cancelFetches);
+    connect(mReader, &DebugReader::inferiorStopped,mMemoryModel,
+            &MemoryModel::cancelFetches);
     connect(mReader, &DebugReader::inferiorStopped,pMainWindow,
             &MainWindow::setActiveBreakpoint);
     connect(mReader, &DebugReader::inferiorStopped,this,
             &Debugger::refreshAll);
+    connect(mReader, &DebugReader::inferiorStopped,this,
+            &Debugger::resetTraceSampling);
+    connect(mReader, &DebugReader::traceSampleStopped,this,
+            &Debugger::onTraceSampleStopped);
+    connect(mReader, &DebugReader::traceSampled,this,
+            &Debugger::onTraceSampled);
 
-    mReader->registerInferiorStoppedCommand("-stack-list-frames","");
     mReader->start();
     mReader->waitStart();
 
@@ -205,6 +242,7 @@ void Debugger::cleanUpReader()
 {
     if (mExecuting) {
         mExecuting = false;
+        stopTraceRecording();
 
         //stop debugger
         mReader->deleteLater();
@@ -224,6 +262,9 @@ void Debugger::cleanUpReader()
         pMainWindow->updateDebugEval("");
 
         mBacktraceModel->clear();
+        mLocalsOutdated = false;
+        mMemoryOutdated = false;
+        mStackFramesOutdated = false;
 
         mWatchModel->clearAllVarInfos();
 
@@ -245,14 +286,47 @@ void Debugger::updateRegisterValues(const QHash<int, QString> &values)
 
 void Debugger::refreshAll()
 {
+    //watch vars are updated by changelists (-var-update);
+    //the other views are only queried if they are visible
     refreshWatchVars();
-    sendCommand("-stack-list-variables", "--all-values");
-    if (memoryModel()->startAddress()>0)
-        sendCommand("-data-read-memory",QString("%1 x 1 %2 %3 ")
-                    .arg(memoryModel()->startAddress())
-                    .arg(pSettings->debugger().memoryViewRows())
-                    .arg(pSettings->debugger().memoryViewColumns())
-                    );
+    mLocalsOutdated = true;
+    mMemoryOutdated = true;
+    mStackFramesOutdated = true;
+    refreshVisibleViews();
+}
+
+void Debugger::refreshVisibleViews()
+{
+    if (!mExecuting || inferiorRunning())
+        return;
+    if (mStackFramesOutdated && pMainWindow->isStackTraceViewVisible()) {
+        mStackFramesOutdated = false;
+        fetchStackFrames(0);
+    }
+    if (mLocalsOutdated && pMainWindow->isLocalsViewVisible()) {
+        mLocalsOutdated = false;
+        //locals are not tracked by var objects and -var-update: the value of a
+        //struct or array var object is only "{...}", while the locals view shows
+        //the whole value; and var objects must be created again for each new
+        //frame, which costs more than this one command when stepping into calls
+        sendCommand("-stack-list-variables", "--all-values");
+    }
+    if (mMemoryOutdated && pMainWindow->isMemoryViewVisible()) {
+        mMemoryOutdated = false;
+        //the shown pages are fetched again by the view
+        mMemoryModel->invalidate();
+    }
+}
+
+void Debugger::examineMemory(const QString &address)
+{
+    if (mExecuting) {
+        //read one byte to get the value of the address expression,
+        //params are "address size", see DebugReader::handleMemoryBytes()
+        QString s = address;
+        s.replace('\\',"\\\\").replace('"',"\\\"");
+        sendCommand("-data-read-memory-bytes",QString("\"%1\" 1").arg(s));
+    }
 }
 
 RegisterModel *Debugger::registerModel() const
@@ -293,6 +367,61 @@ void Debugger::interrupt()
     sendCommand("-exec-interrupt", "");
 }
 
+void Debugger::startTraceRecording()
+{
+    if (!mExecuting)
+        return;
+    mTraceRecorder->clear();
+    mTraceSampling = false;
+    mTraceTimer.start(pSettings->debugger().traceSampleInterval());
+}
+
+void Debugger::stopTraceRecording()
+{
+    mTraceTimer.stop();
+}
+
+bool Debugger::traceRecording() const
+{
+    return mTraceTimer.isActive();
+}
+
+TraceRecorder *Debugger::traceRecorder() const
+{
+    return mTraceRecorder;
+}
+
+void Debugger::sampleTrace()
+{
+    //samples are only taken while the program runs freely,
+    //and one at a time
+    if (!mExecuting || mTraceSampling || !inferiorRunning() || commandRunning())
+        return;
+    mTraceSampling = true;
+    sendCommand("-exec-interrupt", "", DebugCommandSource::TraceSample);
+}
+
+void Debugger::onTraceSampleStopped()
+{
+    //the interrupted frame may be in a system library or in another thread,
+    //so look for the innermost frame of the main thread that has source info
+    sendCommand("-stack-list-frames", "--thread 1 0 19", DebugCommandSource::TraceSample);
+}
+
+void Debugger::onTraceSampled(const QString &filename, int line)
+{
+    if (!filename.isEmpty())
+        mTraceRecorder->addSample(filename,line);
+    mTraceSampling = false;
+    sendCommand("-exec-continue", "", DebugCommandSource::TraceSample);
+}
+
+void Debugger::resetTraceSampling()
+{
+    //the program stopped for some other reason before the sample is taken
+    mTraceSampling = false;
+}
+
 void Debugger::addBreakpoint(int line, const Editor* editor)
 {
     addBreakpoint(line,editor->filename());
@@ -315,12 +444,13 @@ void Debugger::addBreakpoint(int line, const QString &filename)
 
 void Debugger::deleteBreakpoints(const QString &filename)
 {
-    for (int i=mBreakpointModel->breakpoints().size()-1;i>=0;i--) {
-        PBreakpoint bp = mBreakpointModel->breakpoints()[i];
-        if (bp->filename == filename) {
-            mBreakpointModel->removeBreakpoint(i);
-        }
+    QList<int> rows;
+    const QList<PBreakpoint>& breakpoints=mBreakpointModel->breakpoints();
+    for (int i=0;i<breakpoints.size();i++) {
+        if (breakpoints[i]->filename == filename)
+            rows.append(i);
     }
+    deleteBreakpointRows(rows);
 }
 
 void Debugger::deleteBreakpoints(const Editor *editor)
@@ -330,9 +460,23 @@ void Debugger::deleteBreakpoints(const Editor *editor)
 
 void Debugger::deleteBreakpoints()
 {
-    for (int i=mBreakpointModel->breakpoints().size()-1;i>=0;i--) {
-        removeBreakpoint(i);
+    QList<int> rows;
+    for (int i=0;i<mBreakpointModel->breakpoints().size();i++) {
+        rows.append(i);
     }
+    deleteBreakpointRows(rows);
+}
+
+void Debugger::deleteBreakpointRows(const QList<int> &rows)
+{
+    QList<int> numbers;
+    foreach (int row, rows) {
+        PBreakpoint bp = mBreakpointModel->breakpoints()[row];
+        if (bp->number>=0)
+            numbers.append(bp->number);
+    }
+    mBreakpointModel->removeBreakpoints(rows);
+    sendClearBreakpointsCommand(numbers);
 }
 
 void Debugger::removeBreakpoint(int line, const Editor *editor)
@@ -406,6 +550,7 @@ void Debugger::addWatchVar(const QString &expression)
     var->value = tr("Execute to evaluate");
     var->numChild = 0;
     var->hasMore = false;
+    var->fetchingChildren = false;
     var->parent = nullptr;
 
     mWatchModel->addWatchVar(var);
@@ -430,6 +575,8 @@ void Debugger::modifyWatchVarExpression(const QString &oldExpr, const QString &n
         var->numChild=0;
         var->name.clear();
         var->children.clear();
+        var->moreChildren.reset();
+        var->fetchingChildren = false;
 
         if (mExecuting) {
             sendWatchCommand(var);
@@ -445,10 +592,39 @@ void Debugger::refreshWatchVars()
     }
 }
 
-void Debugger::fetchVarChildren(const QString &varName)
+void Debugger::fetchVarChildren(const QString &varName, int from)
+{
+    if (mExecuting && mReader) {
+        PDebugCommand pCmd = std::make_shared<DebugCommand>();
+        pCmd->command = "-var-list-children";
+        pCmd->params = varName;
+        pCmd->source = DebugCommandSource::Other;
+        pCmd->from = from;
+        pCmd->to = from+WATCH_CHILDREN_PAGE_SIZE;
+        mReader->postCommand(pCmd);
+    }
+}
+
+void Debugger::releaseVarChildren(const QString &varName)
+{
+    if (mExecuting) {
+        sendCommand("-var-delete",QString("-c %1").arg(varName));
+    }
+}
+
+void Debugger::releaseVar(const QString &varName)
 {
     if (mExecuting) {
-        sendCommand("-var-list-children",varName);
+        sendCommand("-var-delete",varName);
+    }
+}
+
+void Debugger::fetchStackFrames(int from)
+{
+    if (mExecuting) {
+        sendCommand("-stack-list-frames",QString("%1 %2")
+                    .arg(from)
+                    .arg(from+STACK_FRAMES_PAGE_SIZE-1));
     }
 }
 
@@ -536,7 +712,11 @@ void Debugger::sendBreakpointCommand(PBreakpoint breakpoint)
         // break "filename":linenum
         QString condition;
         if (!breakpoint->condition.isEmpty()) {
-            condition = " -c " + breakpoint->condition;
+            //conditions may contain spaces, so they are passed as a c-string
+            QString s = breakpoint->condition;
+            s.replace('\\',"\\\\");
+            s.replace('"',"\\\"");
+            condition = " -c \"" + s + "\"";
         }
         QString filename = breakpoint->filename;
         filename.replace('\\','/');
@@ -564,10 +744,25 @@ void Debugger::sendClearBreakpointCommand(PBreakpoint breakpoint)
     }
 }
 
+void Debugger::sendClearBreakpointsCommand(const QList<int> &numbers)
+{
+    //-break-delete accepts a list of breakpoint numbers
+    if (numbers.isEmpty() || !mExecuting)
+        return;
+    QStringList params;
+    foreach (int number, numbers) {
+        params.append(QString::number(number));
+    }
+    sendCommand("-break-delete", params.join(' '));
+}
+
 void Debugger::syncFinishedParsing()
 {
     bool spawnedcpuform = false;
 
+    if (mReader->updateCPUInfo())
+        mCurrentAddress = mReader->currentAddress();
+
     // GDB determined that the source code is more recent than the executable. Ask the user if he wants to rebuild.
     if (mReader->receivedSFWarning()) {
         if (QMessageBox::question(pMainWindow,
@@ -644,10 +839,19 @@ void Debugger::setWatchVarValue(const QString &name, const QString &value)
     refreshAll();
 }
 
-void Debugger::updateMemory(const QStringList &value)
+void Debugger::onMemoryAddressLocated(qulonglong address)
 {
-    mMemoryModel->updateMemory(value);
-    emit memoryExamineReady(value);
+    mMemoryModel->setStartAddress(address, pSettings->debugger().memoryViewColumns());
+}
+
+void Debugger::fetchMemoryPage(qulonglong address, int size)
+{
+    if (mExecuting && !inferiorRunning()) {
+        sendCommand("-data-read-memory-bytes",QString("%1 %2").arg(address).arg(size));
+    } else {
+        //fetched again when the inferior stops
+        mMemoryModel->cancelFetches();
+    }
 }
 
 void Debugger::updateEval(const QString &value)
@@ -655,13 +859,94 @@ void Debugger::updateEval(const QString &value)
     emit evalValueReady(value);
 }
 
-void Debugger::updateDisassembly(const QString& file, const QString& func, const QStringList &value)
-{
+void Debugger::updateDisassembly(const QString& file, const QString& func, const QStringList &value,
+                                 bool intelStyle, bool blendMode)
+{
+    PDisassembly disassembly = std::make_shared<Disassembly>();
+    disassembly->file = file;
+    disassembly->funcName = func;
+    //the flavor of the reply, the one asked for may have changed since
+    disassembly->intelStyle = intelStyle;
+    disassembly->blendMode = blendMode;
+    foreach (const QString& line, value) {
+        //lines are cached without the current instruction marker
+        QString s = line;
+        if (s.startsWith("=>"))
+            s.replace(0,2,"  ");
+        qulonglong address = 0;
+        QString trimmed = s.trimmed();
+        if (trimmed.startsWith("0x")) {
+            int pos = 2;
+            while (pos<trimmed.length() && isxdigit(trimmed[pos].toLatin1()))
+                pos++;
+            bool isOk;
+            address = trimmed.mid(2,pos-2).toULongLong(&isOk,16);
+            if (!isOk)
+                address = 0;
+        }
+        disassembly->lines.append(s);
+        disassembly->addresses.append(address);
+    }
+    for (int i=mDisassemblyCache.count()-1;i>=0;i--) {
+        PDisassembly old = mDisassemblyCache[i];
+        if (old->file == file && old->funcName == func
+                && old->intelStyle == disassembly->intelStyle
+                && old->blendMode == disassembly->blendMode)
+            mDisassemblyCache.removeAt(i);
+    }
+    mDisassemblyCache.append(disassembly);
+    while (mDisassemblyCache.count()>DISASSEMBLY_CACHE_SIZE)
+        mDisassemblyCache.removeFirst();
     if (pMainWindow->cpuDialog()) {
         pMainWindow->cpuDialog()->setDisassembly(file,func,value);
     }
 }
 
+void Debugger::requestDisassembly(bool intelStyle, bool blendMode)
+{
+    if (!mExecuting)
+        return;
+    PDisassembly disassembly = findDisassembly(mCurrentAddress, intelStyle, blendMode);
+    if (disassembly) {
+        //still in a function we have seen, only move the marker
+        int i = disassembly->addresses.indexOf(mCurrentAddress);
+        CPUDialog* cpuDialog = pMainWindow->cpuDialog();
+        if (!cpuDialog)
+            return;
+        if (cpuDialog->isShowing(disassembly->file,disassembly->funcName)) {
+            cpuDialog->setCurrentLine(i);
+        } else {
+            QStringList lines = disassembly->lines;
+            lines[i].replace(0,2,"=>");
+            cpuDialog->setDisassembly(disassembly->file,disassembly->funcName,lines);
+        }
+        return;
+    }
+    // Set disassembly flavor
+    if (intelStyle) {
+        sendCommand("-gdb-set", "disassembly-flavor intel");
+    } else {
+        sendCommand("-gdb-set", "disassembly-flavor att");
+    }
+    if (blendMode)
+        sendCommand("disas", "/s");
+    else
+        sendCommand("disas", "");
+}
+
+PDisassembly Debugger::findDisassembly(qulonglong address, bool intelStyle, bool blendMode) const
+{
+    if (address==0)
+        return PDisassembly();
+    foreach (const PDisassembly& disassembly, mDisassemblyCache) {
+        if (disassembly->intelStyle == intelStyle
+                && disassembly->blendMode == blendMode
+                && disassembly->addresses.contains(address))
+            return disassembly;
+    }
+    return PDisassembly();
+}
+
 void Debugger::onChangeDebugConsoleLastline(const QString& text)
 {
     //pMainWindow->changeDebugOutputLastline(text);
@@ -689,21 +974,28 @@ DebugReader::DebugReader(Debugger* debugger, QObject *parent) : QThread(parent),
 {
     mDebugger = debugger;
     mProcess = std::make_shared<QProcess>();
-    mCmdRunning = false;
+    mNextToken = 1;
     mAsyncUpdated = false;
+    mCurrentAddress = 0;
+    mTraceInterruptPending = false;
+    mDisassemblyIntelStyle = false;
 }
 
 void DebugReader::postCommand(const QString &Command, const QString &Params,
                                DebugCommandSource Source)
 {
-    QMutexLocker locker(&mCmdQueueMutex);
     PDebugCommand pCmd = std::make_shared<DebugCommand>();
     pCmd->command = Command;
     pCmd->params = Params;
     pCmd->source = Source;
+    postCommand(pCmd);
+}
+
+void DebugReader::postCommand(const PDebugCommand &pCmd)
+{
+    QMutexLocker locker(&mCmdQueueMutex);
     mCmdQueue.enqueue(pCmd);
-//    if (!mCmdRunning)
-    //        runNextCmd();
+    emit cmdPosted();
 }
 
 void DebugReader::registerInferiorStoppedCommand(const QString &Command, const QString &Params)
@@ -826,7 +1118,10 @@ void DebugReader::processResult(const QByteArray &result)
         handleBreakpoint(multiValues["bkpt"].object());
         return;
     case GDBMIResultType::FrameStack:
-        handleStack(multiValues["stack"].array());
+        if (mCurrentCmd->source == DebugCommandSource::TraceSample)
+            handleTraceStack(multiValues["stack"].array());
+        else
+            handleStack(multiValues["stack"].array());
         return;
     case GDBMIResultType::LocalVariables:
         handleLocalVariables(multiValues["variables"].array());
@@ -835,7 +1130,7 @@ void DebugReader::processResult(const QByteArray &result)
         handleEvaluation(multiValues["value"].value());
         return;
     case GDBMIResultType::Memory:
-        handleMemory(multiValues["memory"].array());
+        handleMemoryBytes(multiValues["memory"].array());
         return;
     case GDBMIResultType::RegisterNames:
         handleRegisterNames(multiValues["register-names"].array());
@@ -893,11 +1188,29 @@ void DebugReader::processExecAsyncRecord(const QByteArray &line)
             mSignalReceived = true;
             return;
         }
+        bool traceSample = mTraceInterruptPending;
+        mTraceInterruptPending = false;
+        if (reason == "signal-received") {
+            //only the signal used by -exec-interrupt comes from the trace sampler,
+            //the program may have got a real signal (SIGSEGV...) at the same time
+#ifdef Q_OS_WIN
+            traceSample = traceSample && multiValues["signal-name"].value() == "SIGTRAP";
+#else
+            traceSample = traceSample && multiValues["signal-name"].value() == "SIGINT";
+#endif
+        } else if (!reason.isEmpty()) {
+            traceSample = false;
+        }
+        if (traceSample) {
+            //stopped only to see where the program is, don't bother the ui
+            emit traceSampleStopped();
+            return;
+        }
         mUpdateCPUInfo = true;
         GDBMIResultParser::ParseValue frame(multiValues["frame"]);
         if (frame.isValid()) {
             GDBMIResultParser::ParseObject frameObj = frame.object();
-            mCurrentAddress = frameObj["addr"].hexValue();
+            mCurrentAddress = frameObj["addr"].value().toULongLong(nullptr,16);
             mCurrentLine = frameObj["line"].intValue();
             if (mDebugger->forceUTF8())
                 mCurrentFile = frameObj["fullname"].utf8PathValue();
@@ -921,6 +1234,18 @@ void DebugReader::processExecAsyncRecord(const QByteArray &line)
 void DebugReader::processError(const QByteArray &errorLine)
 {
     mConsoleOutput.append(QString::fromLocal8Bit(errorLine));
+    if (mCurrentCmd && mCurrentCmd->command == "-data-read-memory-bytes") {
+        //no byte of the range is readable
+        handleMemoryBytes(QList<GDBMIResultParser::ParseValue>());
+    } else if (mCurrentCmd && mCurrentCmd->source == DebugCommandSource::TraceSample) {
+        if (mCurrentCmd->command == "-exec-interrupt")
+            mTraceInterruptPending = false;
+        else if (mCurrentCmd->command == "-stack-list-frames")
+            handleTraceStack(QList<GDBMIResultParser::ParseValue>());
+    } else if (mCurrentCmd && mCurrentCmd->command == "-stack-list-frames") {
+        //end the page fetch, or the backtrace view never fetches again
+        handleStack(QList<GDBMIResultParser::ParseValue>());
+    }
 }
 
 void DebugReader::processResultRecord(const QByteArray &line)
@@ -947,8 +1272,14 @@ void DebugReader::processResultRecord(const QByteArray &line)
                     disOutput.pop_front();
                     disOutput.pop_front();
                 }
-                emit disassemblyUpdate(mCurrentFile,mCurrentFunc, disOutput);
+                emit disassemblyUpdate(mCurrentFile,mCurrentFunc, disOutput,
+                                       mDisassemblyIntelStyle,
+                                       mCurrentCmd->params.contains("/s"));
             }
+        } else if (mCurrentCmd && mCurrentCmd->command == "-gdb-set"
+                   && mCurrentCmd->params.startsWith("disassembly-flavor ")) {
+            //gdb runs commands in order, so it is the flavor of the next disas
+            mDisassemblyIntelStyle = mCurrentCmd->params.endsWith("intel");
         }
         return ;
     }
@@ -958,50 +1289,68 @@ void DebugReader::processResultRecord(const QByteArray &line)
     }
 }
 
-void DebugReader::processDebugOutput(const QByteArray& debugOutput)
+void DebugReader::processDebugOutputLine(const QByteArray& line)
 {
     // Only update once per update at most
     //WatchView.Items.BeginUpdate;
 
-    emit parseStarted();
-
-    mConsoleOutput.clear();
-    mFullOutput.clear();
-
-    mSignalReceived = false;
-    mUpdateCPUInfo = false;
-    mReceivedSFWarning = false;
-    QList<QByteArray> lines = splitByteArrayToLines(debugOutput);
-
-    for (int i=0;i<lines.count();i++) {
-         QByteArray line = lines[i];
-         if (pSettings->debugger().showDetailLog())
-            mFullOutput.append(line);
-         line = removeToken(line);
-         if (line.isEmpty()) {
-             continue;
-         }
-         switch (line[0]) {
-         case '~': // console stream output
-             processConsoleOutput(line);
-             break;
-         case '@': // target stream output
-         case '&': // log stream output
-             break;
-         case '^': // result record
-             processResultRecord(line);
-             break;
-         case '*': // exec async output
-             processExecAsyncRecord(line);
-             break;
-         case '+': // status async output
-         case '=': // notify async output
-             break;
-         }
-    }
-    emit parseFinished();
-    mConsoleOutput.clear();
-    mFullOutput.clear();
+    if (!mOutputBlockStarted) {
+        //gdb runs commands one by one, so output belongs to the oldest command
+        //still in flight, until its result record says otherwise
+        {
+            QMutexLocker locker(&mCmdQueueMutex);
+            mCurrentCmd = mInFlightCmds.isEmpty()?PDebugCommand():mInFlightCmds.front();
+        }
+        mOutputBlockStarted = true;
+
+        emit parseStarted();
+
+        mConsoleOutput.clear();
+        mFullOutput.clear();
+
+        mSignalReceived = false;
+        mUpdateCPUInfo = false;
+        mReceivedSFWarning = false;
+    }
+
+    if (line.trimmed() == "(gdb)") {
+        emit parseFinished();
+        mConsoleOutput.clear();
+        mFullOutput.clear();
+        mOutputBlockStarted = false;
+        runNextCmd();
+        return;
+    }
+
+    if (pSettings->debugger().showDetailLog())
+        mFullOutput.append(line);
+    int token;
+    QByteArray record = removeToken(line, &token);
+    if (record.isEmpty()) {
+        return;
+    }
+    switch (record[0]) {
+    case '~': // console stream output
+        processConsoleOutput(record);
+        break;
+    case '@': // target stream output
+    case '&': // log stream output
+        break;
+    case '^': // result record
+        if (token>0) {
+            PDebugCommand cmd = takeInFlightCmd(token);
+            if (cmd)
+                mCurrentCmd = cmd;
+        }
+        processResultRecord(record);
+        break;
+    case '*': // exec async output
+        processExecAsyncRecord(record);
+        break;
+    case '+': // status async output
+    case '=': // notify async output
+        break;
+    }
 }
 
 void DebugReader::runInferiorStoppedHook()
@@ -1018,55 +1367,116 @@ void DebugReader::runNextCmd()
     if (mCurrentCmd) {
         DebugCommandSource commandSource = mCurrentCmd->source;
         mCurrentCmd=nullptr;
-        if (commandSource!=DebugCommandSource::HeartBeat)
+        if (commandSource!=DebugCommandSource::HeartBeat
+                && commandSource!=DebugCommandSource::TraceSample
+                && mInFlightCmds.isEmpty())
             emit cmdFinished();
     }
     if (mCmdQueue.isEmpty()) {
-        if (pSettings->debugger().useGDBServer() && mInferiorRunning && !mAsyncUpdated) {
+        if (pSettings->debugger().useGDBServer() && mInferiorRunning && !mAsyncUpdated
+                && mInFlightCmds.isEmpty()) {
             mAsyncUpdated = true;
             QTimer::singleShot(50,this,&DebugReader::asyncUpdate);
         }
         return;
     }
 
-    PDebugCommand pCmd = mCmdQueue.dequeue();
-    mCmdRunning = true;
-    mCurrentCmd = pCmd;
-    if (pCmd->source!=DebugCommandSource::HeartBeat)
-        emit cmdStarted();
-
-    QByteArray s;
-    QByteArray params;
-    s=pCmd->command.toLocal8Bit();
-    if (!pCmd->params.isEmpty()) {
-        params = pCmd->params.toLocal8Bit();
+    //gdb runs commands one by one, so they can be sent without waiting for
+    //the results of the previous ones
+    while (!mCmdQueue.isEmpty() && canSendCmd(mCmdQueue.head())) {
+        PDebugCommand pCmd = mCmdQueue.dequeue();
+        pCmd->token = mNextToken++;
+        mInFlightCmds.append(pCmd);
+        if (pCmd->source!=DebugCommandSource::HeartBeat
+                && pCmd->source!=DebugCommandSource::TraceSample)
+            emit cmdStarted();
+        if (pCmd->source==DebugCommandSource::TraceSample
+                && pCmd->command == "-exec-interrupt")
+            mTraceInterruptPending = true;
+
+        QByteArray s;
+        QByteArray params;
+        s=pCmd->command.toLocal8Bit();
+        if (!pCmd->params.isEmpty()) {
+            params = pCmd->params.toLocal8Bit();
+        }
+
+        //clang compatibility
+        if (pCmd->command == "-break-insert" && mDebugger->forceUTF8()) {
+            params = pCmd->params.toUtf8();
+        }
+        if (pCmd->command == "-var-create") {
+            //hack for variable creation,to easy remember var expression
+            params = " - @ "+params;
+        } else if (pCmd->command == "-var-list-children") {
+            //hack for list variable children,to easy remember var expression
+            params = " --all-values \"" + pCmd->params.toLocal8Bit()+"\"";
+            if (pCmd->from>=0)
+                params += " " + QByteArray::number(pCmd->from) + " " + QByteArray::number(pCmd->to);
+        }
+        s+=" "+params;
+        s+= "\n";
+        if (mProcess->write(QByteArray::number(pCmd->token)+s)<0) {
+            emit writeToDebugFailed();
+        }
+
+    //  if devDebugger.ShowCommandLog or pCmd^.ShowInConsole then begin
+        if (pSettings->debugger().enableDebugConsole() ) {
+            //update debug console
+            if (pSettings->debugger().showDetailLog()
+                    && pCmd->source != DebugCommandSource::Console) {
+                emit changeDebugConsoleLastLine(pCmd->command + ' ' + params);
+            }
+        }
     }
+}
 
-    //clang compatibility
-    if (pCmd->command == "-break-insert" && mDebugger->forceUTF8()) {
-        params = pCmd->params.toUtf8();
-    }
-    if (pCmd->command == "-var-create") {
-        //hack for variable creation,to easy remember var expression
-        params = " - @ "+params;
-    } else if (pCmd->command == "-var-list-children") {
-        //hack for list variable children,to easy remember var expression
-        params = " --all-values \"" + params+'\"';
-    }
-    s+=" "+params;
-    s+= "\n";
-    if (mProcess->write(s)<0) {
-        emit writeToDebugFailed();
+bool DebugReader::canSendCmd(const PDebugCommand &cmd) const
+{
+    if (mInFlightCmds.isEmpty())
+        return true;
+    if (mInFlightCmds.count()>=MAX_GDB_BREAKPOINT_INSERTS_IN_FLIGHT)
+        return false;
+    if (mInFlightCmds.count()>=MAX_GDB_COMMANDS_IN_FLIGHT) {
+        //a burst of breakpoint inserts (at debug start) isn't held back by
+        //the normal limit
+        if (cmd->command != "-break-insert")
+            return false;
+        foreach (const PDebugCommand& inFlightCmd, mInFlightCmds) {
+            if (inFlightCmd->command != "-break-insert")
+                return false;
+        }
+    }
+    //commands that may resume the inferior or change the target are
+    //not pipelined with other commands
+    auto isBarrier = [](const PDebugCommand& c) {
+        return c->source == DebugCommandSource::Console
+                || !c->command.startsWith('-')
+                || c->command.startsWith("-exec")
+                || c->command.startsWith("-target")
+                || c->command == "-gdb-exit";
+    };
+    if (isBarrier(cmd))
+        return false;
+    foreach (const PDebugCommand& inFlightCmd, mInFlightCmds) {
+        if (isBarrier(inFlightCmd))
+            return false;
     }
+    return true;
+}
 
-//  if devDebugger.ShowCommandLog or pCmd^.ShowInConsole then begin
-    if (pSettings->debugger().enableDebugConsole() ) {
-        //update debug console
-        if (pSettings->debugger().showDetailLog()
-                && pCmd->source != DebugCommandSource::Console) {
-            emit changeDebugConsoleLastLine(pCmd->command + ' ' + params);
+PDebugCommand DebugReader::takeInFlightCmd(int token)
+{
+    QMutexLocker locker(&mCmdQueueMutex);
+    for (int i=0;i<mInFlightCmds.count();i++) {
+        if (mInFlightCmds[i]->token == token) {
+            PDebugCommand cmd = mInFlightCmds[i];
+            //gdb answers in order, so commands sent before it are lost
+            mInFlightCmds.erase(mInFlightCmds.begin(), mInFlightCmds.begin()+i+1);
+            return cmd;
         }
     }
+    return PDebugCommand();
 }
 
 QStringList DebugReader::tokenize(const QString &s)
@@ -1165,16 +1575,6 @@ QStringList DebugReader::tokenize(const QString &s)
     return result;
 }
 
-bool DebugReader::outputTerminated(const QByteArray &text)
-{
-    QStringList lines = textToLines(QString::fromUtf8(text));
-    foreach (const QString& line,lines) {
-        if (line.trimmed() == "(gdb)")
-            return true;
-    }
-    return false;
-}
-
 void DebugReader::handleBreakpoint(const GDBMIResultParser::ParseObject& breakpoint)
 {
     QString filename;
@@ -1190,7 +1590,7 @@ void DebugReader::handleBreakpoint(const GDBMIResultParser::ParseObject& breakpo
 
 void DebugReader::handleStack(const QList<GDBMIResultParser::ParseValue> & stack)
 {
-    mDebugger->backtraceModel()->clear();
+    QList<PTrace> traces;
     foreach (const GDBMIResultParser::ParseValue& frameValue, stack) {
         GDBMIResultParser::ParseObject frameObject = frameValue.object();
         PTrace trace = std::make_shared<Trace>();
@@ -1202,8 +1602,29 @@ void DebugReader::handleStack(const QList<GDBMIResultParser::ParseValue> & stack
         trace->line = frameObject["line"].intValue();
         trace->level = frameObject["level"].intValue(0);
         trace->address = frameObject["addr"].value();
-        mDebugger->backtraceModel()->addTrace(trace);
+        traces.append(trace);
+    }
+    mDebugger->backtraceModel()->updateTraces(traces, traces.count()>=STACK_FRAMES_PAGE_SIZE);
+}
+
+void DebugReader::handleTraceStack(const QList<GDBMIResultParser::ParseValue> &stack)
+{
+    foreach (const GDBMIResultParser::ParseValue& frameValue, stack) {
+        GDBMIResultParser::ParseObject frameObject = frameValue.object();
+        int line = frameObject["line"].intValue(-1);
+        if (line<=0)
+            continue;
+        QString filename;
+        if (mDebugger->forceUTF8())
+            filename = frameObject["fullname"].utf8PathValue();
+        else
+            filename = frameObject["fullname"].pathValue();
+        if (filename.isEmpty())
+            continue;
+        emit traceSampled(filename, line);
+        return;
     }
+    emit traceSampled(QString(), -1);
 }
 
 void DebugReader::handleLocalVariables(const QList<GDBMIResultParser::ParseValue> &variables)
@@ -1226,20 +1647,39 @@ void DebugReader::handleEvaluation(const QString &value)
     emit evalUpdated(value);
 }
 
-void DebugReader::handleMemory(const QList<GDBMIResultParser::ParseValue> &rows)
+void DebugReader::handleMemoryBytes(const QList<GDBMIResultParser::ParseValue> &blocks)
 {
-    QStringList memory;
-    foreach (const GDBMIResultParser::ParseValue& row, rows) {
-        GDBMIResultParser::ParseObject rowObject = row.object();
-        QList<GDBMIResultParser::ParseValue> data = rowObject["data"].array();
-        QStringList values;
-        foreach (const GDBMIResultParser::ParseValue& val, data) {
-            values.append(val.value());
+    if (!mCurrentCmd)
+        return;
+    //params are "address size", the address is quoted if it's an expression
+    QString address = mCurrentCmd->params.section(' ',0,-2);
+    if (address.startsWith('"')) {
+        if (!blocks.isEmpty()) {
+            bool isOk;
+            qulonglong begin = blocks[0].object()["begin"].value().toULongLong(&isOk,0);
+            if (isOk)
+                emit memoryAddressLocated(begin);
         }
-        memory.append(QString("%1 %2")
-                            .arg(rowObject["addr"].value(),values.join(" ")));
+        return;
     }
-    emit memoryUpdated(memory);
+    qulonglong start = address.toULongLong();
+    int size = mCurrentCmd->params.section(' ',-1).toInt();
+    QByteArray datas(size,0);
+    QBitArray readable(size,false);
+    //unreadable parts of the range are not in the result
+    foreach (const GDBMIResultParser::ParseValue& block, blocks) {
+        GDBMIResultParser::ParseObject blockObject = block.object();
+        bool isOk;
+        qulonglong begin = blockObject["begin"].value().toULongLong(&isOk,0);
+        if (!isOk || begin<start || begin-start>=(qulonglong)size)
+            continue;
+        int pos = begin - start;
+        QByteArray contents = QByteArray::fromHex(blockObject["contents"].value());
+        int len = std::min(contents.length(), size - pos);
+        memcpy(datas.data()+pos, contents.constData(), len);
+        readable.fill(true, pos, pos+len);
+    }
+    emit memoryPageUpdated(start, datas, readable);
 }
 
 void DebugReader::handleRegisterNames(const QList<GDBMIResultParser::ParseValue> &names)
@@ -1287,10 +1727,10 @@ void DebugReader::handleListVarChildren(const GDBMIResultParser::ParseObject &mu
     if (!mCurrentCmd)
         return;
     QString parentName = mCurrentCmd->params;
-    int parentNumChild = multiVars["numchild"].intValue(0);
+    int from = std::max(mCurrentCmd->from, 0);
     QList<GDBMIResultParser::ParseValue> children = multiVars["children"].array();
     bool hasMore = multiVars["has_more"].value()!="0";
-    emit prepareVarChildren(parentName,parentNumChild,hasMore);
+    emit prepareVarChildren(parentName,from);
     foreach(const GDBMIResultParser::ParseValue& child, children) {
         GDBMIResultParser::ParseObject childObj = child.object();
         QString name = childObj["name"].value();
@@ -1307,6 +1747,7 @@ void DebugReader::handleListVarChildren(const GDBMIResultParser::ParseObject &mu
                          type,
                          hasMore);
     }
+    emit varChildrenFetched(parentName,hasMore);
 }
 
 void DebugReader::handleUpdateVarValue(const QList<GDBMIResultParser::ParseValue> &changes)
@@ -1327,7 +1768,7 @@ void DebugReader::handleUpdateVarValue(const QList<GDBMIResultParser::ParseValue
     //emit varsValueUpdated();
 }
 
-QByteArray DebugReader::removeToken(const QByteArray &line)
+QByteArray DebugReader::removeToken(const QByteArray &line, int* token)
 {
     int p=0;
     while (p<line.length()) {
@@ -1337,6 +1778,8 @@ QByteArray DebugReader::removeToken(const QByteArray &line)
         }
         p++;
     }
+    if (token)
+        *token = (p>0 && p<line.length())? line.left(p).toInt() : 0;
     if (p<line.length())
         return line.mid(p);
     return line;
@@ -1400,6 +1843,11 @@ const PDebugCommand &DebugReader::currentCmd() const
     return mCurrentCmd;
 }
 
+qulonglong DebugReader::currentAddress() const
+{
+    return mCurrentAddress;
+}
+
 const QStringList &DebugReader::consoleOutput() const
 {
     return mConsoleOutput;
@@ -1428,11 +1876,13 @@ void DebugReader::setDebuggerPath(const QString &debuggerPath)
 void DebugReader::stopDebug()
 {
     mStop = true;
+    emit stopRequested();
 }
 
 bool DebugReader::commandRunning()
 {
-    return !mCmdQueue.isEmpty();
+    QMutexLocker locker(&mCmdQueueMutex);
+    return !mCmdQueue.isEmpty() || !mInFlightCmds.isEmpty();
 }
 
 void DebugReader::waitStart()
@@ -1446,6 +1896,7 @@ void DebugReader::run()
     mInferiorRunning = false;
     mProcessExited = false;
     mErrorOccured = false;
+    mInFlightCmds.clear();
     QString cmd = mDebuggerPath;
 //    QString arguments = "--annotate=2";
     QString arguments = "--interpret=mi --silent";
@@ -1476,41 +1927,47 @@ void DebugReader::run()
 
     mProcess->setWorkingDirectory(workingDir);
 
+    QEventLoop loop;
     connect(mProcess.get(), &QProcess::errorOccurred,
                     [&](){
-                        mErrorOccured= true;
+                        //killing gdb on stop is not an error
+                        if (!mStop)
+                            mErrorOccured= true;
+                        loop.quit();
                     });
-    QByteArray buffer;
-    QByteArray readed;
-
+    connect(mProcess.get(), QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            &loop, &QEventLoop::quit);
+    //split the output into lines as it arrives; each byte is scanned only once
+    GDBMILineBuffer lineBuffer;
+    connect(mProcess.get(), &QProcess::readyRead,
+            [&](){
+        lineBuffer.append(mProcess->readAll());
+        QByteArray line;
+        while (lineBuffer.takeLine(line))
+            processDebugOutputLine(line);
+    });
+    //commands and stop requests come from other threads
+    connect(this, &DebugReader::cmdPosted, mProcess.get(),
+            [this](){
+        runNextCmd();
+    }, Qt::QueuedConnection);
+    connect(this, &DebugReader::stopRequested, mProcess.get(),
+            [this](){
+        mProcess->terminate();
+        mProcess->kill();
+    }, Qt::QueuedConnection);
+
+    mOutputBlockStarted = false;
     mProcess->start();
     mProcess->waitForStarted(5000);
     mStartSemaphore.release(1);
-    while (true) {
-        mProcess->waitForFinished(1);
-        if (mProcess->state()!=QProcess::Running) {
-            break;
-        }
+    if (mProcess->state()==QProcess::Running && !mErrorOccured) {
         if (mStop) {
             mProcess->terminate();
             mProcess->kill();
-            break;
-        }
-        if (mErrorOccured)
-            break;
-        readed = mProcess->readAll();
-        buffer += readed;
-
-        if (readed.endsWith("\n")&& outputTerminated(buffer)) {
-            processDebugOutput(buffer);
-            buffer.clear();
-            mCmdRunning = false;
-            runNextCmd();
-        } else if (!mCmdRunning && readed.isEmpty()){
-            runNextCmd();
-        } else if (readed.isEmpty()){
-            msleep(1);
         }
+        runNextCmd();
+        loop.exec();
     }
     if (mErrorOccured) {
         emit processError(mProcess->error());
@@ -1612,6 +2069,25 @@ void BreakpointModel::removeBreakpoint(int row)
     endRemoveRows();
 }
 
+void BreakpointModel::removeBreakpoints(const QList<int> &rows)
+{
+    //remove runs of consecutive rows from the end, so the rows not yet
+    //removed keep their indexes
+    int i=rows.count()-1;
+    while (i>=0) {
+        int last = rows[i];
+        int first = last;
+        while (i>0 && rows[i-1]==first-1) {
+            i--;
+            first--;
+        }
+        beginRemoveRows(QModelIndex(),first,last);
+        mList.erase(mList.begin()+first,mList.begin()+last+1);
+        endRemoveRows();
+        i--;
+    }
+}
+
 void BreakpointModel::invalidateAllBreakpointNumbers()
 {
     foreach (PBreakpoint bp,mList) {
@@ -1713,34 +2189,60 @@ void BreakpointModel::updateBreakpointNumber(const QString& filename, int line,
 
 void BreakpointModel::onFileDeleteLines(const QString& filename, int startLine, int count)
 {
-    for (int i = mList.count()-1;i>=0;i--){
+    //one pass over the list; moved rows are repainted by a single dataChanged,
+    //and deleted rows are removed together
+    int firstChanged = -1;
+    int lastChanged = -1;
+    QList<int> removedRows;
+    QList<int> removedNumbers;
+    for (int i = 0;i<mList.count();i++){
         PBreakpoint breakpoint = mList[i];
-        if  (breakpoint->filename == filename
-             && breakpoint->line>=startLine) {
-            if (breakpoint->line >= startLine+count) {
-                breakpoint->line -= count;
-                emit dataChanged(createIndex(i,0),createIndex(i,2));
-            } else {
-                removeBreakpoint(i);
-            }
+        if  (breakpoint->filename != filename
+             || breakpoint->line<startLine)
+            continue;
+        if (breakpoint->line >= startLine+count) {
+            breakpoint->line -= count;
+            if (firstChanged<0)
+                firstChanged = i;
+            lastChanged = i;
+        } else {
+            removedRows.append(i);
+            if (breakpoint->number>=0)
+                removedNumbers.append(breakpoint->number);
         }
     }
+    if (firstChanged>=0)
+        emit dataChanged(createIndex(firstChanged,0),createIndex(lastChanged,2));
+    if (!removedRows.isEmpty())
+        removeBreakpoints(removedRows);
+    //the running program is not changed by the edit, so moved breakpoints
+    //still match gdb's line numbers; only the deleted ones must be cleared
+    if (!removedNumbers.isEmpty())
+        emit breakpointsRemoved(removedNumbers);
 }
 
 void BreakpointModel::onFileInsertLines(const QString& filename, int startLine, int count)
 {
-    for (int i = mList.count()-1;i>=0;i--){
+    int firstChanged = -1;
+    int lastChanged = -1;
+    for (int i = 0;i<mList.count();i++){
         PBreakpoint breakpoint = mList[i];
         if  (breakpoint->filename == filename
              && breakpoint->line>=startLine) {
             breakpoint->line+=count;
-            emit dataChanged(createIndex(i,0),createIndex(i,2));
+            if (firstChanged<0)
+                firstChanged = i;
+            lastChanged = i;
         }
     }
+    if (firstChanged>=0)
+        emit dataChanged(createIndex(firstChanged,0),createIndex(lastChanged,2));
 }
 
 
-BacktraceModel::BacktraceModel(QObject *parent):QAbstractTableModel(parent)
+BacktraceModel::BacktraceModel(QObject *parent):QAbstractTableModel(parent),
+    mHasMore(false),
+    mFetching(false)
 {
 
 }
@@ -1810,9 +2312,66 @@ void BacktraceModel::clear()
 {
     beginResetModel();
     mList.clear();
+    mHasMore = false;
+    mFetching = false;
     endResetModel();
 }
 
+void BacktraceModel::updateTraces(const QList<PTrace> &traces, bool hasMore)
+{
+    mFetching = false;
+    int from = traces.isEmpty()?mList.count():traces.front()->level;
+    if (from<0 || from>mList.count())
+        from = mList.count();
+    int end = from+traces.count();
+    //a new first page replaces the whole stack
+    if (from==0 && mList.count()>end) {
+        beginRemoveRows(QModelIndex(),end,mList.count()-1);
+        mList.erase(mList.begin()+end,mList.end());
+        endRemoveRows();
+    }
+    int firstChanged = -1;
+    int lastChanged = -1;
+    for (int i=from;i<std::min(end,mList.count());i++) {
+        PTrace oldTrace = mList[i];
+        PTrace newTrace = traces[i-from];
+        if (oldTrace->funcname != newTrace->funcname
+                || oldTrace->filename != newTrace->filename
+                || oldTrace->line != newTrace->line
+                || oldTrace->address != newTrace->address) {
+            if (firstChanged<0)
+                firstChanged = i;
+            lastChanged = i;
+        }
+        mList[i]=newTrace;
+    }
+    if (firstChanged>=0)
+        emit dataChanged(createIndex(firstChanged,0),createIndex(lastChanged,columnCount(QModelIndex())-1));
+    if (end>mList.count()) {
+        int start = mList.count();
+        beginInsertRows(QModelIndex(),start,end-1);
+        for (int i=start;i<end;i++)
+            mList.append(traces[i-from]);
+        endInsertRows();
+    }
+    mHasMore = hasMore;
+}
+
+bool BacktraceModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return false;
+    return mHasMore && !mFetching;
+}
+
+void BacktraceModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+    mFetching = true;
+    emit fetchTraces(mList.count());
+}
+
 void BacktraceModel::removeTrace(int row)
 {
     beginRemoveRows(QModelIndex(),row,row);
@@ -1844,6 +2403,22 @@ QVariant WatchModel::data(const QModelIndex &index, int role) const
         return QVariant();
     }
     WatchVar* item = static_cast<WatchVar*>(index.internalPointer());
+    if (item->parent && item == item->parent->moreChildren.get()) {
+        WatchVar* parentItem = item->parent;
+        if (role != Qt::DisplayRole)
+            return QVariant();
+        switch(index.column()) {
+        case 0:
+            return parentItem->fetchingChildren?tr("Loading..."):tr("More...");
+        case 2:
+            if (parentItem->numChild > parentItem->children.count())
+                return tr("%1 of %2 children shown")
+                        .arg(parentItem->children.count())
+                        .arg(parentItem->numChild);
+            return tr("%1 children shown").arg(parentItem->children.count());
+        }
+        return QVariant();
+    }
     switch (role) {
     case Qt::DisplayRole:
         switch(index.column()) {
@@ -1852,6 +2427,8 @@ QVariant WatchModel::data(const QModelIndex &index, int role) const
         case 1:
             return item->type;
         case 2:
+            if (isEvictedChildItem(index))
+                return item->parent->fetchingChildren?tr("Loading..."):tr("Not loaded");
             return item->value;
         }
     }
@@ -1869,7 +2446,10 @@ QModelIndex WatchModel::index(int row, int column, const QModelIndex &parent) co
         pChild = mWatchVars[row];
     } else {
         parentItem = static_cast<WatchVar*>(parent.internalPointer());
-        pChild = parentItem->children[row];
+        if (row<parentItem->children.count())
+            pChild = parentItem->children[row];
+        else
+            pChild = parentItem->moreChildren;
     }
     if (pChild) {
         return createIndex(row,column,pChild.get());
@@ -1915,6 +2495,8 @@ int WatchModel::rowCount(const QModelIndex &parent) const
         return mWatchVars.count();
     } else {
         WatchVar* parentItem = static_cast<WatchVar*>(parent.internalPointer());
+        if (parentItem->moreChildren)
+            return parentItem->children.count()+1;
         return parentItem->children.count();
     }
 }
@@ -2003,6 +2585,9 @@ void WatchModel::resetAllVarInfos()
         var->hasMore = false;
         var->type.clear();
         var->children.clear();
+        var->moreChildren.reset();
+        var->evictedPages.clear();
+        var->fetchingChildren = false;
     }
     mVarIndex.clear();
     endResetModel();
@@ -2025,18 +2610,30 @@ void WatchModel::updateVarInfo(const QString &expression, const QString &name, i
     emit dataChanged(idx,createIndex(idx.row(),2,var.get()));
 }
 
-void WatchModel::prepareVarChildren(const QString &parentName, int numChild, bool hasMore)
+void WatchModel::prepareVarChildren(const QString &parentName, int from)
 {
     PWatchVar var = mVarIndex.value(parentName,PWatchVar());
-    if (var) {
-        var->numChild = numChild;
-        var->hasMore = hasMore;
-        if (var->children.count()>0) {
-            beginRemoveRows(index(var),0,var->children.count()-1);
-            var->children.clear();
-            endRemoveRows();
-        }
+    if (!var)
+        return;
+    var->fillFrom = from;
+    var->fillRow = from;
+    //an evicted page is loaded again into its rows
+    if (var->evictedPages.contains(from / WATCH_CHILDREN_PAGE_SIZE))
+        return;
+    QModelIndex idx = index(var);
+    if (var->moreChildren) {
+        beginRemoveRows(idx,var->children.count(),var->children.count());
+        var->moreChildren.reset();
+        endRemoveRows();
+    }
+    //the first page is fetched again when the var is changed
+    if (from==0 && var->children.count()>0) {
+        beginRemoveRows(idx,0,var->children.count()-1);
+        removeVarIndex(var);
+        var->children.clear();
+        endRemoveRows();
     }
+    var->evictedPages.clear();
 }
 
 void WatchModel::addVarChild(const QString &parentName, const QString &name,
@@ -2046,6 +2643,20 @@ void WatchModel::addVarChild(const QString &parentName, const QString &name,
     PWatchVar var = mVarIndex.value(parentName,PWatchVar());
     if (!var)
         return;
+    int row = var->fillRow++;
+    if (row < var->children.count()) {
+        //the row of an evicted child
+        PWatchVar child = var->children[row];
+        child->name = name;
+        child->expression = exp;
+        child->numChild = numChild;
+        child->value = value;
+        child->type = type;
+        child->hasMore = hasMore;
+        mVarIndex.insert(name,child);
+        emit dataChanged(createIndex(row,0,child.get()),createIndex(row,2,child.get()));
+        return;
+    }
     beginInsertRows(index(var),var->children.count(),var->children.count());
     PWatchVar child = std::make_shared<WatchVar>();
     child->name = name;
@@ -2055,11 +2666,84 @@ void WatchModel::addVarChild(const QString &parentName, const QString &name,
     child->type = type;
     child->hasMore = hasMore;
     child->parent = var.get();
+    child->fetchingChildren = false;
     var->children.append(child);
     endInsertRows();
     mVarIndex.insert(name,child);
 }
 
+void WatchModel::finishVarChildren(const QString &parentName, bool hasMore)
+{
+    PWatchVar var = mVarIndex.value(parentName,PWatchVar());
+    if (!var)
+        return;
+    var->fetchingChildren = false;
+    if (var->evictedPages.remove(var->fillFrom / WATCH_CHILDREN_PAGE_SIZE))
+        return;
+    var->hasMore = hasMore;
+    if (var->numChild < var->children.count())
+        var->numChild = var->children.count();
+    if (hasMore || var->numChild > var->children.count()) {
+        beginInsertRows(index(var),var->children.count(),var->children.count());
+        var->moreChildren = std::make_shared<WatchVar>();
+        var->moreChildren->parent = var.get();
+        var->moreChildren->numChild = 0;
+        var->moreChildren->hasMore = false;
+        var->moreChildren->fetchingChildren = false;
+        endInsertRows();
+    }
+}
+
+void WatchModel::loadMoreChildren(const QModelIndex &index)
+{
+    if (!isMoreChildrenItem(index))
+        return;
+    WatchVar* item = static_cast<WatchVar*>(index.internalPointer());
+    WatchVar* parentItem = item->parent;
+    if (parentItem->fetchingChildren)
+        return;
+    int from = parentItem->children.count();
+    makeRoomForChildPage(parentItem, from / WATCH_CHILDREN_PAGE_SIZE);
+    fetchChildrenFrom(parentItem, from);
+    emit dataChanged(index, createIndex(index.row(),2,item));
+}
+
+void WatchModel::loadEvictedChildren(const QModelIndex &index)
+{
+    if (!isEvictedChildItem(index))
+        return;
+    WatchVar* item = static_cast<WatchVar*>(index.internalPointer());
+    WatchVar* parentItem = item->parent;
+    if (parentItem->fetchingChildren)
+        return;
+    int page = index.row() / WATCH_CHILDREN_PAGE_SIZE;
+    makeRoomForChildPage(parentItem, page);
+    fetchChildrenFrom(parentItem, page * WATCH_CHILDREN_PAGE_SIZE);
+    int last = std::min(parentItem->children.count(), (page+1) * WATCH_CHILDREN_PAGE_SIZE)-1;
+    emit dataChanged(createIndex(page * WATCH_CHILDREN_PAGE_SIZE,2,parentItem->children[page * WATCH_CHILDREN_PAGE_SIZE].get()),
+                     createIndex(last,2,parentItem->children[last].get()));
+}
+
+void WatchModel::releaseVarChildren(const QModelIndex &index)
+{
+    if (!index.isValid())
+        return;
+    WatchVar* item = static_cast<WatchVar*>(index.internalPointer());
+    //small vars are kept, they are cheap to hold and to show again
+    if (item->fetchingChildren || item->children.count()<=WATCH_CHILDREN_PAGE_SIZE)
+        return;
+    PWatchVar var = mVarIndex.value(item->name,PWatchVar());
+    if (!var)
+        return;
+    beginRemoveRows(index,0,rowCount(index)-1);
+    removeVarIndex(var);
+    var->children.clear();
+    var->moreChildren.reset();
+    var->evictedPages.clear();
+    endRemoveRows();
+    emit releaseChildren(var->name);
+}
+
 void WatchModel::updateVarValue(const QString &name, const QString &val, const QString &inScope, bool typeChanged, const QString &newType, int newNumChildren, bool hasMore)
 {
     PWatchVar var = mVarIndex.value(name,PWatchVar());
@@ -2076,12 +2760,15 @@ void WatchModel::updateVarValue(const QString &name, const QString &val, const Q
     QModelIndex idx = index(var);
     bool oldHasMore = var->hasMore;
     var->hasMore = hasMore;
+    //all children are fetched again, evicted pages included
     if (newNumChildren>=0
             && var->numChild!=newNumChildren) {
         var->numChild = newNumChildren;
-        fetchMore(idx);
+        var->evictedPages.clear();
+        fetchChildrenFrom(var.get(),0);
     } else  if (!oldHasMore && hasMore) {
-        fetchMore(idx);
+        var->evictedPages.clear();
+        fetchChildrenFrom(var.get(),0);
     }
     emit dataChanged(idx,createIndex(idx.row(),2,var.get()));
 }
@@ -2090,8 +2777,8 @@ void WatchModel::updateAllHasMoreVars()
 {
     foreach (const PWatchVar& var, mVarIndex.values()) {
         if (var->hasMore) {
-            QModelIndex idx = index(var);
-            fetchMore(idx);
+            var->evictedPages.clear();
+            fetchChildrenFrom(var.get(),0);
         }
     }
 }
@@ -2106,6 +2793,8 @@ void WatchModel::clearAllVarInfos()
         var->hasMore = false;
         var->type.clear();
         var->children.clear();
+        var->moreChildren.reset();
+        var->fetchingChildren = false;
     }
     mVarIndex.clear();
     endResetModel();
@@ -2191,6 +2880,7 @@ void WatchModel::load(const QString &filename)
             var->value = tr("Execute to evaluate");
             var->numChild = 0;
             var->hasMore=false;
+            var->fetchingChildren=false;
             var->parent = nullptr;
 
             addWatchVar(var);
@@ -2211,6 +2901,8 @@ QModelIndex WatchModel::index(PWatchVar var) const
 QModelIndex WatchModel::index(WatchVar* pVar) const {
     if (pVar==nullptr)
         return QModelIndex();
+    if (pVar->parent && pVar == pVar->parent->moreChildren.get())
+        return createIndex(pVar->parent->children.count(),0,pVar);
     if (pVar->parent) {
         int row=-1;
         for (int i=0;i<pVar->parent->children.count();i++) {
@@ -2285,9 +2977,7 @@ void WatchModel::fetchMore(const QModelIndex &parent)
         return;
     }
     WatchVar* item = static_cast<WatchVar*>(parent.internalPointer());
-    item->hasMore = false;
-    item->numChild = item->children.count();
-    emit fetchChildren(item->name);
+    fetchChildrenFrom(item,0);
 }
 
 bool WatchModel::canFetchMore(const QModelIndex &parent) const
@@ -2296,7 +2986,109 @@ bool WatchModel::canFetchMore(const QModelIndex &parent) const
         return false;
     }
     WatchVar* item = static_cast<WatchVar*>(parent.internalPointer());
-    return item->numChild>item->children.count() || item->hasMore;
+    //only the first page is fetched on expanding, the others by loadMoreChildren()
+    return !item->fetchingChildren && item->children.isEmpty()
+            && (item->numChild>0 || item->hasMore);
+}
+
+void WatchModel::fetchChildrenFrom(WatchVar *var, int from)
+{
+    if (var->name.isEmpty())
+        return;
+    var->fetchingChildren = true;
+    emit fetchChildren(var->name, from);
+}
+
+void WatchModel::removeVarIndex(const PWatchVar &var)
+{
+    foreach (const PWatchVar& child, var->children) {
+        mVarIndex.remove(child->name);
+        removeVarIndex(child);
+    }
+}
+
+int WatchModel::residentChildPages(const WatchVar *var)
+{
+    int pages = (var->children.count() + WATCH_CHILDREN_PAGE_SIZE - 1) / WATCH_CHILDREN_PAGE_SIZE;
+    return pages - var->evictedPages.count();
+}
+
+void WatchModel::makeRoomForChildPage(WatchVar *var, int page)
+{
+    //the page to load is shown, so the pages farthest from it are the
+    //farthest from the viewport
+    while (residentChildPages(var) >= WATCH_MAX_CHILDREN_PAGES) {
+        int pages = (var->children.count() + WATCH_CHILDREN_PAGE_SIZE - 1) / WATCH_CHILDREN_PAGE_SIZE;
+        int farthest = -1;
+        for (int i=0;i<pages;i++) {
+            if (i == page || var->evictedPages.contains(i))
+                continue;
+            if (farthest<0 || qAbs(i-page) > qAbs(farthest-page))
+                farthest = i;
+        }
+        if (farthest<0)
+            return;
+        evictChildPage(var, farthest);
+    }
+}
+
+void WatchModel::evictChildPage(WatchVar *var, int page)
+{
+    int first = page * WATCH_CHILDREN_PAGE_SIZE;
+    int last = std::min(var->children.count(), first + WATCH_CHILDREN_PAGE_SIZE) - 1;
+    for (int row=first;row<=last;row++) {
+        PWatchVar child = var->children[row];
+        if (!child->children.isEmpty() || child->moreChildren) {
+            QModelIndex childIndex = createIndex(row,0,child.get());
+            beginRemoveRows(childIndex,0,rowCount(childIndex)-1);
+            removeVarIndex(child);
+            child->children.clear();
+            child->moreChildren.reset();
+            child->evictedPages.clear();
+            endRemoveRows();
+        }
+        //deleting the var in gdb deletes its children too
+        if (!child->name.isEmpty()) {
+            mVarIndex.remove(child->name);
+            emit releaseVar(child->name);
+        }
+        //the expression is kept to show which row it is
+        child->name.clear();
+        child->value.clear();
+        child->type.clear();
+        child->numChild = 0;
+        child->hasMore = false;
+        child->fetchingChildren = false;
+    }
+    var->evictedPages.insert(page);
+    emit dataChanged(createIndex(first,0,var->children[first].get()),
+                     createIndex(last,2,var->children[last].get()));
+}
+
+bool WatchModel::isMoreChildrenItem(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return false;
+    WatchVar* item = static_cast<WatchVar*>(index.internalPointer());
+    return item->parent && item == item->parent->moreChildren.get();
+}
+
+bool WatchModel::isEvictedChildItem(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return false;
+    WatchVar* item = static_cast<WatchVar*>(index.internalPointer());
+    if (!item->parent || item == item->parent->moreChildren.get())
+        return false;
+    return item->parent->evictedPages.contains(index.row() / WATCH_CHILDREN_PAGE_SIZE);
+}
+
+bool WatchModel::canAutoLoadMoreChildren(const QModelIndex &index) const
+{
+    if (!isMoreChildrenItem(index))
+        return false;
+    WatchVar* item = static_cast<WatchVar*>(index.internalPointer());
+    return residentChildPages(item->parent) < WATCH_MAX_CHILDREN_PAGES;
 }
 
 bool WatchModel::hasChildren(const QModelIndex &parent) const
@@ -2366,9 +3158,13 @@ void RegisterModel::updateNames(const QStringList &regNames)
 
 void RegisterModel::updateValues(const QHash<int, QString> registerValues)
 {
+    //only repaint registers whose values are changed
+    QHash<int,QString> oldValues = mRegisterValues;
     mRegisterValues= registerValues;
-    emit dataChanged(createIndex(0,1),
-                     createIndex(mRegisterNames.count()-1,1));
+    for (int i=0;i<mRegisterNames.count();i++) {
+        if (oldValues.value(i)!=mRegisterValues.value(i))
+            emit dataChanged(createIndex(i,1),createIndex(i,1));
+    }
 }
 
 
@@ -2524,73 +3320,107 @@ MemoryModel::MemoryModel(int dataPerLine, QObject *parent):
 {
 }
 
-void MemoryModel::updateMemory(const QStringList &value)
+void MemoryModel::setStartAddress(qulonglong address, int dataPerLine)
 {
-    int maxDataPerLine=-1;
-    QRegExp delimiter("(\\s+)");
-    QList<PMemoryLine> newModel;
-    for (int i=0;i<value.length();i++) {
-        QString line = value[i].trimmed();
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-        QStringList dataLst = line.split(delimiter,Qt::SkipEmptyParts);
-#else
-        QStringList dataLst = line.split(delimiter,QString::SkipEmptyParts);
-#endif
-        PMemoryLine memoryLine = std::make_shared<MemoryLine>();
-        memoryLine->startAddress = -1;
-        if (dataLst.length()>0) {
-            bool isOk;
-            memoryLine->startAddress = stringToHex(dataLst[0],isOk);
-            if (isOk)  {
-                if (dataLst.length()-1>maxDataPerLine)
-                     maxDataPerLine = dataLst.length()-1;
-                for (int j=1;j<dataLst.length();j++) {
-                    qulonglong data = stringToHex(dataLst[j],isOk);
-                    if (isOk)
-                        memoryLine->datas.append((unsigned char)data);
-                    else
-                        memoryLine->datas.append(0);
-                }
-            } else {
-                memoryLine->startAddress=0;
-            }
+    beginResetModel();
+    mStartAddress = address;
+    mDataPerLine = std::max(dataPerLine,1);
+    mPages.clear();
+    mFetchingPages.clear();
+    endResetModel();
+}
 
-        }
-        newModel.append(memoryLine);
+void MemoryModel::invalidate()
+{
+    //old datas are kept to find out the changed bytes
+    foreach (const PMemoryPage& page, mPages) {
+        page->outdated = true;
     }
-    if (newModel.count()>0 && newModel.count()== mLines.count() &&
-            newModel[0]->startAddress == mLines[0]->startAddress &&
-            maxDataPerLine==mDataPerLine) {
-        for (int i=0;i<newModel.count();i++) {
-            PMemoryLine newLine = newModel[i];
-            PMemoryLine oldLine = mLines[i];
-            for (int j=0;j<newLine->datas.count();j++) {
-                if (j>=oldLine->datas.count())
-                    break;
-                if (newLine->datas[j]!=oldLine->datas[j])
-                    newLine->changedDatas.insert(j);
+    mFetchingPages.clear();
+    emit invalidated();
+}
+
+void MemoryModel::fetchRows(int firstRow, int lastRow)
+{
+    int rows = rowCount(QModelIndex());
+    if (rows<=0)
+        return;
+    firstRow = std::max(firstRow,0);
+    lastRow = std::min(lastRow,rows-1);
+    if (firstRow>lastRow)
+        return;
+    qulonglong firstAddress = mStartAddress+(qulonglong)mDataPerLine*firstRow;
+    qulonglong lastAddress = mStartAddress+(qulonglong)mDataPerLine*(lastRow+1)-1;
+    for (qulonglong pageAddress = firstAddress & ~(qulonglong)(MEMORY_PAGE_SIZE-1);
+         pageAddress<=lastAddress; pageAddress+=MEMORY_PAGE_SIZE) {
+        PMemoryPage page = mPages.value(pageAddress,PMemoryPage());
+        if (!page || page->outdated)
+            requestPage(pageAddress);
+    }
+}
+
+void MemoryModel::updatePage(qulonglong address, const QByteArray &datas, const QBitArray &readable)
+{
+    //the view is moved to another address since the page is requested
+    if (!mFetchingPages.remove(address))
+        return;
+    PMemoryPage page = std::make_shared<MemoryPage>();
+    page->datas = datas;
+    page->readable = readable;
+    page->changedDatas.resize(datas.size());
+    page->outdated = false;
+    PMemoryPage oldPage = mPages.value(address,PMemoryPage());
+    if (oldPage && oldPage->datas.size() == datas.size()) {
+        for (int i=0;i<datas.size();i++) {
+            if (readable.testBit(i) && oldPage->readable.testBit(i)
+                    && datas[i]!=oldPage->datas[i])
+                page->changedDatas.setBit(i);
+        }
+    }
+    mPages.insert(address,page);
+    while (mPages.count()>MEMORY_PAGE_CACHE_SIZE) {
+        qulonglong farthest = address;
+        qulonglong maxDistance = 0;
+        for (auto it=mPages.constBegin();it!=mPages.constEnd();++it) {
+            qulonglong distance = it.key()>address?it.key()-address:address-it.key();
+            if (distance>maxDistance) {
+                maxDistance = distance;
+                farthest = it.key();
             }
         }
-        mLines = newModel;
-        emit dataChanged(createIndex(0,0),
-                         createIndex(mLines.count()-1,mDataPerLine-1));
-    } else {
-        beginResetModel();
-        if (maxDataPerLine>0)
-            mDataPerLine=maxDataPerLine;
-        mLines = newModel;
-        endResetModel();
+        mPages.remove(farthest);
     }
-    if (mLines.count()>0) {
-        mStartAddress = mLines[0]->startAddress;
-    } else {
-        mStartAddress = 0;
-    }
- }
+    int rows = rowCount(QModelIndex());
+    if (rows<=0 || address+datas.size()<=mStartAddress)
+        return;
+    qulonglong firstRow = address>mStartAddress?(address-mStartAddress)/mDataPerLine:0;
+    qulonglong lastRow = (address+datas.size()-1-mStartAddress)/mDataPerLine;
+    if (firstRow>=(qulonglong)rows)
+        return;
+    if (lastRow>=(qulonglong)rows)
+        lastRow = rows-1;
+    emit dataChanged(createIndex(firstRow,0),
+                     createIndex(lastRow,mDataPerLine-1));
+}
+
+void MemoryModel::cancelFetches()
+{
+    mFetchingPages.clear();
+}
+
+void MemoryModel::requestPage(qulonglong pageAddress)
+{
+    if (mFetchingPages.contains(pageAddress))
+        return;
+    mFetchingPages.insert(pageAddress);
+    emit fetchPage(pageAddress, MEMORY_PAGE_SIZE);
+}
 
 int MemoryModel::rowCount(const QModelIndex &/*parent*/) const
 {
-    return mLines.count();
+    if (mStartAddress==0)
+        return 0;
+    return MEMORY_VIEW_SIZE / mDataPerLine;
 }
 
 int MemoryModel::columnCount(const QModelIndex &/*parent*/) const
@@ -2600,26 +3430,36 @@ int MemoryModel::columnCount(const QModelIndex &/*parent*/) const
 
 QVariant MemoryModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid())
+    if (!index.isValid() || mStartAddress==0)
         return QVariant();
-    if (index.row()<0 || index.row()>=mLines.count())
+    if (index.row()<0 || index.row()>=rowCount(QModelIndex()))
         return QVariant();
-    PMemoryLine line = mLines[index.row()];
     int col = index.column();
-    if (col<0  || col>=line->datas.count())
+    if (col<0  || col>=mDataPerLine)
+        return QVariant();
+    qulonglong address = mStartAddress+(qulonglong)mDataPerLine*index.row()+col;
+    qulonglong pageAddress = address & ~(qulonglong)(MEMORY_PAGE_SIZE-1);
+    PMemoryPage page = mPages.value(pageAddress,PMemoryPage());
+    if (!page)
         return QVariant();
-    if (role == Qt::DisplayRole)
-        return QString("%1").arg(line->datas[col],2,16,QChar('0'));
+    int offset = address - pageAddress;
+    if (role == Qt::DisplayRole) {
+        if (!page->readable.testBit(offset))
+            return "??";
+        return QString("%1").arg((unsigned char)page->datas[offset],2,16,QChar('0'));
+    } else if (role == Qt::ForegroundRole) {
+        if (page->changedDatas.testBit(offset))
+            return QColor(Qt::red);
+    }
     return QVariant();
 }
 
 QVariant MemoryModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if (orientation == Qt::Vertical && role ==  Qt::DisplayRole) {
-        if (section<0 || section>=mLines.count())
+        if (section<0 || section>=rowCount(QModelIndex()))
             return QVariant();
-        PMemoryLine line = mLines[section];
-        return QString("0x%1").arg(line->startAddress,0,16,QChar('0'));
+        return QString("0x%1").arg(mStartAddress+(qulonglong)mDataPerLine*section,0,16,QChar('0'));
     }
     return QVariant();
 }
@@ -2628,11 +3468,10 @@ bool MemoryModel::setData(const QModelIndex &index, const QVariant &value, int r
 {
     if (!index.isValid())
         return false;
-    if (index.row()<0 || index.row()>=mLines.count())
+    if (index.row()<0 || index.row()>=rowCount(QModelIndex()))
         return false;
-    PMemoryLine line = mLines[index.row()];
     int col = index.column();
-    if (col<0  || col>=line->datas.count())
+    if (col<0  || col>=mDataPerLine)
         return false;
     if (role == Qt::EditRole && mStartAddress>0) {
         bool ok;
@@ -2660,6 +3499,78 @@ qulonglong MemoryModel::startAddress() const
 
 void MemoryModel::reset()
 {
+    beginResetModel();
     mStartAddress=0;
-    mLines.clear();
+    mPages.clear();
+    mFetchingPages.clear();
+    endResetModel();
+}
+
+TraceRecorder::TraceRecorder(QObject *parent):
+    QObject(parent),
+    mNextSample(0),
+    mMaxHitCount(0)
+{
+}
+
+void TraceRecorder::addSample(const QString &filename, int line)
+{
+    //drop the oldest sample when the buffer is full
+    if (mSamples.count()>=TRACE_BUFFER_SIZE) {
+        const TraceSample& oldSample = mSamples[mNextSample];
+        QHash<int,int>& oldCounts = mHitCounts[oldSample.filename];
+        int count = oldCounts.value(oldSample.line) - 1;
+        if (count == mMaxHitCount - 1)
+            mMaxHitCount = -1;
+        if (count>0)
+            oldCounts.insert(oldSample.line, count);
+        else
+            oldCounts.remove(oldSample.line);
+        if (oldCounts.isEmpty())
+            mHitCounts.remove(oldSample.filename);
+        mSamples[mNextSample] = TraceSample{filename,line};
+    } else {
+        mSamples.append(TraceSample{filename,line});
+    }
+    mNextSample = (mNextSample + 1) % TRACE_BUFFER_SIZE;
+    int count = mHitCounts[filename].value(line) + 1;
+    mHitCounts[filename].insert(line, count);
+    if (mMaxHitCount>=0 && count>mMaxHitCount)
+        mMaxHitCount = count;
+    emit samplesChanged();
+}
+
+void TraceRecorder::clear()
+{
+    mSamples.clear();
+    mNextSample = 0;
+    mHitCounts.clear();
+    mMaxHitCount = 0;
+    emit samplesChanged();
+}
+
+int TraceRecorder::hitCount(const QString &filename, int line) const
+{
+    auto it = mHitCounts.constFind(filename);
+    if (it == mHitCounts.constEnd())
+        return 0;
+    return it->value(line,0);
+}
+
+int TraceRecorder::maxHitCount() const
+{
+    if (mMaxHitCount<0) {
+        mMaxHitCount = 0;
+        foreach (const auto& counts, mHitCounts) {
+            foreach (int count, counts) {
+                mMaxHitCount = std::max(mMaxHitCount, count);
+            }
+        }
+    }
+    return mMaxHitCount;
+}
+
+int TraceRecorder::sampleCount() const
+{
+    return mSamples.count();
 }
@@ -18,6 +18,8 @@
 #define DEBUGGER_H
 
 #include <QAbstractTableModel>
+#include <QBitArray>
+#include <QHash>
 #include <QList>
 #include <QList>
 #include <QMap>
@@ -30,12 +32,14 @@
 #include <QSet>
 #include <QThread>
 #include <QTimer>
+#include <QVector>
 #include <memory>
 #include "gdbmiresultparser.h"
 
 enum class DebugCommandSource {
     Console,
     HeartBeat,
+    TraceSample,
     Other
 };
 
@@ -43,8 +47,29 @@ struct DebugCommand{
     QString command;
     QString params;
     DebugCommandSource source;
+    int token; // MI token used to match the command's result record
+    //child range of -var-list-children, whose params is the var name
+    int from = -1;
+    int to = -1;
 };
 
+//max number of commands sent to gdb without receiving their results
+#define MAX_GDB_COMMANDS_IN_FLIGHT 8
+//breakpoint inserts don't depend on each other and are sent in bigger bursts
+#define MAX_GDB_BREAKPOINT_INSERTS_IN_FLIGHT 64
+//stack frames are fetched page by page when the call stack view is scrolled
+#define STACK_FRAMES_PAGE_SIZE 50
+//children of watch vars are fetched page by page when they are scrolled into view
+#define WATCH_CHILDREN_PAGE_SIZE 100
+//max number of child pages of a watch var kept loaded; pages beyond it are only
+//loaded on request, and the pages farthest from it are dropped
+#define WATCH_MAX_CHILDREN_PAGES 10
+//inferior memory is read in aligned pages, and the memory view can browse
+//MEMORY_VIEW_SIZE bytes from the start address
+#define MEMORY_PAGE_SIZE 4096
+#define MEMORY_PAGE_CACHE_SIZE 256
+#define MEMORY_VIEW_SIZE (4*1024*1024)
+
 using PDebugCommand = std::shared_ptr<DebugCommand>;
 struct WatchVar;
 using  PWatchVar = std::shared_ptr<WatchVar>;
@@ -57,6 +82,12 @@ struct WatchVar {
     int numChild;
     QList<PWatchVar> children;
     WatchVar * parent; //use raw point to prevent circular-reference
+    bool fetchingChildren;
+    PWatchVar moreChildren; //placeholder row for the children not fetched yet
+    //pages of children dropped from memory (and from gdb), their rows are kept
+    QSet<int> evictedPages;
+    int fillFrom = 0; //first child of the page being fetched
+    int fillRow = 0; //row the next fetched child goes to
 };
 
 enum class BreakpointType {
@@ -117,6 +148,8 @@ public:
     void addBreakpoint(PBreakpoint p);
     void clear();
     void removeBreakpoint(int index);
+    //rows must be in ascending order
+    void removeBreakpoints(const QList<int>& rows);
     PBreakpoint setBreakPointCondition(int index, const QString& condition);
     const QList<PBreakpoint>& breakpoints() const;
     PBreakpoint breakpoint(int index) const;
@@ -127,6 +160,9 @@ public slots:
     void invalidateAllBreakpointNumbers(); // call this when gdb is stopped
     void onFileDeleteLines(const QString& filename, int startLine, int count);
     void onFileInsertLines(const QString& filename, int startLine, int count);
+signals:
+    //breakpoints already set in gdb are removed by edits
+    void breakpointsRemoved(const QList<int>& numbers);
 private:
     QList<PBreakpoint> mList;
 };
@@ -143,10 +179,18 @@ public:
     void addTrace(PTrace p);
     void clear();
     void removeTrace(int index);
+    //update the frames starting from traces[0]->level, only changed rows are repainted
+    void updateTraces(const QList<PTrace>& traces, bool hasMore);
     const QList<PTrace>& backtraces() const;
     PTrace backtrace(int index) const;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+signals:
+    void fetchTraces(int from);
 private:
     QList<PTrace> mList;
+    bool mHasMore;
+    bool mFetching;
 };
 
 class WatchModel: public QAbstractItemModel {
@@ -178,6 +222,11 @@ public:
     void notifyUpdated(PWatchVar var);
     void save(const QString& filename);
     void load(const QString& filename);
+    bool isMoreChildrenItem(const QModelIndex& index) const;
+    //a child row of an evicted page
+    bool isEvictedChildItem(const QModelIndex& index) const;
+    //more children are only loaded automatically up to WATCH_MAX_CHILDREN_PAGES pages
+    bool canAutoLoadMoreChildren(const QModelIndex& index) const;
 signals:
     void setWatchVarValue(const QString& name, const QString& value);
 public  slots:
@@ -187,21 +236,32 @@ public  slots:
                     const QString& value,
                     const QString& type,
                     bool hasMore);
-    void prepareVarChildren(const QString& parentName, int numChild, bool hasMore);
+    void prepareVarChildren(const QString& parentName, int from);
     void addVarChild(const QString& parentName, const QString& name,
                      const QString& exp, int numChild,
                      const QString& value, const QString& type,
                      bool hasMore);
+    void finishVarChildren(const QString& parentName, bool hasMore);
+    void loadMoreChildren(const QModelIndex& index);
+    void loadEvictedChildren(const QModelIndex& index);
+    void releaseVarChildren(const QModelIndex& index);
     void updateVarValue(const QString& name, const QString& val,
                          const QString& inScope, bool typeChanged,
                          const QString& newType, int newNumChildren,
                          bool hasMore);
     void updateAllHasMoreVars();
 signals:
-    void fetchChildren(const QString& name);
+    void fetchChildren(const QString& name, int from);
+    void releaseChildren(const QString& name);
+    void releaseVar(const QString& name);
 private:
     QModelIndex index(PWatchVar var) const;
     QModelIndex index(WatchVar* pVar) const;
+    void fetchChildrenFrom(WatchVar* var, int from);
+    void removeVarIndex(const PWatchVar& var);
+    static int residentChildPages(const WatchVar* var);
+    void makeRoomForChildPage(WatchVar* var, int page);
+    void evictChildPage(WatchVar* var, int page);
 private:
     QList<PWatchVar> mWatchVars;
     QHash<QString,PWatchVar> mVarIndex;
@@ -213,25 +273,36 @@ public:
     Qt::ItemFlags flags(const QModelIndex &index) const override;
 };
 
-struct MemoryLine {
-    uintptr_t startAddress;
-    QList<unsigned char> datas;
-    QSet<int> changedDatas;
+struct MemoryPage {
+    QByteArray datas;
+    QBitArray readable;
+    QBitArray changedDatas; // changed since the last time the program stopped
+    bool outdated;
 };
 
-using PMemoryLine = std::shared_ptr<MemoryLine>;
+using PMemoryPage = std::shared_ptr<MemoryPage>;
 
 class MemoryModel: public QAbstractTableModel{
     Q_OBJECT
 public:
     explicit MemoryModel(int dataPerLine,QObject* parent=nullptr);
 
-    void updateMemory(const QStringList& value);
+    void setStartAddress(qulonglong address, int dataPerLine);
     qulonglong startAddress() const;
+    void invalidate();
     void reset();
+    //fetch the pages of the rows not fetched yet or outdated
+    void fetchRows(int firstRow, int lastRow);
     // QAbstractItemModel interface
 signals:
     void setMemoryData(qlonglong address, unsigned char data);
+    void fetchPage(qulonglong address, int size);
+    //the shown rows must be fetched again
+    void invalidated();
+public slots:
+    void updatePage(qulonglong address, const QByteArray& datas, const QBitArray& readable);
+    //forget the requested pages, their commands may never be answered
+    void cancelFetches();
 public:
     int rowCount(const QModelIndex &parent) const override;
     int columnCount(const QModelIndex &parent) const override;
@@ -240,10 +311,15 @@ public:
     bool setData(const QModelIndex &index, const QVariant &value, int role) override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
 
+private:
+    void requestPage(qulonglong pageAddress);
 private:
     int mDataPerLine;
-    QList<PMemoryLine> mLines;
     qulonglong mStartAddress;
+    //pages are fetched when they are scrolled into view, and the ones farthest
+    //from the last fetched page are dropped when the cache is full
+    QHash<qulonglong,PMemoryPage> mPages;
+    QSet<qulonglong> mFetchingPages;
 };
 
 
@@ -253,6 +329,50 @@ class Editor;
 
 using PDebugReader = std::shared_ptr<DebugReader>;
 
+//disassembly of the function around an address, cached for the debug session
+//so that stepping inside the function only moves the current instruction marker
+struct Disassembly {
+    QString file;
+    QString funcName;
+    bool intelStyle;
+    bool blendMode;
+    QStringList lines;
+    QList<qulonglong> addresses; // instruction address of each line, 0 for other lines
+};
+
+using PDisassembly = std::shared_ptr<Disassembly>;
+
+#define DISASSEMBLY_CACHE_SIZE 32
+
+//number of samples kept by the trace recorder
+#define TRACE_BUFFER_SIZE 100000
+
+/**
+ * @brief Hit counts of source lines, from the latest TRACE_BUFFER_SIZE
+ * samples of where the program is running.
+ */
+class TraceRecorder : public QObject {
+    Q_OBJECT
+public:
+    explicit TraceRecorder(QObject* parent = nullptr);
+    void addSample(const QString& filename, int line);
+    void clear();
+    int hitCount(const QString& filename, int line) const;
+    int maxHitCount() const;
+    int sampleCount() const;
+signals:
+    void samplesChanged();
+private:
+    struct TraceSample {
+        QString filename;
+        int line;
+    };
+    QVector<TraceSample> mSamples; // ring buffer
+    int mNextSample;
+    QHash<QString,QHash<int,int>> mHitCounts;
+    mutable int mMaxHitCount; // -1 if it should be recalculated
+};
+
 class Debugger : public QObject
 {
     Q_OBJECT
@@ -267,6 +387,12 @@ public:
     bool inferiorRunning();
     void interrupt();
 
+    //sample where the program is running, to find out the hot lines
+    void startTraceRecording();
+    void stopTraceRecording();
+    bool traceRecording() const;
+    TraceRecorder *traceRecorder() const;
+
     //breakpoints
     void addBreakpoint(int line, const Editor* editor);
     void addBreakpoint(int line, const QString& filename);
@@ -310,34 +436,52 @@ public:
 
 signals:
     void evalValueReady(const QString& s);
-    void memoryExamineReady(const QStringList& s);
     void localsReady(const QStringList& s);
 public slots:
     void stop();
     void refreshAll();
+    //refresh views that became visible after the inferior stopped
+    void refreshVisibleViews();
+    void examineMemory(const QString& address);
+    void requestDisassembly(bool intelStyle, bool blendMode);
 
 private:
+    PDisassembly findDisassembly(qulonglong address, bool intelStyle, bool blendMode) const;
     void sendWatchCommand(PWatchVar var);
     void sendRemoveWatchCommand(PWatchVar var);
     void sendBreakpointCommand(PBreakpoint breakpoint);
     void sendClearBreakpointCommand(int index);
     void sendClearBreakpointCommand(PBreakpoint breakpoint);
+    void deleteBreakpointRows(const QList<int>& rows);
 
 private slots:
+    void sendClearBreakpointsCommand(const QList<int>& numbers);
     void syncFinishedParsing();
     void setMemoryData(qulonglong address, unsigned char data);
     void setWatchVarValue(const QString& name, const QString& value);
-    void updateMemory(const QStringList& value);
+    void onMemoryAddressLocated(qulonglong address);
+    void fetchMemoryPage(qulonglong address, int size);
     void updateEval(const QString& value);
-    void updateDisassembly(const QString& file, const QString& func,const QStringList& value);
+    void updateDisassembly(const QString& file, const QString& func,const QStringList& value,
+                           bool intelStyle, bool blendMode);
     void onChangeDebugConsoleLastline(const QString& text);
     void cleanUpReader();
     void updateRegisterNames(const QStringList& registerNames);
     void updateRegisterValues(const QHash<int,QString>& values);
     void refreshWatchVars();
-    void fetchVarChildren(const QString& varName);
+    void fetchVarChildren(const QString& varName, int from);
+    void releaseVarChildren(const QString& varName);
+    void releaseVar(const QString& varName);
+    void fetchStackFrames(int from);
+    void sampleTrace();
+    void onTraceSampleStopped();
+    void onTraceSampled(const QString& filename, int line);
+    void resetTraceSampling();
 private:
     bool mExecuting;
+    bool mLocalsOutdated;
+    bool mMemoryOutdated;
+    bool mStackFramesOutdated;
     bool mCommandChanged;
     BreakpointModel *mBreakpointModel;
     BacktraceModel *mBacktraceModel;
@@ -346,8 +490,13 @@ private:
     MemoryModel *mMemoryModel;
     DebugReader *mReader;
     DebugTarget *mTarget;
+    TraceRecorder *mTraceRecorder;
+    QTimer mTraceTimer;
+    bool mTraceSampling;
     bool mForceUTF8;
     int mLeftPageIndexBackup;
+    qulonglong mCurrentAddress;
+    QList<PDisassembly> mDisassemblyCache;
 };
 
 class DebugTarget: public QThread {
@@ -387,6 +536,7 @@ class DebugReader : public QThread
 public:
     explicit DebugReader(Debugger* debugger, QObject *parent = nullptr);
     void postCommand(const QString &Command, const QString &Params, DebugCommandSource  Source);
+    void postCommand(const PDebugCommand& pCmd);
     void registerInferiorStoppedCommand(const QString &Command, const QString &Params);
     QString debuggerPath() const;
     void setDebuggerPath(const QString &debuggerPath);
@@ -408,6 +558,7 @@ public:
     const QString &breakPointFile() const;
 
     const PDebugCommand &currentCmd() const;
+    qulonglong currentAddress() const;
 
     bool updateCPUInfo() const;
 
@@ -452,8 +603,10 @@ signals:
     void inferiorStopped(const QString& filename, int line, bool setFocus);
     void localsUpdated(const QStringList& localsValue);
     void evalUpdated(const QString& value);
-    void memoryUpdated(const QStringList& memoryValues);
-    void disassemblyUpdate(const QString& filename, const QString& funcName, const QStringList& result);
+    void memoryPageUpdated(qulonglong address, const QByteArray& datas, const QBitArray& readable);
+    void memoryAddressLocated(qulonglong address);
+    void disassemblyUpdate(const QString& filename, const QString& funcName, const QStringList& result,
+                           bool intelStyle, bool blendMode);
     void registerNamesUpdated(const QStringList& registerNames);
     void registerValuesUpdated(const QHash<int,QString>& values);
     void varCreated(const QString& expression,
@@ -462,29 +615,38 @@ signals:
                     const QString& value,
                     const QString& type,
                     bool hasMore);
-    void prepareVarChildren(const QString& parentName,int numChild, bool hasMore);
+    void prepareVarChildren(const QString& parentName,int from);
     void addVarChild(const QString& parentName, const QString& name,
                      const QString& exp, int numChild,
                      const QString& value, const QString& type,
                      bool hasMore);
+    void varChildrenFetched(const QString& parentName, bool hasMore);
     void varValueUpdated(const QString& name, const QString& val,
                          const QString& inScope, bool typeChanged,
                          const QString& newType, int newNumChildren,
                          bool hasMore);
     void varsValueUpdated();
+    //the inferior is interrupted to take a trace sample
+    void traceSampleStopped();
+    void traceSampled(const QString& filename, int line);
+    //wake up the reader thread
+    void cmdPosted();
+    void stopRequested();
 
 private:
     void clearCmdQueue();
 
     void runNextCmd();
+    bool canSendCmd(const PDebugCommand& cmd) const;
+    PDebugCommand takeInFlightCmd(int token);
     QStringList tokenize(const QString& s);
 
-    bool outputTerminated(const QByteArray& text);
     void handleBreakpoint(const GDBMIResultParser::ParseObject& breakpoint);
     void handleStack(const QList<GDBMIResultParser::ParseValue> & stack);
+    void handleTraceStack(const QList<GDBMIResultParser::ParseValue> & stack);
     void handleLocalVariables(const QList<GDBMIResultParser::ParseValue> & variables);
     void handleEvaluation(const QString& value);
-    void handleMemory(const QList<GDBMIResultParser::ParseValue> & rows);
+    void handleMemoryBytes(const QList<GDBMIResultParser::ParseValue> & blocks);
     void handleRegisterNames(const QList<GDBMIResultParser::ParseValue> & names);
     void handleRegisterValue(const QList<GDBMIResultParser::ParseValue> & values);
     void handleCreateVar(const GDBMIResultParser::ParseObject& multiVars);
@@ -495,9 +657,9 @@ private:
     void processExecAsyncRecord(const QByteArray& line);
     void processError(const QByteArray& errorLine);
     void processResultRecord(const QByteArray& line);
-    void processDebugOutput(const QByteArray& debugOutput);
+    void processDebugOutputLine(const QByteArray& line);
     void runInferiorStoppedHook();
-    QByteArray removeToken(const QByteArray& line);
+    QByteArray removeToken(const QByteArray& line, int* token = nullptr);
 private slots:
     void asyncUpdate();
 private:
@@ -508,8 +670,16 @@ private:
     QQueue<PDebugCommand> mCmdQueue;
     bool mErrorOccured;
     bool mAsyncUpdated;
+    //the next stop is caused by a trace sample interrupt
+    bool mTraceInterruptPending;
+    //flavor set by the last "-gdb-set disassembly-flavor" gdb has done
+    bool mDisassemblyIntelStyle;
     //fOnInvalidateAllVars: TInvalidateAllVarsEvent;
-    bool mCmdRunning;
+    //commands sent to gdb, in the order they were sent
+    QList<PDebugCommand> mInFlightCmds;
+    int mNextToken;
+    //a prompt-terminated block of output is being processed
+    bool mOutputBlockStarted;
     PDebugCommand mCurrentCmd;
     std::shared_ptr<QProcess> mProcess;
     QStringList mBinDirs;
@@ -529,7 +699,7 @@ private:
     bool mReceivedSFWarning;
 
     int mCurrentLine;
-    int mCurrentAddress;
+    qulonglong mCurrentAddress;
     QString mCurrentFunc;
     QString mCurrentFile;
     QStringList mConsoleOutput;
@@ -85,6 +85,7 @@ Editor::Editor(QWidget *parent, const QString& filename,
   mProject(pProject),
   mIsNew(isNew),
   mSyntaxIssues(),
+  mSyntaxIssuesUpdateCount(0),
   mSyntaxErrorColor(Qt::red),
   mSyntaxWarningColor("orange"),
   mLineCount(0),
@@ -830,6 +831,15 @@ void Editor::onGutterPaint(QPainter &painter, int aLine, int X, int Y)
 {
     IconsManager::PPixmap icon;
 
+    //trace heat map: the more samples hit the line, the more opaque the bar
+    TraceRecorder* traceRecorder = pMainWindow->debugger()->traceRecorder();
+    int hits = traceRecorder->hitCount(mFilename, aLine);
+    if (hits>0) {
+        QColor color(Qt::red);
+        color.setAlpha(55 + 200 * hits / traceRecorder->maxHitCount());
+        painter.fillRect(0, Y, 4, textHeight(), color);
+    }
+
     if (mActiveBreakpointLine == aLine) {
         icon = pIconsManager->getPixmap(IconsManager::GUTTER_ACTIVEBREAKPOINT);
     } else if (hasBreakpoint(aLine)) {
@@ -1467,6 +1477,51 @@ void Editor::clearSyntaxIssues()
     mSyntaxIssues.clear();
 }
 
+void Editor::beginUpdateSyntaxIssues()
+{
+    if (mSyntaxIssuesUpdateCount==0)
+        mOldSyntaxIssues = mSyntaxIssues;
+    mSyntaxIssuesUpdateCount++;
+}
+
+static bool sameSyntaxIssues(const Editor::PSyntaxIssueList& list1, const Editor::PSyntaxIssueList& list2)
+{
+    if (list1->count()!=list2->count())
+        return false;
+    for (int i=0;i<list1->count();i++) {
+        const Editor::PSyntaxIssue& issue1 = list1->at(i);
+        const Editor::PSyntaxIssue& issue2 = list2->at(i);
+        if (issue1->startChar!=issue2->startChar
+                || issue1->endChar!=issue2->endChar
+                || issue1->issueType!=issue2->issueType
+                || issue1->hint!=issue2->hint)
+            return false;
+    }
+    return true;
+}
+
+void Editor::endUpdateSyntaxIssues()
+{
+    mSyntaxIssuesUpdateCount--;
+    if (mSyntaxIssuesUpdateCount>0)
+        return;
+    //only repaint lines whose issues are changed
+    for (auto iter=mOldSyntaxIssues.begin();iter!=mOldSyntaxIssues.end();++iter) {
+        auto newIter = mSyntaxIssues.find(iter.key());
+        if (newIter==mSyntaxIssues.end() || !sameSyntaxIssues(iter.value(),newIter.value())) {
+            invalidateLine(iter.key());
+            invalidateGutterLine(iter.key());
+        }
+    }
+    for (auto iter=mSyntaxIssues.begin();iter!=mSyntaxIssues.end();++iter) {
+        if (!mOldSyntaxIssues.contains(iter.key())) {
+            invalidateLine(iter.key());
+            invalidateGutterLine(iter.key());
+        }
+    }
+    mOldSyntaxIssues.clear();
+}
+
 void Editor::gotoNextSyntaxIssue()
 {
     auto iter = mSyntaxIssues.find(caretY());
@@ -177,6 +177,8 @@ public:
 
     void addSyntaxIssues(int line, int startChar, int endChar, CompileIssueType errorType, const QString& hint);
     void clearSyntaxIssues();
+    void beginUpdateSyntaxIssues();
+    void endUpdateSyntaxIssues();
     void gotoNextSyntaxIssue();
     void gotoPrevSyntaxIssue();
     bool hasPrevSyntaxIssue() const;
@@ -298,6 +300,8 @@ private:
     Project* mProject;
     bool mIsNew;
     QMap<int,PSyntaxIssueList> mSyntaxIssues;
+    QMap<int,PSyntaxIssueList> mOldSyntaxIssues;
+    int mSyntaxIssuesUpdateCount;
     QColor mSyntaxErrorColor;
     QColor mSyntaxWarningColor;
     QColor mActiveBreakpointForegroundColor;
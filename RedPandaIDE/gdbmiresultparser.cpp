@@ -19,6 +19,7 @@
 #include <QFileInfo>
 #include <QList>
 #include <QDebug>
+#include <cstring>
 
 GDBMIResultParser::GDBMIResultParser()
 {
@@ -31,7 +32,7 @@ GDBMIResultParser::GDBMIResultParser()
     mResultTypes.insert("-data-evaluate-expression",GDBMIResultType::Evaluation);
 //    mResultTypes.insert("register-names",GDBMIResultType::RegisterNames);
 //    mResultTypes.insert("register-values",GDBMIResultType::RegisterValues);
-    mResultTypes.insert("-data-read-memory",GDBMIResultType::Memory);
+    mResultTypes.insert("-data-read-memory-bytes",GDBMIResultType::Memory);
     mResultTypes.insert("-data-list-register-names",GDBMIResultType::RegisterNames);
     mResultTypes.insert("-data-list-register-values",GDBMIResultType::RegisterValues);
     mResultTypes.insert("-var-create",GDBMIResultType::CreateVar);
@@ -41,8 +42,10 @@ GDBMIResultParser::GDBMIResultParser()
 
 bool GDBMIResultParser::parse(const QByteArray &record, const QString& command, GDBMIResultType &type, ParseObject& multiValues)
 {
-    const char* p = record.data();
-    bool result = parseMultiValues(p,multiValues);
+    std::shared_ptr<ParseDocument> doc = std::make_shared<ParseDocument>();
+    doc->record = record;
+    int root = addNode(*doc, -1, ParseValueType::Object);
+    bool result = parseMultiValues(doc->record.constData(),*doc, root);
     if (!result)
         return false;
 //    if (*p!=0)
@@ -50,12 +53,16 @@ bool GDBMIResultParser::parse(const QByteArray &record, const QString& command,
     if (!mResultTypes.contains(command))
         return false;
     type = mResultTypes[command];
+    multiValues = ParseObject(doc, root);
     return true;
 }
 
 bool GDBMIResultParser::parseAsyncResult(const QByteArray &record, QByteArray &result, ParseObject &multiValue)
 {
-    const char* p =record.data();
+    std::shared_ptr<ParseDocument> doc = std::make_shared<ParseDocument>();
+    doc->record = record;
+    int root = addNode(*doc, -1, ParseValueType::Object);
+    const char* p =doc->record.constData();
     if (*p!='*')
         return false;
     p++;
@@ -63,21 +70,45 @@ bool GDBMIResultParser::parseAsyncResult(const QByteArray &record, QByteArray &r
     while (*p && *p!=',')
         p++;
     result = QByteArray(start,p-start);
+    multiValue = ParseObject(doc, root);
     if (*p==0)
         return true;
     p++;
-    return parseMultiValues(p,multiValue);
+    return parseMultiValues(p,*doc,root);
+}
+
+int GDBMIResultParser::addNode(ParseDocument &doc, int parent, ParseValueType type, const char *nameStart, int nameLength)
+{
+    ParseNode node;
+    node.type = type;
+    node.nameStart = nameStart?(nameStart - doc.record.constData()):0;
+    node.nameLength = nameLength;
+    node.valueStart = 0;
+    node.valueLength = 0;
+    node.escaped = false;
+    node.childCount = 0;
+    node.firstChild = -1;
+    node.lastChild = -1;
+    node.nextSibling = -1;
+    int index = doc.nodes.count();
+    doc.nodes.append(node);
+    if (parent>=0) {
+        ParseNode& parentNode = doc.nodes[parent];
+        if (parentNode.lastChild>=0)
+            doc.nodes[parentNode.lastChild].nextSibling = index;
+        else
+            parentNode.firstChild = index;
+        parentNode.lastChild = index;
+        parentNode.childCount++;
+    }
+    return index;
 }
 
-bool GDBMIResultParser::parseMultiValues(const char* p, ParseObject &multiValue)
+bool GDBMIResultParser::parseMultiValues(const char* p, ParseDocument& doc, int parent)
 {
     while (*p) {
-        QByteArray propName;
-        ParseValue propValue;
-        bool result = parseNameAndValue(p,propName,propValue);
-        if (result) {
-            multiValue[propName]=propValue;
-        } else {
+        bool result = parseNameAndValue(p,doc,parent);
+        if (!result) {
             return false;
         }
         skipSpaces(p);
@@ -91,7 +122,7 @@ bool GDBMIResultParser::parseMultiValues(const char* p, ParseObject &multiValue)
     return true;
 }
 
-bool GDBMIResultParser::parseNameAndValue(const char *&p, QByteArray &name, ParseValue &value)
+bool GDBMIResultParser::parseNameAndValue(const char *&p, ParseDocument& doc, int parent)
 {
     skipSpaces(p);
     const char* nameStart =p;
@@ -100,35 +131,32 @@ bool GDBMIResultParser::parseNameAndValue(const char *&p, QByteArray &name, Pars
     }
     if (*p==0)
         return false;
-    name = QByteArray(nameStart,p-nameStart);
+    int nameLength = p-nameStart;
     skipSpaces(p);
     if (*p!='=')
         return false;
     p++;
-    return parseValue(p,value);
+    return parseValue(p,doc,parent,nameStart,nameLength);
 }
 
-bool GDBMIResultParser::parseValue(const char *&p, ParseValue &value)
+bool GDBMIResultParser::parseValue(const char *&p, ParseDocument& doc, int parent, const char* nameStart, int nameLength)
 {
     skipSpaces(p);
     bool result;
     switch (*p) {
     case '{': {
-        ParseObject obj;
-        result = parseObject(p,obj);
-        value = obj;
+        int node = addNode(doc,parent,ParseValueType::Object,nameStart,nameLength);
+        result = parseObject(p,doc,node);
         break;
     }
     case '[': {
-        QList<ParseValue> array;
-        result = parseArray(p,array);
-        value = array;
+        int node = addNode(doc,parent,ParseValueType::Array,nameStart,nameLength);
+        result = parseArray(p,doc,node);
         break;
     }
     case '"': {
-        QByteArray s;
-        result = parseStringValue(p,s);
-        value = s;
+        int node = addNode(doc,parent,ParseValueType::Value,nameStart,nameLength);
+        result = parseStringValue(p,doc,node);
         break;
     }
     default:
@@ -140,16 +168,41 @@ bool GDBMIResultParser::parseValue(const char *&p, ParseValue &value)
     return true;
 }
 
-bool GDBMIResultParser::parseStringValue(const char *&p, QByteArray& stringValue)
+bool GDBMIResultParser::parseStringValue(const char *&p, ParseDocument& doc, int node)
 {
     if (*p!='"')
         return false;
     p++;
-    stringValue.clear();
+    const char* start = p;
+    bool escaped = false;
     while (*p!=0) {
         if (*p == '"') {
             break;
         } else if (*p=='\\' && *(p+1)!=0) {
+            escaped = true;
+            p+=2;
+        } else {
+            p++;
+        }
+    }
+    if (*p=='"') {
+        ParseNode& n = doc.nodes[node];
+        n.valueStart = start - doc.record.constData();
+        n.valueLength = p - start;
+        n.escaped = escaped;
+        p++; //skip '"'
+        return true;
+    }
+    return false;
+}
+
+QByteArray GDBMIResultParser::unescape(const char *p, int length)
+{
+    QByteArray stringValue;
+    stringValue.reserve(length);
+    const char* end = p+length;
+    while (p<end) {
+        if (*p=='\\' && p+1<end) {
             p++;
             switch (*p) {
             case '\'':
@@ -206,7 +259,7 @@ bool GDBMIResultParser::parseStringValue(const char *&p, QByteArray& stringValue
             case '7':
             {
                 int i=0;
-                for (i=0;i<3;i++) {
+                for (i=0;i<3 && p+i<end;i++) {
                     if (*(p+i)<'0' || *(p+i)>'7')
                         break;
                 }
@@ -217,20 +270,21 @@ bool GDBMIResultParser::parseStringValue(const char *&p, QByteArray& stringValue
                 p+=i;
                 break;
             }
+            default:
+                //unknown escape sequences keep the escaped char
+                stringValue+=*p;
+                p++;
+                break;
             }
         } else {
             stringValue+=*p;
             p++;
         }
     }
-    if (*p=='"') {
-        p++; //skip '"'
-        return true;
-    }
-    return false;
+    return stringValue;
 }
 
-bool GDBMIResultParser::parseObject(const char *&p, ParseObject &obj)
+bool GDBMIResultParser::parseObject(const char *&p, ParseDocument& doc, int node)
 {
     if (*p!='{')
         return false;
@@ -238,12 +292,8 @@ bool GDBMIResultParser::parseObject(const char *&p, ParseObject &obj)
 
     if (*p!='}') {
         while (*p!=0) {
-            QByteArray propName;
-            ParseValue propValue;
-            bool result = parseNameAndValue(p,propName,propValue);
-            if (result) {
-                obj[propName]=propValue;
-            } else {
+            bool result = parseNameAndValue(p,doc,node);
+            if (!result) {
                 return false;
             }
             skipSpaces(p);
@@ -263,7 +313,7 @@ bool GDBMIResultParser::parseObject(const char *&p, ParseObject &obj)
     return false;
 }
 
-bool GDBMIResultParser::parseArray(const char *&p, QList<GDBMIResultParser::ParseValue> &array)
+bool GDBMIResultParser::parseArray(const char *&p, ParseDocument& doc, int node)
 {
     if (*p!='[')
         return false;
@@ -272,24 +322,17 @@ bool GDBMIResultParser::parseArray(const char *&p, QList<GDBMIResultParser::Pars
         while (*p!=0) {
             skipSpaces(p);
             if (*p=='{' || *p=='"' || *p=='[') {
-                ParseValue val;
-                bool result = parseValue(p,val);
-                if (result) {
-                    array.append(val);
-                } else {
+                bool result = parseValue(p,doc,node);
+                if (!result) {
                     return false;
                 }
             } else {
-                QByteArray name;
-                ParseValue val;
-                bool result = parseNameAndValue(p,name,val);
-                if (result) {
-                    array.append(val);
-                } else {
+                bool result = parseNameAndValue(p,doc,node);
+                if (!result) {
                     return false;
                 }
             }
-            skipSpaces(p);            
+            skipSpaces(p);
             if (*p==']')
                 break;
             if (*p!=',')
@@ -334,26 +377,68 @@ void GDBMIResultParser::skipSpaces(const char *&p)
         p++;
 }
 
-const QByteArray &GDBMIResultParser::ParseValue::value() const
+GDBMIResultParser::ParseValue::ParseValue():
+    mNode(-1)
+{
+
+}
+
+GDBMIResultParser::ParseValue::ParseValue(const PParseDocument &doc, int node):
+    mDoc(doc),
+    mNode(node)
+{
+
+}
+
+const GDBMIResultParser::ParseNode &GDBMIResultParser::ParseValue::node() const
 {
-    return mValue;
+    return mDoc->nodes[mNode];
 }
 
-const QList<::GDBMIResultParser::ParseValue> &GDBMIResultParser::ParseValue::array() const
+QByteArray GDBMIResultParser::ParseValue::rawValue() const
 {
-    return mArray;
+    //no copy, only valid while the document is alive
+    if (type()!=ParseValueType::Value)
+        return QByteArray();
+    const ParseNode& n = node();
+    return QByteArray::fromRawData(mDoc->record.constData()+n.valueStart, n.valueLength);
 }
 
-const GDBMIResultParser::ParseObject &GDBMIResultParser::ParseValue::object() const
+QByteArray GDBMIResultParser::ParseValue::value() const
 {
-    return mObject;
+    if (type()!=ParseValueType::Value)
+        return QByteArray();
+    const ParseNode& n = node();
+    const char* p = mDoc->record.constData()+n.valueStart;
+    if (n.escaped)
+        return unescape(p, n.valueLength);
+    return QByteArray(p, n.valueLength);
+}
+
+QList<GDBMIResultParser::ParseValue> GDBMIResultParser::ParseValue::array() const
+{
+    QList<ParseValue> result;
+    if (type()!=ParseValueType::Array)
+        return result;
+    result.reserve(node().childCount);
+    for (int i=node().firstChild;i>=0;i=mDoc->nodes[i].nextSibling) {
+        result.append(ParseValue(mDoc,i));
+    }
+    return result;
+}
+
+GDBMIResultParser::ParseObject GDBMIResultParser::ParseValue::object() const
+{
+    if (type()!=ParseValueType::Object)
+        return ParseObject();
+    return ParseObject(mDoc,mNode);
 }
 
 int GDBMIResultParser::ParseValue::intValue(int defaultValue) const
 {
     //Q_ASSERT(mType == ParseValueType::Value);
     bool ok;
-    int value = QString(mValue).toInt(&ok);
+    int value = rawValue().toInt(&ok);
     if (ok)
         return value;
     else
@@ -364,7 +449,7 @@ int GDBMIResultParser::ParseValue::hexValue(int defaultValue) const
 {
     //Q_ASSERT(mType == ParseValueType::Value);
     bool ok;
-    int value = QString(mValue).toInt(&ok,16);
+    int value = rawValue().toInt(&ok,16);
     if (ok)
         return value;
     else
@@ -374,118 +459,88 @@ int GDBMIResultParser::ParseValue::hexValue(int defaultValue) const
 QString GDBMIResultParser::ParseValue::pathValue() const
 {
     //Q_ASSERT(mType == ParseValueType::Value);
-    return QFileInfo(QString::fromLocal8Bit(mValue)).absoluteFilePath();
+    return QFileInfo(QString::fromLocal8Bit(value())).absoluteFilePath();
 }
 
 QString GDBMIResultParser::ParseValue::utf8PathValue() const
 {
-    return QFileInfo(QString::fromUtf8(mValue)).absoluteFilePath();
+    return QFileInfo(QString::fromUtf8(value())).absoluteFilePath();
 }
 
 GDBMIResultParser::ParseValueType GDBMIResultParser::ParseValue::type() const
 {
-    return mType;
+    if (!isValid())
+        return ParseValueType::NotAssigned;
+    return node().type;
 }
 
 bool GDBMIResultParser::ParseValue::isValid() const
 {
-    return mType!=ParseValueType::NotAssigned;
-}
-
-GDBMIResultParser::ParseValue::ParseValue():
-    mType(ParseValueType::NotAssigned) {
-
-}
-
-GDBMIResultParser::ParseValue::ParseValue(const QByteArray &value):
-    mValue(value),
-    mType(ParseValueType::Value)
-{
+    return mDoc && mNode>=0;
 }
 
-GDBMIResultParser::ParseValue::ParseValue(const ParseObject &object):
-    mObject(object),
-    mType(ParseValueType::Object)
+GDBMIResultParser::ParseObject::ParseObject():
+    mNode(-1)
 {
-}
 
-GDBMIResultParser::ParseValue::ParseValue(const QList<ParseValue> &array):
-    mArray(array),
-    mType(ParseValueType::Array)
-{
 }
 
-GDBMIResultParser::ParseValue::ParseValue(const ParseValue &value):
-    mValue(value.mValue),
-    mArray(value.mArray),
-    mObject(value.mObject),
-    mType(value.mType)
+GDBMIResultParser::ParseObject::ParseObject(const PParseDocument &doc, int node):
+    mDoc(doc),
+    mNode(node)
 {
-}
 
-GDBMIResultParser::ParseValue &GDBMIResultParser::ParseValue::operator=(const GDBMIResultParser::ParseValue &value)
-{
-    mType = value.mType;
-    mValue = value.mValue;
-    mArray = value.mArray;
-    mObject = value.mObject;
-    return *this;
 }
 
-GDBMIResultParser::ParseValue &GDBMIResultParser::ParseValue::operator=(const QByteArray &value)
-{
-    Q_ASSERT(mType == ParseValueType::NotAssigned);
-    mType = ParseValueType::Value;
-    mValue = value;
-    return *this;
-}
-
-GDBMIResultParser::ParseValue &GDBMIResultParser::ParseValue::operator=(const ParseObject& object)
-{
-    Q_ASSERT(mType == ParseValueType::NotAssigned);
-    mType = ParseValueType::Object;
-    mObject = object;
-    return *this;
-}
-
-GDBMIResultParser::ParseValue &GDBMIResultParser::ParseValue::operator=(const QList<ParseValue>& array)
+GDBMIResultParser::ParseValue GDBMIResultParser::ParseObject::operator[](const QByteArray &name) const
 {
-    Q_ASSERT(mType == ParseValueType::NotAssigned);
-    mType = ParseValueType::Array;
-    mArray = array;
-    return *this;
+    if (!mDoc || mNode<0)
+        return ParseValue();
+    //objects are small, a linear search is faster than building a hash;
+    //like before, the last property with the name wins
+    int found = -1;
+    const char* record = mDoc->record.constData();
+    for (int i=mDoc->nodes[mNode].firstChild;i>=0;i=mDoc->nodes[i].nextSibling) {
+        const ParseNode& n = mDoc->nodes[i];
+        if (n.nameLength == name.length()
+                && memcmp(record+n.nameStart, name.constData(), n.nameLength)==0)
+            found = i;
+    }
+    if (found<0)
+        return ParseValue();
+    return ParseValue(mDoc, found);
 }
 
-
-GDBMIResultParser::ParseObject::ParseObject()
+GDBMILineBuffer::GDBMILineBuffer():
+    mStart(0),
+    mScanned(0)
 {
 
 }
 
-GDBMIResultParser::ParseObject::ParseObject(const ParseObject &object):
-    mProps(object.mProps)
+void GDBMILineBuffer::append(const QByteArray &data)
 {
-
+    mBuffer.append(data);
 }
 
-GDBMIResultParser::ParseValue GDBMIResultParser::ParseObject::operator[](const QByteArray &name) const
+bool GDBMILineBuffer::takeLine(QByteArray &line)
 {
-    if (mProps.contains(name)) {
-        ParseValue value(mProps[name]);
-        return value;
+    int pos = mBuffer.indexOf('\n', mScanned);
+    if (pos<0) {
+        mScanned = mBuffer.length();
+        //drop the lines taken, only the incomplete line is moved
+        if (mStart>0) {
+            mBuffer.remove(0, mStart);
+            mScanned -= mStart;
+            mStart = 0;
+        }
+        return false;
     }
-    return ParseValue();
-}
-
-GDBMIResultParser::ParseObject &GDBMIResultParser::ParseObject::operator=(const ParseObject &object)
-{
-    mProps = object.mProps;
-    return *this;
-}
-
-GDBMIResultParser::ParseValue &GDBMIResultParser::ParseObject::operator[](const QByteArray &name) {
-    if (!mProps.contains(name))
-        mProps[name]=ParseValue();
-    return mProps[name];
+    int end = pos;
+    if (end>mStart && mBuffer[end-1]=='\r')
+        end--;
+    line = mBuffer.mid(mStart, end-mStart);
+    mStart = pos+1;
+    mScanned = mStart;
+    return true;
 }
-
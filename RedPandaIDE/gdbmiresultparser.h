@@ -20,6 +20,7 @@
 #include <QByteArray>
 #include <QHash>
 #include <QList>
+#include <QVector>
 #include <memory>
 
 
@@ -51,29 +52,51 @@ public:
         NotAssigned
     };
 
+private:
+    //parse results are kept in a flat node list; values are offsets into
+    //the record, and strings are only unescaped when they are read
+    struct ParseNode {
+        ParseValueType type;
+        int nameStart;
+        int nameLength;
+        int valueStart;
+        int valueLength;
+        bool escaped;
+        int childCount;
+        int firstChild;
+        int lastChild;
+        int nextSibling;
+    };
+
+    struct ParseDocument {
+        QByteArray record;
+        QVector<ParseNode> nodes;
+    };
+
+    using PParseDocument = std::shared_ptr<const ParseDocument>;
+
+public:
     class ParseValue;
 
     class ParseObject {
     public:
         explicit ParseObject();
-        ParseObject(const ParseObject& object);
         ParseValue operator[](const QByteArray& name) const;
-        ParseValue& operator[](const QByteArray& name);
-        ParseObject& operator=(const ParseObject& object);
     private:
-        QHash<QByteArray, ParseValue> mProps;
+        ParseObject(const PParseDocument& doc, int node);
+    private:
+        PParseDocument mDoc;
+        int mNode;
+        friend class GDBMIResultParser;
+        friend class ParseValue;
     };
 
     class ParseValue {
     public:
         explicit ParseValue();
-        explicit ParseValue(const QByteArray& value);
-        explicit ParseValue(const ParseObject &object);
-        explicit ParseValue(const QList<ParseValue>& array);
-        ParseValue(const ParseValue& value);
-        const QByteArray &value() const;
-        const QList<ParseValue> &array() const;
-        const ParseObject &object() const;
+        QByteArray value() const;
+        QList<ParseValue> array() const;
+        ParseObject object() const;
         int intValue(int defaultValue=-1) const;
         int hexValue(int defaultValue=-1) const;
 
@@ -81,35 +104,58 @@ public:
         QString utf8PathValue() const;
         ParseValueType type() const;
         bool isValid() const;
-        ParseValue& operator=(const QByteArray& value);
-        ParseValue& operator=(const ParseObject& object);
-        ParseValue& operator=(const QList<ParseValue>& array);
-        ParseValue& operator=(const ParseValue& value);
     private:
-        QByteArray mValue;
-        QList<ParseValue> mArray;
-        ParseObject mObject;
-        ParseValueType mType;
+        ParseValue(const PParseDocument& doc, int node);
+        const ParseNode& node() const;
+        QByteArray rawValue() const;
+    private:
+        PParseDocument mDoc;
+        int mNode;
+        friend class GDBMIResultParser;
+        friend class ParseObject;
     };
 
-    using PParseValue = std::shared_ptr<ParseValue>;
-
 public:
     GDBMIResultParser();
     bool parse(const QByteArray& record, const QString& command, GDBMIResultType& type, ParseObject& multiValues);
     bool parseAsyncResult(const QByteArray& record, QByteArray& result, ParseObject& multiValue);
 private:
-    bool parseMultiValues(const char*p, ParseObject& multiValue);
-    bool parseNameAndValue(const char *&p,QByteArray& name, ParseValue& value);
-    bool parseValue(const char* &p, ParseValue& value);
-    bool parseStringValue(const char*&p, QByteArray& stringValue);
-    bool parseObject(const char*&p, ParseObject& obj);
-    bool parseArray(const char*&p, QList<ParseValue>& array);
+    int addNode(ParseDocument& doc, int parent, ParseValueType type,
+                const char* nameStart = nullptr, int nameLength = 0);
+    bool parseMultiValues(const char*p, ParseDocument& doc, int parent);
+    bool parseNameAndValue(const char *&p, ParseDocument& doc, int parent);
+    bool parseValue(const char* &p, ParseDocument& doc, int parent,
+                    const char* nameStart = nullptr, int nameLength = 0);
+    bool parseStringValue(const char*&p, ParseDocument& doc, int node);
+    bool parseObject(const char*&p, ParseDocument& doc, int node);
+    bool parseArray(const char*&p, ParseDocument& doc, int node);
     void skipSpaces(const char* &p);
     bool isNameChar(char ch);
     bool isSpaceChar(char ch);
+    static QByteArray unescape(const char* p, int length);
 private:
     QHash<QString, GDBMIResultType> mResultTypes;
 };
 
+/**
+ * @brief Splits gdb's output into lines as it arrives.
+ *
+ * Bytes are scanned for the line end only once, so a long line that arrives
+ * in many chunks costs linear time.
+ */
+class GDBMILineBuffer
+{
+public:
+    GDBMILineBuffer();
+    void append(const QByteArray& data);
+    //takes the next complete line (without the line break), false if there is none
+    bool takeLine(QByteArray& line);
+private:
+    QByteArray mBuffer;
+    //start of the first line not taken
+    int mStart;
+    //end of the bytes already scanned for the line break
+    int mScanned;
+};
+
 #endif // GDBMIRESULTPARSER_H
@@ -310,6 +310,7 @@ int main(int argc, char *argv[])
     }
     qRegisterMetaType<PCompileIssue>("PCompileIssue");
     qRegisterMetaType<PCompileIssue>("PCompileIssue&");
+    qRegisterMetaType<POJProblem>("POJProblem");
     qRegisterMetaType<QVector<int>>("QVector<int>");
     qRegisterMetaType<QHash<int,QString>>("QHash<int,QString>");
 
@@ -55,15 +55,11 @@
 #include <QDragEnterEvent>
 #include <QFileDialog>
 #include <QInputDialog>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMessageBox>
 #include <QMimeData>
 #include <QScreen>
-#include <QTcpSocket>
 #include <QTemporaryFile>
 #include <QTextBlock>
 #include <QTranslator>
@@ -107,7 +103,9 @@ MainWindow::MainWindow(QWidget *parent)
       ui(new Ui::MainWindow),
       mSearchDialog(nullptr),
       mQuitting(false),
+      mCompetitiveCompanionReceiver(nullptr),
       mCheckSyntaxInBack(false),
+      mSyntaxCheckCanceled(false),
       mShouldRemoveAllSettings(false),
       mClosing(false),
       mClosingAll(false),
@@ -178,6 +176,14 @@ MainWindow::MainWindow(QWidget *parent)
     ui->tblMemoryView->setModel(mDebugger->memoryModel());
     delete m;
 
+    //debug views that are hidden when the inferior stops are refreshed when shown
+    connect(ui->debugViews, &QTabWidget::currentChanged,
+            mDebugger.get(), &Debugger::refreshVisibleViews);
+    connect(ui->tabMessages, &QTabWidget::currentChanged,
+            mDebugger.get(), &Debugger::refreshVisibleViews);
+    connect(ui->dockMessages, &QDockWidget::visibilityChanged,
+            mDebugger.get(), &Debugger::refreshVisibleViews);
+
     ui->tblMemoryView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
 
     try {
@@ -254,6 +260,12 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onDebugMemoryAddressInput);
 
     mTodoParser = std::make_shared<TodoParser>();
+    connect(mTodoParser.get(), &TodoParser::parseStarted,
+            this, &MainWindow::onTodoParseStarted);
+    connect(mTodoParser.get(), &TodoParser::todoFound,
+            this, &MainWindow::onTodoParsing);
+    connect(mTodoParser.get(), &TodoParser::parseFinished,
+            this, &MainWindow::onTodoParseFinished);
     mSymbolUsageManager = std::make_shared<SymbolUsageManager>();
     try {
         mSymbolUsageManager->load();
@@ -322,6 +334,7 @@ MainWindow::MainWindow(QWidget *parent)
     m=ui->tblProblemCases->selectionModel();
     ui->tblProblemCases->setModel(&mOJProblemModel);
     delete m;
+    ui->tblProblemCases->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
     connect(ui->lstProblemSet->selectionModel(),
             &QItemSelectionModel::currentRowChanged,
             this, &MainWindow::onProblemSetIndexChanged);
@@ -331,8 +344,6 @@ MainWindow::MainWindow(QWidget *parent)
     connect(&mOJProblemSetModel, &OJProblemSetModel::problemNameChanged,
             this , &MainWindow::onProblemNameChanged);
     ui->pbProblemCases->setVisible(false);
-    connect(&mTcpServer,&QTcpServer::newConnection,
-            this, &MainWindow::onNewProblemConnection);
 
     connect(&mOJProblemModel, &OJProblemModel::dataChanged,
             this, &MainWindow::updateProblemTitle);
@@ -345,6 +356,8 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onFileSystemModelLayoutChanged, Qt::QueuedConnection);
     mFileSystemModel.setReadOnly(false);
     mFileSystemModel.setIconProvider(&mFileSystemModelIconProvider);
+    connect(mFileSystemModelIconProvider.VCSRepository(), &GitRepository::statusChanged,
+            this, &MainWindow::onFileSystemVCSStatusChanged);
 
     mFileSystemModel.setNameFilters(pSystemConsts->defaultFileNameFilters());
     mFileSystemModel.setNameFilterDisables(true);
@@ -378,6 +391,18 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onAutoSaveTimeout);
     resetAutoSaveTimer();
 
+    mCheckSyntaxTimer.setSingleShot(true);
+    mCheckSyntaxTimer.setInterval(300);
+    connect(&mCheckSyntaxTimer, &QTimer::timeout,
+            this, &MainWindow::onCheckSyntaxTimeout);
+
+    mTraceHeatMapTimer.setSingleShot(true);
+    mTraceHeatMapTimer.setInterval(500);
+    connect(&mTraceHeatMapTimer, &QTimer::timeout,
+            this, &MainWindow::onTraceHeatMapTimeout);
+    connect(mDebugger->traceRecorder(), &TraceRecorder::samplesChanged,
+            this, &MainWindow::onTraceSamplesChanged);
+
     connect(ui->menuFile, &QMenu::aboutToShow,
             this,&MainWindow::rebuildOpenedFileHisotryMenu);
 
@@ -412,6 +437,7 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    stopCompetitiveCompanionReceiver();
     delete mProjectProxyModel;
     delete mEditorList;
     delete ui;
@@ -616,6 +642,8 @@ void MainWindow::updateCompileActions()
         disableDebugActions();
     }
     ui->actionStop_Execution->setEnabled(mCompilerManager->running() || mDebugger->executing());
+    ui->actionRecord_Trace->setEnabled(mDebugger->executing());
+    ui->actionRecord_Trace->setChecked(mDebugger->traceRecording());
 
     //it's not a compile action, but put here for convinience
     ui->actionSaveAll->setEnabled(mProject!=nullptr
@@ -773,18 +801,14 @@ void MainWindow::applySettings()
     ui->txtProblemCaseExpected->setFont(caseEditorFont);
     ui->lblProblemCaseExpected->setFont(caseEditorFont);
 
-    mTcpServer.close();
+    stopCompetitiveCompanionReceiver();
     if (pSettings->executor().enableProblemSet()) {
         if (pSettings->executor().enableCompetitiveCompanion()) {
-            if (!mTcpServer.listen(QHostAddress::LocalHost,pSettings->executor().competivieCompanionPort())) {
-//                QMessageBox::critical(nullptr,
-//                                      tr("Listen failed"),
-//                                      tr("Can't listen to port %1 form Competitive Companion.").arg(10045)
-//                                      + "<BR/>"
-//                                      +tr("You can turn off competitive companion support in the Problem Set options.")
-//                                      + "<BR/>"
-//                                      +tr("Or You can choose a different port number and try again."));
-            }
+            mCompetitiveCompanionReceiver = new CompetitiveCompanionReceiver(
+                        pSettings->executor().competivieCompanionPort());
+            connect(mCompetitiveCompanionReceiver, &CompetitiveCompanionReceiver::problemReceived,
+                    this, &MainWindow::onNewProblemReceived);
+            mCompetitiveCompanionReceiver->start();
         }
     }
 
@@ -907,6 +931,7 @@ void MainWindow::onFileSaved(const QString &path, bool inProject)
     if (pSettings->vcs().gitOk()) {
         QString branch;
         if (inProject && mProject && mProject->model()->iconProvider()->VCSRepository()->hasRepository(branch)) {
+            mProject->model()->iconProvider()->VCSRepository()->invalidate();
             mProject->model()->beginUpdate();
             mProject->model()->endUpdate();
         }
@@ -920,6 +945,7 @@ void MainWindow::onFileSaved(const QString &path, bool inProject)
                 }
             }
 //            qDebug()<<"update icon provider";
+            mFileSystemModelIconProvider.VCSRepository()->invalidate();
             mFileSystemModelIconProvider.update();
             mFileSystemModel.setIconProvider(&mFileSystemModelIconProvider);
             ui->treeFiles->update(index);
@@ -1151,6 +1177,21 @@ QPlainTextEdit *MainWindow::txtLocals()
     return ui->txtLocals;
 }
 
+bool MainWindow::isLocalsViewVisible() const
+{
+    return !ui->tabMessages->isShrinked() && ui->tabLocals->isVisible();
+}
+
+bool MainWindow::isMemoryViewVisible() const
+{
+    return !ui->tabMessages->isShrinked() && ui->tabMemory->isVisible();
+}
+
+bool MainWindow::isStackTraceViewVisible() const
+{
+    return !ui->tabMessages->isShrinked() && ui->tabStackTrace->isVisible();
+}
+
 QMenuBar *MainWindow::menuBar() const
 {
     return ui->menubar;
@@ -1613,22 +1654,42 @@ void MainWindow::checkSyntaxInBack(Editor *e)
                 )
             return;
     }
-    if (mCompilerManager->backgroundSyntaxChecking())
+    if (!pSettings->compilerSets().defaultSet())
         return;
-    if (mCompilerManager->compiling())
+
+    //the buffer has changed, so the running check is out of date
+    if (mCheckSyntaxInBack && mSyntaxCheckingFile == e->filename()) {
+        mSyntaxCheckCanceled = true;
+        mCompilerManager->stopCheckSyntax();
+    }
+    if (!mSyntaxCheckQueue.contains(e->filename()))
+        mSyntaxCheckQueue.append(e->filename());
+    mCheckSyntaxTimer.start();
+}
+
+void MainWindow::onCheckSyntaxTimeout()
+{
+    //resumed when the running check/compile finished
+    if (mCheckSyntaxInBack || mCompilerManager->backgroundSyntaxChecking())
         return;
-    if (!pSettings->compilerSets().defaultSet())
+    if (mCompilerManager->compiling())
         return;
-    if (mCheckSyntaxInBack)
+    while (!mSyntaxCheckQueue.isEmpty()) {
+        QString filename = mSyntaxCheckQueue.takeFirst();
+        Editor* e = mEditorList->getOpenedEditorByFilename(filename);
+        if (!e)
+            continue;
+        mCheckSyntaxInBack=true;
+        mSyntaxCheckCanceled = false;
+        mSyntaxCheckingFile = e->filename();
+        mSyntaxCheckIssues.clear();
+        CompileTarget target =getCompileTarget();
+        if (target ==CompileTarget::Project) {
+            mCompilerManager->checkSyntax(e->filename(), e->fileEncoding(), e->text(), mProject);
+        } else {
+            mCompilerManager->checkSyntax(e->filename(),e->fileEncoding(),e->text(), nullptr);
+        }
         return;
-
-    mCheckSyntaxInBack=true;
-    clearIssues();
-    CompileTarget target =getCompileTarget();
-    if (target ==CompileTarget::Project) {
-        mCompilerManager->checkSyntax(e->filename(), e->fileEncoding(), e->text(), mProject);
-    } else {
-        mCompilerManager->checkSyntax(e->filename(),e->fileEncoding(),e->text(), nullptr);
     }
 }
 
@@ -2493,6 +2554,26 @@ void MainWindow::buildContextMenus()
     ui->watchView->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(ui->watchView,&QWidget::customContextMenuRequested,
             this, &MainWindow::onWatchViewContextMenu);
+    //children of big vars are fetched page by page when they are scrolled into view
+    connect(ui->watchView->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &MainWindow::loadVisibleWatchVarChildren);
+    connect(mDebugger->watchModel(), &QAbstractItemModel::rowsInserted,
+            this, &MainWindow::loadVisibleWatchVarChildren, Qt::QueuedConnection);
+    //memory pages are fetched when they are scrolled into view
+    connect(ui->tblMemoryView->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &MainWindow::loadVisibleMemoryPages);
+    connect(ui->tblMemoryView->verticalScrollBar(), &QScrollBar::rangeChanged,
+            this, &MainWindow::loadVisibleMemoryPages);
+    connect(ui->debugViews, &QTabWidget::currentChanged,
+            this, &MainWindow::loadVisibleMemoryPages, Qt::QueuedConnection);
+    connect(mDebugger->memoryModel(), &QAbstractItemModel::modelReset,
+            this, &MainWindow::loadVisibleMemoryPages, Qt::QueuedConnection);
+    connect(mDebugger->memoryModel(), &MemoryModel::invalidated,
+            this, &MainWindow::loadVisibleMemoryPages, Qt::QueuedConnection);
+    connect(ui->watchView, &QAbstractItemView::doubleClicked,
+            mDebugger->watchModel(), &WatchModel::loadMoreChildren);
+    connect(ui->watchView, &QTreeView::collapsed,
+            mDebugger->watchModel(), &WatchModel::releaseVarChildren);
 
     //context menu signal for the bookmark view
     ui->tableBookmark->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -3011,6 +3092,36 @@ void MainWindow::onAutoSaveTimeout()
     updateStatusbarMessage(tr("%1 files autosaved").arg(updateCount));
 }
 
+void MainWindow::loadVisibleWatchVarChildren()
+{
+    WatchModel* model = mDebugger->watchModel();
+    QModelIndex index = ui->watchView->indexAt(QPoint(0,0));
+    int height = ui->watchView->viewport()->height();
+    while (index.isValid() && ui->watchView->visualRect(index).top()<height) {
+        //more pages must be asked for (double click) when a var has many loaded;
+        //evicted pages are loaded again in place of the pages farthest away
+        if (model->canAutoLoadMoreChildren(index)) {
+            model->loadMoreChildren(index);
+        } else if (model->isEvictedChildItem(index)) {
+            model->loadEvictedChildren(index);
+        }
+        index = ui->watchView->indexBelow(index);
+    }
+}
+
+void MainWindow::loadVisibleMemoryPages()
+{
+    if (!ui->tblMemoryView->isVisible())
+        return;
+    int firstRow = ui->tblMemoryView->rowAt(0);
+    if (firstRow<0)
+        return;
+    int lastRow = ui->tblMemoryView->rowAt(ui->tblMemoryView->viewport()->height()-1);
+    if (lastRow<0)
+        lastRow = mDebugger->memoryModel()->rowCount(QModelIndex())-1;
+    mDebugger->memoryModel()->fetchRows(firstRow, lastRow);
+}
+
 void MainWindow::onWatchViewContextMenu(const QPoint &pos)
 {
     QMenu menu(this);
@@ -3441,8 +3552,8 @@ void MainWindow::onProblemCaseIndexChanged(const QModelIndex &current, const QMo
     QModelIndex idx = current;
     if (previous.isValid()) {
         POJProblemCase problemCase = mOJProblemModel.getCase(previous.row());
-        problemCase->input = ui->txtProblemCaseInput->toPlainText();
-        problemCase->expected = ui->txtProblemCaseExpected->toPlainText();
+        problemCase->input.setText(ui->txtProblemCaseInput->toPlainText());
+        problemCase->expected.setText(ui->txtProblemCaseExpected->toPlainText());
     }
     if (idx.isValid()) {
         POJProblemCase problemCase = mOJProblemModel.getCase(idx.row());
@@ -3539,59 +3650,11 @@ void MainWindow::onProblemBatchSetCases()
     }
 }
 
-void MainWindow::onNewProblemConnection()
+void MainWindow::onNewProblemReceived(POJProblem problem)
 {
-    QTcpSocket* clientConnection = mTcpServer.nextPendingConnection();
-
-    connect(clientConnection, &QAbstractSocket::disconnected,
-            clientConnection, &QObject::deleteLater);
-    QByteArray content;
-    int unreadCount = 0;
-    while (clientConnection->state() == QTcpSocket::ConnectedState) {
-        clientConnection->waitForReadyRead(100);
-        QByteArray readed = clientConnection->readAll();
-        if (readed.isEmpty()) {
-            unreadCount ++;
-            if (!content.isEmpty() || unreadCount>30)
-                break;
-        } else {
-            unreadCount = 0;
-        }
-        content += readed;
-    }
-    content += clientConnection->readAll();
-    clientConnection->write("HTTP/1.1 200 OK");
-    clientConnection->disconnectFromHost();
-//    qDebug()<<"---------";
-//    qDebug()<<content;
-    content = getHTTPBody(content);
-//    qDebug()<<"*********";
-//    qDebug()<<content;
-    if (content.isEmpty()) {
-        return;
-    }
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(content,&error);
-    if (error.error!=QJsonParseError::NoError) {
-        qDebug()<<"Read http content failed!";
-        qDebug()<<error.errorString();
-        return;
-    }
-    QJsonObject obj=doc.object();
-    QString name = obj["name"].toString();
-    if (!mOJProblemSetModel.problemNameUsed(name)) {
-        POJProblem problem = std::make_shared<OJProblem>();
-        problem->name = name;
-        problem->url = obj["url"].toString();
-        QJsonArray caseArray = obj["tests"].toArray();
-        foreach ( const QJsonValue& val, caseArray) {
-            QJsonObject caseObj = val.toObject();
-            POJProblemCase problemCase = std::make_shared<OJProblemCase>();
-            problemCase->testState = ProblemCaseTestState::NotTested;
-            problemCase->name = tr("Problem Case %1").arg(problem->cases.count()+1);
-            problemCase->input = caseObj["input"].toString();
-            problemCase->expected = caseObj["output"].toString();
-            problem->cases.append(problemCase);
+    if (!mOJProblemSetModel.problemNameUsed(problem->name)) {
+        for (int i=0;i<problem->cases.count();i++) {
+            problem->cases[i]->name = tr("Problem Case %1").arg(i+1);
         }
         mOJProblemSetModel.addProblem(problem);
         ui->tabExplorer->setCurrentWidget(ui->tabProblemSet);
@@ -3605,6 +3668,16 @@ void MainWindow::onNewProblemConnection()
     }
 }
 
+void MainWindow::stopCompetitiveCompanionReceiver()
+{
+    if (mCompetitiveCompanionReceiver) {
+        mCompetitiveCompanionReceiver->quit();
+        mCompetitiveCompanionReceiver->wait();
+        delete mCompetitiveCompanionReceiver;
+        mCompetitiveCompanionReceiver = nullptr;
+    }
+}
+
 void MainWindow::updateProblemTitle()
 {
     ui->lblProblem->setText(mOJProblemModel.getTitle());
@@ -4544,6 +4617,12 @@ void MainWindow::on_EditorTabsRight_tabCloseRequested(int index)
     mEditorList->closeEditor(editor);
 }
 
+void MainWindow::onFileSystemVCSStatusChanged()
+{
+    //refresh icons in the files view
+    mFileSystemModel.setIconProvider(&mFileSystemModelIconProvider);
+}
+
 void MainWindow::onFileSystemModelLayoutChanged()
 {
     ui->treeFiles->scrollTo(ui->treeFiles->currentIndex(),QTreeView::PositionAtCenter);
@@ -4662,7 +4741,7 @@ void MainWindow::closeEvent(QCloseEvent *event) {
 //        }
 //    }
 
-    mTcpServer.close();
+    stopCompetitiveCompanionReceiver();
     mCompilerManager->stopAllRunners();
     mCompilerManager->stopCompile();
     mCompilerManager->stopRun();
@@ -4816,6 +4895,12 @@ void MainWindow::onCompileIssue(PCompileIssue issue)
     }
 }
 
+void MainWindow::onSyntaxCheckIssue(PCompileIssue issue)
+{
+    //applied together when the check is finished
+    mSyntaxCheckIssues.append(issue);
+}
+
 void MainWindow::clearToolsOutput()
 {
     ui->txtToolsOutput->clear();
@@ -4835,6 +4920,41 @@ void MainWindow::onCompileFinished(bool isCheckSyntax)
             mCompileSuccessionTask = nullptr;
         return;
     }
+    if (isCheckSyntax) {
+        if (mSyntaxCheckCanceled) {
+            mCheckSyntaxInBack=false;
+            mSyntaxCheckIssues.clear();
+            mCheckSyntaxTimer.start();
+            updateCompileActions();
+            return;
+        }
+        //only the issues of the checked file (and the files it reports on)
+        //are replaced, the marks of other editors are kept
+        QSet<QString> files;
+        files.insert(mSyntaxCheckingFile);
+        files.insert(QString());
+        foreach (const PCompileIssue& issue, mSyntaxCheckIssues) {
+            files.insert(issue->filename);
+        }
+        QList<Editor*> editors;
+        foreach (const QString& file, files) {
+            Editor* e = mEditorList->getOpenedEditorByFilename(file);
+            if (e && !editors.contains(e)) {
+                e->beginUpdateSyntaxIssues();
+                editors.append(e);
+            }
+        }
+        foreach (const QString& file, files) {
+            ui->tableIssues->removeIssues(file);
+        }
+        foreach (const PCompileIssue& issue, mSyntaxCheckIssues) {
+            onCompileIssue(issue);
+        }
+        mSyntaxCheckIssues.clear();
+        foreach (Editor* e, editors) {
+            e->endUpdateSyntaxIssues();
+        }
+    }
     // Update tab caption
     int i = ui->tabMessages->indexOf(ui->tabIssues);
     if (i!=-1) {
@@ -4868,9 +4988,11 @@ void MainWindow::onCompileFinished(bool isCheckSyntax)
         stretchMessagesPanel(true);
     }
 
-    Editor * e = mEditorList->getEditor();
-    if (e!=nullptr) {
-        e->invalidate();
+    if (!isCheckSyntax) {
+        Editor * e = mEditorList->getEditor();
+        if (e!=nullptr) {
+            e->invalidate();
+        }
     }
 
     if (!isCheckSyntax) {
@@ -4945,6 +5067,8 @@ void MainWindow::onCompileFinished(bool isCheckSyntax)
     } else {
         mCheckSyntaxInBack=false;
     }
+    if (!mSyntaxCheckQueue.isEmpty())
+        mCheckSyntaxTimer.start();
     updateCompileActions();
     updateAppTitle();
 }
@@ -5006,24 +5130,33 @@ void MainWindow::onOJProblemCaseFinished(const QString& id, int current, int tot
     if (row>=0) {
         POJProblemCase problemCase = mOJProblemModel.getCase(row);
         ProblemCaseValidator validator;
-        problemCase->testState = validator.validate(problemCase,pSettings->executor().ignoreSpacesWhenValidatingCases())?
+        problemCase->testState = (problemCase->verdict == ProblemCaseVerdict::None
+                                  && validator.validate(problemCase,
+                                                    pSettings->executor().ignoreSpacesWhenValidatingCases(),
+                                                    pSettings->executor().caseValidationFloatPrecision()))?
                     ProblemCaseTestState::Passed:
                     ProblemCaseTestState::Failed;
         mOJProblemModel.update(row);
-        updateProblemCaseOutput(problemCase);
+        if (isCurrentProblemCase(id))
+            updateProblemCaseOutput(problemCase);
     }
     ui->pbProblemCases->setMaximum(total);
     ui->pbProblemCases->setValue(current);
     updateProblemTitle();
 }
 
-void MainWindow::onOJProblemCaseNewOutputGetted(const QString &/* id */, const QString &line)
+void MainWindow::onOJProblemCaseNewOutputGetted(const QString &id, const QString &line)
 {
+    //cases may run concurrently, only show the output of the selected one
+    if (!isCurrentProblemCase(id))
+        return;
     ui->txtProblemCaseOutput->appendPlainText(line);
 }
 
-void MainWindow::onOJProblemCaseResetOutput(const QString &/* id */, const QString &line)
+void MainWindow::onOJProblemCaseResetOutput(const QString &id, const QString &line)
 {
+    if (!isCurrentProblemCase(id))
+        return;
     ui->txtProblemCaseOutput->setPlainText(line);
 }
 
@@ -5237,6 +5370,7 @@ void MainWindow::on_tabMessages_tabBarClicked(int index)
         stretchMessagesPanel(false);
     } else {
         stretchMessagesPanel(true);
+        mDebugger->refreshVisibleViews();
     }
 }
 
@@ -5384,6 +5518,29 @@ void MainWindow::on_actionView_CPU_Window_triggered()
     showCPUInfoDialog();
 }
 
+void MainWindow::on_actionRecord_Trace_triggered()
+{
+    if (mDebugger->traceRecording())
+        mDebugger->stopTraceRecording();
+    else
+        mDebugger->startTraceRecording();
+    ui->actionRecord_Trace->setChecked(mDebugger->traceRecording());
+}
+
+void MainWindow::onTraceSamplesChanged()
+{
+    if (!mTraceHeatMapTimer.isActive())
+        mTraceHeatMapTimer.start();
+}
+
+void MainWindow::onTraceHeatMapTimeout()
+{
+    for (int i=0;i<mEditorList->pageCount();i++) {
+        Editor* e= (*mEditorList)[i];
+        e->invalidateGutter();
+    }
+}
+
 void MainWindow::on_actionExit_triggered()
 {
     close();
@@ -5404,13 +5561,7 @@ void MainWindow::onDebugMemoryAddressInput()
 {
     QString s=ui->cbMemoryAddress->currentText().trimmed();
     if (!s.isEmpty()) {
-//        connect(mDebugger, &Debugger::memoryExamineReady,
-//                   this, &MainWindow::onMemoryExamineReady);
-        mDebugger->sendCommand("-data-read-memory",QString("%1 x 1 %2 %3 ")
-                               .arg(s)
-                               .arg(pSettings->debugger().memoryViewRows())
-                               .arg(pSettings->debugger().memoryViewColumns())
-                               );
+        mDebugger->examineMemory(s);
     }
 }
 
@@ -5467,6 +5618,8 @@ void MainWindow::onEvalValueReady(const QString& value)
 
 void MainWindow::onLocalsReady(const QStringList& value)
 {
+    if (ui->txtLocals->toPlainText() == value.join("\n"))
+        return;
     ui->txtLocals->clear();
     foreach (QString s, value) {
         ui->txtLocals->appendPlainText(s);
@@ -6400,7 +6553,7 @@ void MainWindow::fillProblemCaseInputAndExpected(const POJProblemCase &problemCa
         ui->txtProblemCaseInputFileName->setToolTip(problemCase->inputFileName);
     } else {
         ui->txtProblemCaseInput->setReadOnly(false);
-        ui->txtProblemCaseInput->setPlainText(problemCase->input);
+        ui->txtProblemCaseInput->setPlainText(problemCase->input.text());
         ui->btnProblemCaseClearInputFileName->setVisible(false);
         ui->txtProblemCaseInputFileName->clear();
         ui->txtProblemCaseInputFileName->setToolTip("");
@@ -6414,7 +6567,7 @@ void MainWindow::fillProblemCaseInputAndExpected(const POJProblemCase &problemCa
         ui->txtProblemCaseExpectedOutputFileName->setToolTip(problemCase->inputFileName);
     } else {
         ui->txtProblemCaseExpected->setReadOnly(false);
-        ui->txtProblemCaseExpected->setPlainText(problemCase->expected);
+        ui->txtProblemCaseExpected->setPlainText(problemCase->expected.text());
         ui->btnProblemCaseClearExpectedOutputFileName->setVisible(false);
         ui->txtProblemCaseExpectedOutputFileName->clear();
         ui->txtProblemCaseExpectedOutputFileName->setToolTip("");
@@ -6823,6 +6976,15 @@ void MainWindow::doCompileRun(RunType runType)
     compile();
 }
 
+bool MainWindow::isCurrentProblemCase(const QString &caseId)
+{
+    QModelIndex idx = ui->tblProblemCases->currentIndex();
+    if (!idx.isValid())
+        return false;
+    POJProblemCase problemCase = mOJProblemModel.getCase(idx.row());
+    return problemCase && problemCase->getId() == caseId;
+}
+
 void MainWindow::updateProblemCaseOutput(POJProblemCase problemCase)
 {
     if (problemCase->testState == ProblemCaseTestState::Failed) {
@@ -6864,8 +7026,8 @@ void MainWindow::applyCurrentProblemCaseChanges()
         POJProblemCase problemCase = mOJProblemModel.getCase(idx.row());
         if (problemCase) {
             if (!fileExists(problemCase->inputFileName))
-                problemCase->input = ui->txtProblemCaseInput->toPlainText();
-            problemCase->expected = ui->txtProblemCaseExpected->toPlainText();
+                problemCase->input.setText(ui->txtProblemCaseInput->toPlainText());
+            problemCase->expected.setText(ui->txtProblemCaseExpected->toPlainText());
         }
     }
 }
@@ -21,7 +21,6 @@
 #include <QMainWindow>
 #include <QTimer>
 #include <QFileSystemModel>
-#include <QTcpServer>
 #include <QElapsedTimer>
 #include <QSortFilterProxyModel>
 #include "common.h"
@@ -38,6 +37,7 @@
 #include "widgets/labelwithmenu.h"
 #include "widgets/bookmarkmodel.h"
 #include "widgets/ojproblemsetmodel.h"
+#include "problems/competitivecompanionreceiver.h"
 #include "widgets/customfilesystemmodel.h"
 #include "customfileiconprovider.h"
 
@@ -157,6 +157,10 @@ public:
 
     QPlainTextEdit* txtLocals();
 
+    bool isLocalsViewVisible() const;
+    bool isMemoryViewVisible() const;
+    bool isStackTraceViewVisible() const;
+
     QMenuBar* menuBar() const;
 
     CPUDialog *cpuDialog() const;
@@ -205,6 +209,7 @@ public:
 public slots:
     void logToolsOutput(const QString& msg);
     void onCompileIssue(PCompileIssue issue);
+    void onSyntaxCheckIssue(PCompileIssue issue);
     void clearToolsOutput();
     void onCompileStarted();
     void onCompileFinished(bool isCheckSyntax);
@@ -264,6 +269,8 @@ private:
     void clearIssues();
     void doCompileRun(RunType runType);
     void updateProblemCaseOutput(POJProblemCase problemCase);
+    void stopCompetitiveCompanionReceiver();
+    bool isCurrentProblemCase(const QString& caseId);
     void applyCurrentProblemCaseChanges();
     void showHideInfosTab(QWidget *widget, bool show);
     void showHideMessagesTab(QWidget *widget, bool show);
@@ -285,9 +292,14 @@ private slots:
     void invalidateProjectProxyModel();
     void onEditorRenamed(const QString& oldFilename, const QString& newFilename, bool firstSave);
     void onAutoSaveTimeout();
+    void onCheckSyntaxTimeout();
+    void onTraceSamplesChanged();
+    void onTraceHeatMapTimeout();
     void onFileChanged(const QString& path);
     void onFilesViewPathChanged();
     void onWatchViewContextMenu(const QPoint& pos);
+    void loadVisibleWatchVarChildren();
+    void loadVisibleMemoryPages();
     void onBookmarkContextMenu(const QPoint& pos);
     void onTableIssuesContextMenu(const QPoint& pos);
     void onSearchViewContextMenu(const QPoint& pos);
@@ -306,7 +318,7 @@ private slots:
     void onProblemNameChanged(int index);
     void onProblemRunCurrentCase();
     void onProblemBatchSetCases();
-    void onNewProblemConnection();
+    void onNewProblemReceived(POJProblem problem);
     void updateProblemTitle();
     void onEditorClosed();
     void onToolsOutputClear();
@@ -360,6 +372,7 @@ private slots:
     void on_EditorTabsRight_tabCloseRequested(int index);
 
     void onFileSystemModelLayoutChanged();
+    void onFileSystemVCSStatusChanged();
 
     void on_actionOpen_triggered();
 
@@ -434,6 +447,8 @@ private slots:
 
     void on_actionView_CPU_Window_triggered();
 
+    void on_actionRecord_Trace_triggered();
+
     void on_actionExit_triggered();
 
     void on_actionFind_triggered();
@@ -756,6 +771,11 @@ private:
     int mOJProblemSetNameCounter;
 
     bool mCheckSyntaxInBack;
+    QTimer mCheckSyntaxTimer; // debounce background syntax checks
+    QStringList mSyntaxCheckQueue; // files waiting for background syntax check
+    QString mSyntaxCheckingFile;
+    bool mSyntaxCheckCanceled;
+    QVector<PCompileIssue> mSyntaxCheckIssues;
     bool mShouldRemoveAllSettings;
     PCompileSuccessionTask mCompileSuccessionTask;
 
@@ -763,6 +783,7 @@ private:
     QMap<QWidget*, PTabWidgetInfo> mTabMessagesData;
 
     QTimer mAutoSaveTimer;
+    QTimer mTraceHeatMapTimer; // throttle repainting of the trace heat map
 
     CaretList mCaretList;
 
@@ -771,7 +792,7 @@ private:
     bool mOpenningFiles;
     bool mSystemTurnedOff;
     QPoint mEditorContextMenuPos;
-    QTcpServer mTcpServer;
+    CompetitiveCompanionReceiver* mCompetitiveCompanionReceiver;
     QColor mErrorColor;
 
     QSet<QString> mFilesChangedNotifying;
@@ -965,6 +965,20 @@ bool CppParser::isFileParsed(const QString &filename)
     return mPreprocessor.scannedFiles().contains(filename);
 }
 
+bool CppParser::findIdentifierPositions(const QString &fileName, const QString &identifier, QVector<IdentifierPosition> &positions)
+{
+    QMutexLocker locker(&mMutex);
+    positions.clear();
+    if (!mPreprocessor.scannedFiles().contains(fileName))
+        return false;
+    PFileIncludes fileIncludes = mPreprocessor.includesList().value(fileName);
+    //system headers are not indexed
+    if (!fileIncludes || fileIncludes->identifiers.isEmpty())
+        return false;
+    positions = fileIncludes->identifiers.value(identifier);
+    return true;
+}
+
 QString CppParser::getScopePrefix(const PStatement& statement){
     switch (statement->classScope) {
     case StatementClassScope::scsPublic:
@@ -113,6 +113,10 @@ public:
     QSet<QString> scannedFiles();
 
     bool isFileParsed(const QString& filename);
+    //where the identifier appears in the file (as of its last parse)
+    //returns false if the file isn't indexed
+    bool findIdentifierPositions(const QString& fileName, const QString& identifier,
+                                 QVector<IdentifierPosition>& positions);
 
     QString prettyPrintStatement(const PStatement& statement, const QString& filename, int line = -1);
 
@@ -756,6 +756,9 @@ void CppPreprocessor::openInclude(const QString &fileName, QStringList bufferedT
             } else {
                 parsedFile->buffer = readFileToLines(fileName);
             }
+            //done before comments are removed, to keep the columns
+            if (!isSystemFile)
+                mCurrentIncludes->identifiers = indexIdentifiers(parsedFile->buffer);
         }
     } else {
         //add defines of already parsed including headers;
@@ -1125,6 +1128,85 @@ QStringList CppPreprocessor::removeComments(const QStringList &text)
     return result;
 }
 
+IdentifierPositions CppPreprocessor::indexIdentifiers(const QStringList &text)
+{
+    IdentifierPositions result;
+    ContentType currentType = ContentType::Other;
+    QString delimiter;
+    for (int i=0;i<text.length();i++) {
+        const QString& line = text[i];
+        int pos = 0;
+        while (pos<line.length()) {
+            QChar ch = line[pos];
+            switch (currentType) {
+            case ContentType::AnsiCComment:
+                if (ch=='*' && pos+1<line.length() && line[pos+1]=='/') {
+                    currentType = ContentType::Other;
+                    pos++;
+                }
+                pos++;
+                continue;
+            case ContentType::String:
+            case ContentType::Character:
+                if (ch=='\\')
+                    pos++;
+                else if ((ch=='"' && currentType == ContentType::String)
+                         || (ch=='\'' && currentType == ContentType::Character))
+                    currentType = ContentType::Other;
+                pos++;
+                continue;
+            case ContentType::RawString:
+                if (ch==')' && line.midRef(pos+1).startsWith(delimiter+'"')) {
+                    currentType = ContentType::Other;
+                    pos+=delimiter.length()+1;
+                }
+                pos++;
+                continue;
+            default:
+                break;
+            }
+            if (ch=='/' && pos+1<line.length() && line[pos+1]=='/') {
+                break;
+            } else if (ch=='/' && pos+1<line.length() && line[pos+1]=='*') {
+                currentType = ContentType::AnsiCComment;
+                pos+=2;
+            } else if (ch=='"') {
+                currentType = ContentType::String;
+                pos++;
+            } else if (ch=='\'') {
+                currentType = ContentType::Character;
+                pos++;
+            } else if (ch>='0' && ch<='9') {
+                //numbers like 1e10 or 0xff aren't identifiers
+                while (pos<line.length() && (isWordChar(line[pos]) || line[pos]=='.' || line[pos]=='\''))
+                    pos++;
+            } else if (isWordChar(ch)) {
+                int start = pos;
+                while (pos<line.length() && isWordChar(line[pos]))
+                    pos++;
+                //raw string literals, with optional encoding prefixes like u8R"(...)"
+                if (pos<line.length() && line[pos]=='"' && line[pos-1]=='R'
+                        && QStringList({"R","LR","uR","UR","u8R"}).contains(line.mid(start,pos-start))) {
+                    int parenthesis = line.indexOf('(',pos+1);
+                    if (parenthesis>0) {
+                        delimiter = line.mid(pos+1,parenthesis-pos-1);
+                        currentType = ContentType::RawString;
+                        pos = parenthesis+1;
+                        continue;
+                    }
+                }
+                result[line.mid(start,pos-start)].append(IdentifierPosition{i+1,start+1});
+            } else {
+                pos++;
+            }
+        }
+        //unterminated literals end at the line end
+        if (currentType == ContentType::String || currentType == ContentType::Character)
+            currentType = ContentType::Other;
+    }
+    return result;
+}
+
 void CppPreprocessor::preprocessBuffer()
 {
     while (mIncludes.count() > 0) {
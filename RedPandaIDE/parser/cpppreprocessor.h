@@ -129,6 +129,8 @@ private:
     QList<PDefineArgToken> tokenizeValue(const QString& value);
 
     QStringList removeComments(const QStringList& text);
+    //positions of the identifiers in the text, comments and literals are skipped
+    IdentifierPositions indexIdentifiers(const QStringList& text);
     /*
      * '_','a'..'z','A'..'Z','0'..'9'
      */
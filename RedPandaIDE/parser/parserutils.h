@@ -16,6 +16,7 @@
  */
 #ifndef PARSER_UTILS_H
 #define PARSER_UTILS_H
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QSet>
@@ -227,6 +228,14 @@ private:
     QVector<PCppScope> mScopes;
 };
 
+//where an identifier appears in a file
+struct IdentifierPosition {
+    int line; // starts from 1
+    int column; // starts from 1
+};
+
+using IdentifierPositions = QHash<QString, QVector<IdentifierPosition>>;
+
 struct FileIncludes {
     QString baseFile;
     QMap<QString, bool> includeFiles; // true means the file is directly included, false means included indirectly
@@ -237,6 +246,7 @@ struct FileIncludes {
     CppScopes scopes; // int is start line of the statement scope
     QSet<QString> dependingFiles; // The files I depeneds on
     QSet<QString> dependedFiles; // the files depends on me
+    IdentifierPositions identifiers; // identifiers in the file (not system headers), to find references
 };
 using PFileIncludes = std::shared_ptr<FileIncludes>;
 
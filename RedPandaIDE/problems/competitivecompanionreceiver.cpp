@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "competitivecompanionreceiver.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+
+HTTPRequestParser::HTTPRequestParser(qint64 maxBodySize):
+    mState(State::RequestLine),
+    mMaxBodySize(maxBodySize),
+    mContentLength(0),
+    mChunked(false),
+    mRemaining(0),
+    mHeaderSize(0),
+    mErrorCode(0)
+{
+
+}
+
+void HTTPRequestParser::feed(const QByteArray &data)
+{
+    if (mState == State::Finished || mState == State::Error)
+        return;
+    mBuffer.append(data);
+    int pos = 0;
+    while (mState != State::Finished && mState != State::Error) {
+        if (mState == State::Body || mState == State::ChunkData) {
+            qint64 len = std::min<qint64>(mRemaining, mBuffer.length()-pos);
+            if (len<=0)
+                break;
+            mBody.append(mBuffer.constData()+pos, len);
+            pos += len;
+            mRemaining -= len;
+            if (mRemaining==0)
+                mState = (mState == State::Body)?State::Finished:State::ChunkEnd;
+        } else {
+            int end = mBuffer.indexOf('\n',pos);
+            if (end<0) {
+                if (mBuffer.length()-pos > HTTP_MAX_HEADER_SIZE)
+                    setError(431, "Request Header Fields Too Large");
+                break;
+            }
+            QByteArray line = mBuffer.mid(pos,end-pos);
+            if (line.endsWith('\r'))
+                line.chop(1);
+            pos = end+1;
+            processLine(line);
+        }
+    }
+    mBuffer.remove(0,pos);
+}
+
+HTTPRequestParser::State HTTPRequestParser::state() const
+{
+    return mState;
+}
+
+int HTTPRequestParser::errorCode() const
+{
+    return mErrorCode;
+}
+
+const QByteArray &HTTPRequestParser::errorReason() const
+{
+    return mErrorReason;
+}
+
+const QByteArray &HTTPRequestParser::method() const
+{
+    return mMethod;
+}
+
+const QByteArray &HTTPRequestParser::target() const
+{
+    return mTarget;
+}
+
+const QByteArray &HTTPRequestParser::body() const
+{
+    return mBody;
+}
+
+void HTTPRequestParser::processLine(const QByteArray &line)
+{
+    if (mState != State::ChunkSize && mState != State::ChunkEnd) {
+        mHeaderSize += line.length();
+        if (mHeaderSize > HTTP_MAX_HEADER_SIZE) {
+            setError(431, "Request Header Fields Too Large");
+            return;
+        }
+    }
+    switch (mState) {
+    case State::RequestLine: {
+        //empty lines before the request line are ignored
+        if (line.isEmpty())
+            return;
+        QList<QByteArray> parts = line.split(' ');
+        if (parts.length()!=3) {
+            setError(400, "Bad Request");
+            return;
+        }
+        if (!parts[2].startsWith("HTTP/1.")) {
+            setError(505, "HTTP Version Not Supported");
+            return;
+        }
+        mMethod = parts[0];
+        mTarget = parts[1];
+        if (mMethod != "POST") {
+            setError(405, "Method Not Allowed");
+            return;
+        }
+        mState = State::Headers;
+        break;
+    }
+    case State::Headers:
+        if (!line.isEmpty()) {
+            processHeader(line);
+        } else if (mChunked) {
+            mState = State::ChunkSize;
+        } else if (mContentLength>0) {
+            mRemaining = mContentLength;
+            mBody.reserve(mContentLength);
+            mState = State::Body;
+        } else {
+            mState = State::Finished;
+        }
+        break;
+    case State::ChunkSize: {
+        int i = line.indexOf(';');
+        QByteArray sizeText = (i>=0)?line.left(i).trimmed():line.trimmed();
+        bool ok;
+        qint64 size = sizeText.toLongLong(&ok,16);
+        if (!ok || size<0) {
+            setError(400, "Bad Request");
+        } else if (size == 0) {
+            mState = State::Trailers;
+        } else if (mBody.length()+size > mMaxBodySize) {
+            setError(413, "Payload Too Large");
+        } else {
+            mRemaining = size;
+            mState = State::ChunkData;
+        }
+        break;
+    }
+    case State::ChunkEnd:
+        if (!line.isEmpty())
+            setError(400, "Bad Request");
+        else
+            mState = State::ChunkSize;
+        break;
+    case State::Trailers:
+        if (line.isEmpty())
+            mState = State::Finished;
+        break;
+    default:
+        break;
+    }
+}
+
+void HTTPRequestParser::processHeader(const QByteArray &line)
+{
+    int i = line.indexOf(':');
+    if (i<=0) {
+        setError(400, "Bad Request");
+        return;
+    }
+    QByteArray name = line.left(i).trimmed().toLower();
+    QByteArray value = line.mid(i+1).trimmed();
+    if (name == "content-length") {
+        bool ok;
+        mContentLength = value.toLongLong(&ok);
+        if (!ok || mContentLength<0)
+            setError(400, "Bad Request");
+        else if (mContentLength > mMaxBodySize)
+            setError(413, "Payload Too Large");
+    } else if (name == "transfer-encoding") {
+        mChunked = value.toLower().contains("chunked");
+    }
+}
+
+void HTTPRequestParser::setError(int code, const QByteArray &reason)
+{
+    mState = State::Error;
+    mErrorCode = code;
+    mErrorReason = reason;
+    mBuffer.clear();
+    mBody.clear();
+}
+
+CompetitiveCompanionReceiver::CompetitiveCompanionReceiver(int port, QObject *parent):
+    QThread(parent),
+    mPort(port),
+    mMaxRequestSize(COMPETITIVE_COMPANION_MAX_REQUEST_SIZE),
+    mRequestTimeout(COMPETITIVE_COMPANION_REQUEST_TIMEOUT)
+{
+
+}
+
+int CompetitiveCompanionReceiver::port() const
+{
+    return mPort;
+}
+
+qint64 CompetitiveCompanionReceiver::maxRequestSize() const
+{
+    return mMaxRequestSize;
+}
+
+void CompetitiveCompanionReceiver::setMaxRequestSize(qint64 newMaxRequestSize)
+{
+    mMaxRequestSize = newMaxRequestSize;
+}
+
+int CompetitiveCompanionReceiver::requestTimeout() const
+{
+    return mRequestTimeout;
+}
+
+void CompetitiveCompanionReceiver::setRequestTimeout(int newRequestTimeout)
+{
+    mRequestTimeout = newRequestTimeout;
+}
+
+void CompetitiveCompanionReceiver::handleConnection(QTcpSocket *socket)
+{
+    std::shared_ptr<HTTPRequestParser> parser = std::make_shared<HTTPRequestParser>(mMaxRequestSize);
+    QTimer* timer = new QTimer(socket);
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, socket, [socket](){
+        reply(socket, 408, "Request Timeout");
+    });
+    connect(socket, &QAbstractSocket::disconnected,
+            socket, &QObject::deleteLater);
+    connect(socket, &QIODevice::readyRead, socket, [this,socket,parser,timer](){
+        QByteArray data = socket->readAll();
+        //the request is already replied
+        if (socket->state() != QAbstractSocket::ConnectedState
+                || parser->state() == HTTPRequestParser::State::Finished
+                || parser->state() == HTTPRequestParser::State::Error)
+            return;
+        parser->feed(data);
+        if (parser->state() == HTTPRequestParser::State::Error) {
+            timer->stop();
+            reply(socket, parser->errorCode(), parser->errorReason());
+        } else if (parser->state() == HTTPRequestParser::State::Finished) {
+            timer->stop();
+            POJProblem problem = parseProblem(parser->body());
+            if (problem) {
+                reply(socket, 200, "OK");
+                emit problemReceived(problem);
+            } else {
+                reply(socket, 400, "Bad Request");
+            }
+        }
+    });
+    timer->start(mRequestTimeout);
+}
+
+void CompetitiveCompanionReceiver::reply(QTcpSocket *socket, int code, const QByteArray &reason)
+{
+    socket->write(QString("HTTP/1.1 %1 ").arg(code).toLatin1()
+                  + reason
+                  + "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    socket->disconnectFromHost();
+}
+
+POJProblem CompetitiveCompanionReceiver::parseProblem(const QByteArray &content)
+{
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(content,&error);
+    if (error.error!=QJsonParseError::NoError) {
+        qDebug()<<"Read http content failed!";
+        qDebug()<<error.errorString();
+        return POJProblem();
+    }
+    QJsonObject obj=doc.object();
+    if (!doc.isObject() || !obj["tests"].isArray()) {
+        qDebug()<<"The http content is not a problem!";
+        return POJProblem();
+    }
+    POJProblem problem = std::make_shared<OJProblem>();
+    problem->name = obj["name"].toString();
+    problem->url = obj["url"].toString();
+    QJsonArray caseArray = obj["tests"].toArray();
+    foreach ( const QJsonValue& val, caseArray) {
+        QJsonObject caseObj = val.toObject();
+        POJProblemCase problemCase = std::make_shared<OJProblemCase>();
+        problemCase->testState = ProblemCaseTestState::NotTested;
+        problemCase->input.setText(caseObj["input"].toString());
+        problemCase->expected.setText(caseObj["output"].toString());
+        problem->cases.append(problemCase);
+    }
+    return problem;
+}
+
+void CompetitiveCompanionReceiver::run()
+{
+    QTcpServer server;
+    if (!server.listen(QHostAddress::LocalHost, mPort))
+        return;
+    connect(&server, &QTcpServer::newConnection, &server, [this,&server](){
+        while (server.hasPendingConnections())
+            handleConnection(server.nextPendingConnection());
+    });
+    exec();
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef COMPETITIVECOMPANIONRECEIVER_H
+#define COMPETITIVECOMPANIONRECEIVER_H
+
+#include <QThread>
+#include <QByteArray>
+#include "ojproblemset.h"
+
+#define COMPETITIVE_COMPANION_MAX_REQUEST_SIZE (64*1024*1024)
+//time (in milliseconds) a client has to send the whole request
+#define COMPETITIVE_COMPANION_REQUEST_TIMEOUT 10000
+#define HTTP_MAX_HEADER_SIZE (64*1024)
+
+class QTcpSocket;
+
+/**
+ * @brief Incremental parser for HTTP/1.1 POST requests.
+ *
+ * Data is fed as it arrives. Bodies may be sent with Content-Length or
+ * with chunked transfer encoding.
+ */
+class HTTPRequestParser {
+public:
+    enum class State {
+        RequestLine,
+        Headers,
+        Body,
+        ChunkSize,
+        ChunkData,
+        ChunkEnd,
+        Trailers,
+        Finished,
+        Error
+    };
+    explicit HTTPRequestParser(qint64 maxBodySize);
+    void feed(const QByteArray& data);
+    State state() const;
+    //the status code and reason phrase to reply when the request is malformed
+    int errorCode() const;
+    const QByteArray& errorReason() const;
+    const QByteArray& method() const;
+    const QByteArray& target() const;
+    const QByteArray& body() const;
+private:
+    void processLine(const QByteArray& line);
+    void processHeader(const QByteArray& line);
+    void setError(int code, const QByteArray& reason);
+private:
+    State mState;
+    qint64 mMaxBodySize;
+    QByteArray mBuffer;
+    QByteArray mMethod;
+    QByteArray mTarget;
+    QByteArray mBody;
+    qint64 mContentLength;
+    bool mChunked;
+    qint64 mRemaining;
+    int mHeaderSize;
+    int mErrorCode;
+    QByteArray mErrorReason;
+};
+
+/**
+ * @brief Receives problems sent by the Competitive Companion browser extension.
+ *
+ * The receiver listens on the local host in its own thread. Requests are parsed
+ * as their data arrives, and clients that are too slow or send too much are
+ * dropped, so the ui never waits for them.
+ */
+class CompetitiveCompanionReceiver : public QThread
+{
+    Q_OBJECT
+public:
+    explicit CompetitiveCompanionReceiver(int port, QObject *parent = nullptr);
+    int port() const;
+    qint64 maxRequestSize() const;
+    void setMaxRequestSize(qint64 newMaxRequestSize);
+    int requestTimeout() const;
+    void setRequestTimeout(int newRequestTimeout);
+signals:
+    void problemReceived(POJProblem problem);
+private:
+    void handleConnection(QTcpSocket* socket);
+    static void reply(QTcpSocket* socket, int code, const QByteArray& reason);
+    static POJProblem parseProblem(const QByteArray& content);
+private:
+    int mPort;
+    qint64 mMaxRequestSize;
+    int mRequestTimeout;
+
+    // QThread interface
+protected:
+    void run() override;
+};
+
+#endif // COMPETITIVECOMPANIONRECEIVER_H
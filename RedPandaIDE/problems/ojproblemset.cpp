@@ -15,10 +15,17 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "ojproblemset.h"
+#include "../utils.h"
 
 #include <QUuid>
 
-OJProblemCase::OJProblemCase()
+OJProblemCase::OJProblemCase():
+    testState(ProblemCaseTestState::NotTested),
+    runningTime(0),
+    cpuTime(-1),
+    peakMemory(-1),
+    exitCode(0),
+    verdict(ProblemCaseVerdict::None)
 {
     QUuid uid = QUuid::createUuid();
     id = uid.toString();
@@ -28,3 +35,88 @@ const QString &OJProblemCase::getId() const
 {
     return id;
 }
+
+OJProblemCaseData::OJProblemCaseData():
+    mSize(0),
+    mLoaded(true)
+{
+
+}
+
+QString OJProblemCaseData::text()
+{
+    QMutexLocker locker(&mMutex);
+    if (!mLoaded) {
+        mText = QString::fromUtf8(readFileToByteArray(mDataFile));
+        mLoaded = true;
+    }
+    return mText;
+}
+
+void OJProblemCaseData::setText(const QString &newText)
+{
+    QMutexLocker locker(&mMutex);
+    //unchanged texts keep their data files, so they are not saved again
+    if (mLoaded && newText == mText)
+        return;
+    mText = newText;
+    mLoaded = true;
+    mDataFile.clear();
+    mHash.clear();
+    mSize = 0;
+    mPreview.clear();
+}
+
+bool OJProblemCaseData::isEmpty() const
+{
+    QMutexLocker locker(&mMutex);
+    if (!mLoaded)
+        return mSize==0;
+    return mText.isEmpty();
+}
+
+QString OJProblemCaseData::pendingDataFile() const
+{
+    QMutexLocker locker(&mMutex);
+    if (mLoaded)
+        return QString();
+    return mDataFile;
+}
+
+void OJProblemCaseData::setDataFile(const QString &fileName, const QString &hash, qint64 size, const QString &preview)
+{
+    QMutexLocker locker(&mMutex);
+    //the loaded text is kept
+    if (mDataFile.isEmpty() && mText.isEmpty())
+        mLoaded = false;
+    mDataFile = fileName;
+    mHash = hash;
+    mSize = size;
+    mPreview = preview;
+}
+
+QString OJProblemCaseData::dataFile() const
+{
+    QMutexLocker locker(&mMutex);
+    return mDataFile;
+}
+
+QString OJProblemCaseData::hash() const
+{
+    QMutexLocker locker(&mMutex);
+    return mHash;
+}
+
+qint64 OJProblemCaseData::size() const
+{
+    QMutexLocker locker(&mMutex);
+    return mSize;
+}
+
+QString OJProblemCaseData::preview() const
+{
+    QMutexLocker locker(&mMutex);
+    if (!mDataFile.isEmpty())
+        return mPreview;
+    return mText.left(OJ_CASE_DATA_PREVIEW_LENGTH);
+}
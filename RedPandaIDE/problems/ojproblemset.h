@@ -19,6 +19,10 @@
 #include <QString>
 #include <memory>
 #include <QVector>
+#include <QMetaType>
+#include <QMutex>
+
+class QTemporaryFile;
 
 enum class ProblemCaseTestState {
     NotTested,
@@ -27,15 +31,66 @@ enum class ProblemCaseTestState {
     Failed
 };
 
+//how the program ended when running a case
+enum class ProblemCaseVerdict {
+    None,
+    TimeLimitExceeded,
+    MemoryLimitExceeded,
+    RuntimeError
+};
+
+//chars of case data shown in previews
+#define OJ_CASE_DATA_PREVIEW_LENGTH 200
+//case data with more chars are saved in data files
+#define OJ_CASE_DATA_SPILL_SIZE (64*1024)
+//bytes of a case's output kept in memory and shown, the rest is only in its output file
+#define OJ_CASE_OUTPUT_SHOWN_SIZE (1024*1024)
+
+/**
+ * @brief Input or expected output of a problem case.
+ *
+ * Big data of saved problem sets are kept in content addressed data files
+ * (named by the sha1 of their utf-8 content), and only read when used.
+ * Cases are run in other threads while the ui shows and saves them, so the
+ * lazy load and the data file are guarded by a mutex.
+ */
+class OJProblemCaseData {
+public:
+    OJProblemCaseData();
+    QString text();
+    void setText(const QString& newText);
+    bool isEmpty() const;
+    //the data file the text is not read from yet, empty if the text is in memory
+    QString pendingDataFile() const;
+    void setDataFile(const QString& fileName, const QString& hash, qint64 size, const QString& preview);
+    QString dataFile() const;
+    QString hash() const;
+    qint64 size() const;
+    QString preview() const;
+private:
+    QString mText;
+    QString mDataFile;
+    QString mHash;
+    qint64 mSize;
+    QString mPreview;
+    bool mLoaded;
+    mutable QMutex mMutex;
+};
+
 struct OJProblemCase {
     QString name;
-    QString input;
-    QString expected;
+    OJProblemCaseData input;
+    OJProblemCaseData expected;
     QString inputFileName;
     QString expectedOutputFileName;
     ProblemCaseTestState testState; // no persistence
-    QString output; // no persistence
+    QString output; // no persistence, at most OJ_CASE_OUTPUT_SHOWN_SIZE bytes of it
+    std::shared_ptr<QTemporaryFile> outputFile; // no persistence, the whole output
     int runningTime;
+    int cpuTime;
+    int peakMemory; // in KB, -1 if not measured
+    int exitCode;
+    ProblemCaseVerdict verdict; // no persistence
     int firstDiffLine;
     int outputLineCounts;
     int expectedLineCounts;
@@ -59,6 +114,7 @@ struct OJProblem {
 };
 
 using POJProblem = std::shared_ptr<OJProblem>;
+Q_DECLARE_METATYPE(POJProblem);
 
 struct OJProblemSet {
     QString name;
@@ -16,67 +16,293 @@
  */
 #include "problemcasevalidator.h"
 #include "../utils.h"
+#include <QFile>
+#include <QTemporaryFile>
+#include <QTextCodec>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 
-ProblemCaseValidator::ProblemCaseValidator()
+#define CASE_TEXT_CHUNK_SIZE 65536
+
+namespace {
+/*
+ * Reads a text file or string char by char.
+ * "\r\n" is read as '\n', and a line break is added after the last line if
+ * it doesn't have one, so the lines are the same as the ones of textToLines().
+ *
+ * Outputs are decoded from local 8bit when read from the program, so files
+ * are decoded like readFileToLines() does: with the locale codec, or UTF-8
+ * if they are not valid in it.
+ */
+class CaseTextStream {
+public:
+    CaseTextStream():
+        mMapped(nullptr),
+        mMappedPos(0),
+        mTextSent(false),
+        mText(nullptr),
+        mPos(nullptr),
+        mEnd(nullptr),
+        mLastChar(-1),
+        mPeeked(NoChar),
+        mLines(0) {
+    }
+    ~CaseTextStream() {
+        if (mMapped)
+            mFile.unmap(mMapped);
+    }
+    //files are decoded like readFileToLines() if codec is null
+    bool openFile(const QString& fileName, QTextCodec* codec = nullptr) {
+        mFile.setFileName(fileName);
+        if (!mFile.open(QFile::ReadOnly))
+            return false;
+        if (mFile.size()>0)
+            mMapped = mFile.map(0,mFile.size());
+        if (!codec) {
+            codec = QTextCodec::codecForLocale();
+            if (!isValidIn(codec)) {
+                QTextCodec* utf8Codec = QTextCodec::codecForName("UTF-8");
+                if (isValidIn(utf8Codec))
+                    codec = utf8Codec;
+            }
+        }
+        mDecoder.reset(codec->makeDecoder());
+        return true;
+    }
+    void setText(const QString& text) {
+        //the string is read in place
+        mText = &text;
+    }
+    int get() {
+        if (mPeeked!=NoChar) {
+            int ch = mPeeked;
+            mPeeked = NoChar;
+            return ch;
+        }
+        int ch = getRaw();
+        if (ch=='\r' && peekRaw()=='\n')
+            ch = getRaw();
+        if (ch<0 && mLastChar>=0 && mLastChar!='\n')
+            ch = '\n';
+        mLastChar = ch;
+        if (ch=='\n')
+            mLines++;
+        return ch;
+    }
+    int peek() {
+        if (mPeeked==NoChar)
+            mPeeked = get();
+        return mPeeked;
+    }
+    //reads to the end, and returns the number of lines
+    int lineCount() {
+        mPeeked = NoChar;
+        while (mPos<mEnd || fill()) {
+            mLines += std::count(mPos,mEnd,QChar('\n'));
+            mLastChar = (mEnd-1)->unicode();
+            mPos = mEnd;
+        }
+        if (mLastChar>=0 && mLastChar!='\n') {
+            mLines++;
+            mLastChar = '\n';
+        }
+        return mLines;
+    }
+private:
+    int getRaw() {
+        if (mPos>=mEnd && !fill())
+            return -1;
+        return (mPos++)->unicode();
+    }
+    int peekRaw() {
+        if (mPos>=mEnd && !fill())
+            return -1;
+        return mPos->unicode();
+    }
+    //the next chunk of the file's bytes
+    bool readBytes(const char*& data, int& len) {
+        if (mMapped) {
+            len = (int)std::min((qint64)CASE_TEXT_CHUNK_SIZE, mFile.size()-mMappedPos);
+            data = (const char*)mMapped + mMappedPos;
+            mMappedPos += len;
+        } else {
+            mBytes = mFile.read(CASE_TEXT_CHUNK_SIZE);
+            len = mBytes.length();
+            data = mBytes.constData();
+        }
+        return len>0;
+    }
+    bool isValidIn(QTextCodec* codec) {
+        if (!codec)
+            return false;
+        QTextCodec::ConverterState state;
+        const char* data;
+        int len;
+        bool valid = true;
+        while (valid && readBytes(data,len)) {
+            codec->toUnicode(data,len,&state);
+            valid = (state.invalidChars==0);
+        }
+        mMappedPos = 0;
+        if (!mMapped)
+            mFile.seek(0);
+        return valid;
+    }
+    bool fill() {
+        if (mText) {
+            if (mTextSent)
+                return false;
+            mTextSent = true;
+            mPos = mText->constData();
+            mEnd = mPos + mText->length();
+            return mPos<mEnd;
+        }
+        const char* data;
+        int len;
+        if (!mDecoder || !readBytes(data,len))
+            return false;
+        mBuffer = mDecoder->toUnicode(data,len);
+        mPos = mBuffer.constData();
+        mEnd = mPos + mBuffer.length();
+        //a decoder may hold back a partial character
+        return mPos<mEnd || fill();
+    }
+private:
+    static const int NoChar = -2;
+    QFile mFile;
+    uchar* mMapped;
+    qint64 mMappedPos;
+    QByteArray mBytes;
+    std::unique_ptr<QTextDecoder> mDecoder;
+    bool mTextSent;
+    const QString* mText;
+    QString mBuffer;
+    const QChar* mPos;
+    const QChar* mEnd;
+    int mLastChar;
+    int mPeeked;
+    int mLines;
+};
+
+//the same spaces as QString::simplified() and textToLines() ignore
+bool isBlank(int ch)
 {
+    return ch>=0 && ch!='\n' && QChar::isSpace((uint)ch);
+}
 
+//reads the next token of the current line, returns false at the end of the line
+bool nextToken(CaseTextStream& stream, QString& token)
+{
+    //keeps the buffer for the next token
+    token.truncate(0);
+    while (isBlank(stream.peek()))
+        stream.get();
+    int ch = stream.peek();
+    while (ch>=0 && ch!='\n' && !isBlank(ch)) {
+        token.append(QChar(stream.get()));
+        ch = stream.peek();
+    }
+    return !token.isEmpty();
 }
 
-bool ProblemCaseValidator::validate(POJProblemCase problemCase, bool ignoreSpaces)
+bool tokensEqual(const QString& token1, const QString& token2, double tolerance)
 {
-    if (!problemCase)
+    if (token1==token2)
+        return true;
+    if (tolerance<=0)
         return false;
-    QStringList output = textToLines(problemCase->output);
-    QStringList expected;
-    if (fileExists(problemCase->expectedOutputFileName))
-        expected = readFileToLines(problemCase->expectedOutputFileName);
-    else
-        expected = textToLines(problemCase->expected);
-    problemCase->outputLineCounts = output.count();
-    problemCase->expectedLineCounts = expected.count();
-    if (output.count()!=expected.count())
+    bool ok1,ok2;
+    double value1 = token1.toDouble(&ok1);
+    double value2 = token2.toDouble(&ok2);
+    if (!ok1 || !ok2)
         return false;
-    for (int i=0;i<output.count();i++) {
-        if (ignoreSpaces) {
-            if (!equalIgnoringSpaces(output[i],expected[i])) {
-                problemCase->firstDiffLine = i;
-                return false;
-            }
-        } else {
-            if (output[i]!=expected[i]) {
-                problemCase->firstDiffLine = i;
+    double diff = std::fabs(value1-value2);
+    //absolute or relative error
+    return diff <= tolerance
+            || diff <= tolerance * std::max(std::fabs(value1),std::fabs(value2));
+}
+
+bool compareExactly(CaseTextStream& output, CaseTextStream& expected, int& line)
+{
+    line = 0;
+    while (true) {
+        int ch1 = output.get();
+        int ch2 = expected.get();
+        if (ch1!=ch2)
+            return false;
+        if (ch1<0)
+            return true;
+        if (ch1=='\n')
+            line++;
+    }
+}
+
+bool compareTokens(CaseTextStream& output, CaseTextStream& expected, int& line, double tolerance)
+{
+    //token buffers are reused for all lines
+    QString token1;
+    QString token2;
+    line = 0;
+    while (true) {
+        bool hasToken1 = nextToken(output,token1);
+        bool hasToken2 = nextToken(expected,token2);
+        if (hasToken1!=hasToken2)
+            return false;
+        if (!hasToken1) {
+            //both are at the end of the line
+            int ch1 = output.get();
+            int ch2 = expected.get();
+            if (ch1!=ch2)
                 return false;
-            }
+            if (ch1<0)
+                return true;
+            line++;
+        } else if (!tokensEqual(token1,token2,tolerance)) {
+            return false;
         }
     }
-    return true;
+}
 }
 
-bool ProblemCaseValidator::equalIgnoringSpaces(const QString &s1, const QString &s2)
+ProblemCaseValidator::ProblemCaseValidator()
 {
-    QStringList strList1=split(s1);
-    QStringList strList2=split(s2);
-    return (strList1==strList2);
+
 }
 
-QStringList ProblemCaseValidator::split(const QString &s)
+bool ProblemCaseValidator::validate(POJProblemCase problemCase, bool ignoreSpaces, int floatPrecision)
 {
-    QStringList result;
-    const QChar* p = s.data();
-    const QChar* start = p;
-    while (p->unicode()!=0) {
-        if (p->isSpace()) {
-            if (!start->isSpace()) {
-                result.append(QString(start,p-start));
-            }
-            start = p;
-        } else if (start->isSpace()) {
-            start = p;
+    if (!problemCase)
+        return false;
+    CaseTextStream output;
+    //the output is decoded like the runner decodes the shown part
+    if (!problemCase->outputFile
+            || !output.openFile(problemCase->outputFile->fileName(), QTextCodec::codecForLocale()))
+        output.setText(problemCase->output);
+    QString expectedText;
+    CaseTextStream expected;
+    if (!fileExists(problemCase->expectedOutputFileName)
+            || !expected.openFile(problemCase->expectedOutputFileName)) {
+        //data files of saved problem sets are streamed too, they are in utf-8
+        QString dataFile = problemCase->expected.pendingDataFile();
+        if (dataFile.isEmpty()
+                || !expected.openFile(dataFile, QTextCodec::codecForName("UTF-8"))) {
+            expectedText = problemCase->expected.text();
+            expected.setText(expectedText);
         }
-        p++;
     }
-    if (!start->isSpace()) {
-        result.append(QString(start,p-start));
+    int line;
+    bool result;
+    if (ignoreSpaces) {
+        double tolerance = floatPrecision>0?std::pow(10.0,-floatPrecision):0;
+        result = compareTokens(output,expected,line,tolerance);
+    } else {
+        result = compareExactly(output,expected,line);
     }
+    //the rest is only scanned for line breaks
+    problemCase->outputLineCounts = output.lineCount();
+    problemCase->expectedLineCounts = expected.lineCount();
+    if (!result)
+        problemCase->firstDiffLine = line;
     return result;
 }
@@ -19,14 +19,24 @@
 
 #include "ojproblemset.h"
 
+/**
+ * @brief Compares the output of a problem case with its expected output.
+ *
+ * Both outputs are read chunk by chunk from their files (the runner spools
+ * the program's output to a temporary file; files are mapped into memory
+ * when possible) and compared char by char, so big outputs are neither held
+ * in memory nor split into lines.
+ */
 class ProblemCaseValidator
 {
 public:
     ProblemCaseValidator();
-    bool validate(POJProblemCase problemCase,bool ignoreSpaces);
-private:
-    bool equalIgnoringSpaces(const QString& s1, const QString& s2);
-    QStringList split(const QString& s);
+    /**
+     * @param ignoreSpaces compare the whitespace separated tokens of each line
+     * @param floatPrecision when ignoring spaces, numbers whose difference is
+     *   within 10^-floatPrecision are equal; 0 compares numbers exactly
+     */
+    bool validate(POJProblemCase problemCase,bool ignoreSpaces, int floatPrecision = 0);
 };
 
 #endif // PROBLEMCASEVALIDATOR_H
@@ -33,7 +33,6 @@
 #include <QMessageBox>
 #include <QTextCodec>
 #include <QMessageBox>
-#include <QDirIterator>
 #include <QMimeDatabase>
 #include <QDesktopServices>
 #include <QJsonObject>
@@ -273,9 +272,12 @@ PProjectModelNode Project::makeNewFolderNode(
     node->isUnit=false;
     node->priority = priority;
     node->folderNodeType = nodeType;
-    QModelIndex parentIndex=mModel.getNodeIndex(newParent.get());
     newParent->children.append(node);
-    mModel.insertRow(newParent->children.count()-1,parentIndex);
+    //the model is reset at the end of the update
+    if (!mModel.isUpdating()) {
+        QModelIndex parentIndex=mModel.getNodeIndex(newParent.get());
+        mModel.insertRow(newParent->children.count()-1,parentIndex);
+    }
     return node;
 }
 
@@ -296,8 +298,10 @@ PProjectModelNode Project::makeNewFileNode(PProjectUnit unit,int priority, PProj
     node->folderNodeType = ProjectModelNodeType::File;
 
     newParent->children.append(node);
-    QModelIndex parentIndex=mModel.getNodeIndex(newParent.get());
-    mModel.insertRow(newParent->children.count()-1,parentIndex);
+    if (!mModel.isUpdating()) {
+        QModelIndex parentIndex=mModel.getNodeIndex(newParent.get());
+        mModel.insertRow(newParent->children.count()-1,parentIndex);
+    }
     return node;
 }
 
@@ -552,6 +556,9 @@ bool Project::removeUnit(PProjectUnit& unit, bool doClose , bool removeFile)
             break;
         parentIndex = mModel.getNodeIndex(parentNode.get());
         mModel.removeRow(row,parentIndex);
+        auto it = mFileSystemFolderNodes.find(fileSystemFolderNodeKey(currentNode));
+        if (it != mFileSystemFolderNodes.end() && it.value() == currentNode)
+            mFileSystemFolderNodes.erase(it);
         currentNode = parentNode;
     }
 
@@ -1170,8 +1177,10 @@ PProjectModelNode Project::addFolder(PProjectModelNode parentFolder,const QStrin
 
 PProjectUnit Project::addUnit(const QString &inFileName, PProjectModelNode parentNode)
 {
+    //the same name ProjectUnit::setFileName() makes, which is the unit's key
+    QString fileName = QFileInfo(QDir(directory()).filePath(inFileName)).absoluteFilePath();
     // Don't add if it already exists
-    if (fileAlreadyExists(inFileName)) {
+    if (fileAlreadyExists(fileName)) {
         QMessageBox::critical(nullptr,
                                  tr("File Exists"),
                                  tr("File '%1' is already in the project"),
@@ -1180,12 +1189,12 @@ PProjectUnit Project::addUnit(const QString &inFileName, PProjectModelNode paren
     }
     if (mOptions.modelType == ProjectModelType::FileSystem) {
         // in file system mode, parentNode is determined by file's path
-        parentNode = getParentFileSystemFolderNode(inFileName);
+        parentNode = getParentFileSystemFolderNode(fileName);
     }
     PProjectUnit newUnit = std::make_shared<ProjectUnit>(this);
 
     // Set all properties
-    newUnit->setFileName(QDir(directory()).filePath(inFileName));
+    newUnit->setFileName(fileName);
     newUnit->setNew(false);
     Editor * e= unitEditor(newUnit);
     if (e) {
@@ -1602,40 +1611,17 @@ void Project::createFolderNodes()
     }
 }
 
-static void addFolderRecursively(QSet<QString>& folders, QString folder) {
-    if (folder.isEmpty())
-        return;
-    folders.insert(excludeTrailingPathDelimiter(folder));
-    QString parentFolder = QFileInfo(folder).absolutePath();
-    if (parentFolder==folder)
-        return;
-    addFolderRecursively(folders, parentFolder);
-}
-
 void Project::createFileSystemFolderNodes()
 {
-    QSet<QString> headerFolders;
-    QSet<QString> sourceFolders;
-    QSet<QString> otherFolders;
     mRootNode->children.clear();
     mSpecialNodes.clear();
     mFileSystemFolderNodes.clear();
 
-    foreach (const PProjectUnit& unit, mUnits) {
-        QFileInfo fileInfo(unit->fileName());
-        if (isHFile(fileInfo.fileName())) {
-            addFolderRecursively(headerFolders,fileInfo.absolutePath());
-        } else if (isCFile(fileInfo.fileName())) {
-            addFolderRecursively(sourceFolders,fileInfo.absolutePath());
-        } else {
-            addFolderRecursively(otherFolders,fileInfo.absolutePath());
-        }
-    }
+    //folder nodes are made by findFileSystemFolderNode() when units are added
     PProjectModelNode node = makeNewFolderNode(tr("Headers"),
                                                mRootNode,
                                                ProjectModelNodeType::DUMMY_HEADERS_FOLDER,
                                                1000);
-    createFileSystemFolderNode(ProjectModelNodeType::DUMMY_HEADERS_FOLDER,folder(),node, headerFolders);
     mCustomFolderNodes.append(node);
     mSpecialNodes.insert(ProjectModelNodeType::DUMMY_HEADERS_FOLDER,node);
 
@@ -1643,7 +1629,6 @@ void Project::createFileSystemFolderNodes()
                              mRootNode,
                              ProjectModelNodeType::DUMMY_SOURCES_FOLDER,
                              900);
-    createFileSystemFolderNode(ProjectModelNodeType::DUMMY_SOURCES_FOLDER,folder(),node, sourceFolders);
     mCustomFolderNodes.append(node);
     mSpecialNodes.insert(ProjectModelNodeType::DUMMY_SOURCES_FOLDER,node);
 
@@ -1651,31 +1636,10 @@ void Project::createFileSystemFolderNodes()
                              mRootNode,
                              ProjectModelNodeType::DUMMY_OTHERS_FOLDER,
                              800);
-    createFileSystemFolderNode(ProjectModelNodeType::DUMMY_OTHERS_FOLDER,folder(),node, otherFolders);
     mCustomFolderNodes.append(node);
     mSpecialNodes.insert(ProjectModelNodeType::DUMMY_OTHERS_FOLDER,node);
 }
 
-void Project::createFileSystemFolderNode(
-        ProjectModelNodeType folderType,
-        const QString &folderName,
-        PProjectModelNode parent,
-        const QSet<QString>& validFolders)
-{
-    QDirIterator iter(folderName);
-    while (iter.hasNext()) {
-        iter.next();
-        QFileInfo fileInfo = iter.fileInfo();
-        if (fileInfo.isHidden() || fileInfo.fileName().startsWith('.'))
-            continue;
-        if (fileInfo.isDir() && validFolders.contains(fileInfo.absoluteFilePath())) {
-            PProjectModelNode node = makeNewFolderNode(fileInfo.fileName(),parent);
-            mFileSystemFolderNodes.insert(QString("%1/%2").arg((int)folderType).arg(fileInfo.absoluteFilePath()),node);
-            createFileSystemFolderNode(folderType,fileInfo.absoluteFilePath(), node, validFolders);
-        }
-    }
-}
-
 PProjectUnit Project::doAutoOpen()
 {
     QHash<QString,PProjectEditorLayout> layouts = loadLayout();
@@ -1713,11 +1677,7 @@ PProjectUnit Project::doAutoOpen()
 
 bool Project::fileAlreadyExists(const QString &s)
 {
-    foreach (const PProjectUnit& unit, mUnits) {
-        if (unit->fileName() == s)
-            return true;
-    }
-    return false;
+    return mUnits.contains(s);
 }
 
 PProjectModelNode Project::findFileSystemFolderNode(const QString &folderPath, ProjectModelNodeType nodeType)
@@ -1730,27 +1690,23 @@ PProjectModelNode Project::findFileSystemFolderNode(const QString &folderPath, P
     if (parentNode) {
         QString projectFolder = includeTrailingPathDelimiter(directory());
         if (folderPath.startsWith(projectFolder)) {
+            //only the missing folders on the path are made
             QString pathStr = folderPath.mid(projectFolder.length());
             QStringList paths = pathStr.split("/");
             PProjectModelNode currentParentNode = parentNode;
             QString currentFolderFullPath=directory();
             for (int i=0;i<paths.length();i++) {
                 QString currentFolderName = paths[i];
+                if (currentFolderName.isEmpty())
+                    continue;
                 currentFolderFullPath = currentFolderFullPath+"/"+currentFolderName;
-                bool found=false;
-                foreach(PProjectModelNode tempNode, parentNode->children) {
-                    if (tempNode->folderNodeType == ProjectModelNodeType::Folder
-                            && tempNode->text == currentFolderName) {
-                        found=true;
-                        currentParentNode = tempNode;
-                        break;
-                    }
-                }
-                if (!found) {
-                    PProjectModelNode newNode = makeNewFolderNode(currentFolderName,currentParentNode);
-                    mFileSystemFolderNodes.insert(QString("%1/%2").arg((int)nodeType).arg(currentFolderFullPath),newNode);
-                    currentParentNode = newNode;
+                QString key = QString("%1/%2").arg((int)nodeType).arg(currentFolderFullPath);
+                PProjectModelNode folderNode = mFileSystemFolderNodes.value(key,PProjectModelNode());
+                if (!folderNode) {
+                    folderNode = makeNewFolderNode(currentFolderName,currentParentNode);
+                    mFileSystemFolderNodes.insert(key,folderNode);
                 }
+                currentParentNode = folderNode;
             }
             return currentParentNode;
         }
@@ -1759,6 +1715,20 @@ PProjectModelNode Project::findFileSystemFolderNode(const QString &folderPath, P
     return mRootNode;
 }
 
+QString Project::fileSystemFolderNodeKey(PProjectModelNode folderNode)
+{
+    //the key findFileSystemFolderNode() used when it made the node
+    QStringList names;
+    PProjectModelNode node = folderNode;
+    while (node && node->folderNodeType == ProjectModelNodeType::Folder) {
+        names.prepend(node->text);
+        node = node->parent.lock();
+    }
+    if (!node || names.isEmpty())
+        return QString();
+    return QString("%1/%2").arg((int)node->folderNodeType).arg(directory()+"/"+names.join("/"));
+}
+
 PProjectModelNode Project::getCustomeFolderNodeFromName(const QString &name)
 {
     int index = mFolders.indexOf(name);
@@ -2455,6 +2425,8 @@ ProjectModel::ProjectModel(Project *project, QObject *parent):
     mUpdateCount = 0;
     //delete in the destructor
     mIconProvider = new CustomFileIconProvider();
+    connect(mIconProvider->VCSRepository(), &GitRepository::statusChanged,
+            this, &ProjectModel::onVCSStatusChanged);
 }
 
 ProjectModel::~ProjectModel()
@@ -2479,11 +2451,36 @@ void ProjectModel::endUpdate()
     }
 }
 
+bool ProjectModel::isUpdating() const
+{
+    return mUpdateCount>0;
+}
+
 CustomFileIconProvider *ProjectModel::iconProvider() const
 {
     return mIconProvider;
 }
 
+void ProjectModel::onVCSStatusChanged()
+{
+    if (mUpdateCount>0)
+        return;
+    //icons of the files and the branch name of the root node
+    refreshNodes(QModelIndex());
+}
+
+void ProjectModel::refreshNodes(const QModelIndex &parent)
+{
+    int count = rowCount(parent);
+    if (count == 0)
+        return;
+    emit dataChanged(index(0,0,parent),index(count-1,0,parent),
+                     {Qt::DisplayRole, Qt::DecorationRole});
+    for (int i=0;i<count;i++) {
+        refreshNodes(index(i,0,parent));
+    }
+}
+
 bool ProjectModel::insertRows(int row, int count, const QModelIndex &parent)
 {
     beginInsertRows(parent,row,row+count-1);
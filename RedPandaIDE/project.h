@@ -134,6 +134,11 @@ public:
     ~ProjectModel();
     void beginUpdate();
     void endUpdate();
+    bool isUpdating() const;
+private slots:
+    void onVCSStatusChanged();
+private:
+    void refreshNodes(const QModelIndex& parent);
 private:
     Project* mProject;
     int mUpdateCount;
@@ -295,9 +300,9 @@ private:
     void checkProjectFileForUpdate(SimpleIni& ini);
     void createFolderNodes();
     void createFileSystemFolderNodes();
-    void createFileSystemFolderNode(ProjectModelNodeType folderType, const QString& folderName, PProjectModelNode parent, const QSet<QString>& validFolders);
     PProjectModelNode getParentFileSystemFolderNode(const QString& filename);
     PProjectModelNode findFileSystemFolderNode(const QString& folderPath, ProjectModelNodeType nodeType);
+    QString fileSystemFolderNodeKey(PProjectModelNode folderNode);
     PProjectModelNode getCustomeFolderNodeFromName(const QString& name);
     void loadOptions(SimpleIni& ini);
     //PProjectUnit
@@ -21,6 +21,7 @@
 #include "utils.h"
 #include <QDir>
 #include "systemconsts.h"
+#include "compiler/compilerprobe.h"
 #include <QDebug>
 #include <QMessageBox>
 #include <QStandardPaths>
@@ -1995,9 +1996,9 @@ void Settings::CompilerSet::setProperties(const QString &binDir, const QString&
 //    else
 //        return;
     // Obtain version number and compiler distro etc
-    QStringList arguments;
-    arguments.append("-v");
-    QByteArray output = getCompilerOutput(binDir,cc_prog,arguments);
+    PCompilerProbe probe = pSettings->compilerSets().probeCache()->probe(
+                includeTrailingPathDelimiter(binDir)+cc_prog);
+    QByteArray output = probe->cInfo;
 
     //Target
     QByteArray targetStr = "Target: ";
@@ -2009,6 +2010,8 @@ void Settings::CompilerSet::setProperties(const QString &binDir, const QString&
     while (delimPos2<output.length() && !isNonPrintableAsciiChar(output[delimPos2]))
         delimPos2++;
     mTarget = output.mid(delimPos1,delimPos2-delimPos1);
+    //same as the output of -dumpmachine
+    mDumpMachine = mTarget;
 
     if (mTarget.contains("x86_64"))
         mTarget = "x86_64";
@@ -2084,11 +2087,6 @@ void Settings::CompilerSet::setProperties(const QString &binDir, const QString&
     tmpDir.cdUp();
     QString folder = tmpDir.path();
 
-    // Obtain compiler target
-    arguments.clear();
-    arguments.append("-dumpmachine");
-    mDumpMachine = getCompilerOutput(binDir, cc_prog, arguments);
-
     // Add the default directories
     addExistingDirectory(mBinDirs, includeTrailingPathDelimiter(folder) +  "bin");
 //    addExistingDirectory(mDefaultLibDirs, includeTrailingPathDelimiter(folder) + "lib");
@@ -2106,19 +2104,10 @@ void Settings::CompilerSet::setProperties(const QString &binDir, const QString&
 
 void Settings::CompilerSet::setDefines() {
     // get default defines
-    QStringList arguments;
-    arguments.append("-dM");
-    arguments.append("-E");
-    arguments.append("-x");
-    arguments.append("c++");
-    arguments.append("-std=c++17");
-    arguments.append(NULL_FILE);
-    QFileInfo ccompiler(mCCompiler);
-    QByteArray output = getCompilerOutput(ccompiler.absolutePath(),ccompiler.fileName(),arguments);
+    PCompilerProbe probe = pSettings->compilerSets().probeCache()->probe(mCCompiler);
     // 'cpp.exe -dM -E -x c++ -std=c++17 NUL'
-
     mCppDefines.clear();
-    QList<QByteArray> lines = output.split('\n');
+    QList<QByteArray> lines = probe->cppDefines.split('\n');
     for (QByteArray& line:lines) {
         QByteArray trimmedLine = line.trimmed();
         if (!trimmedLine.isEmpty()) {
@@ -2126,17 +2115,9 @@ void Settings::CompilerSet::setDefines() {
         }
     }
 
-    arguments.clear();
-    arguments.append("-dM");
-    arguments.append("-E");
-    arguments.append("-x");
-    arguments.append("c");
-    arguments.append(NULL_FILE);
-    output = getCompilerOutput(ccompiler.absolutePath(),ccompiler.fileName(),arguments);
     // 'cpp.exe -dM -E -x c NUL'
-
     mCDefines.clear();
-    lines = output.split('\n');
+    lines = probe->cDefines.split('\n');
     for (QByteArray& line:lines) {
         QByteArray trimmedLine = line.trimmed();
         if (!trimmedLine.isEmpty()) {
@@ -2180,15 +2161,12 @@ void Settings::CompilerSet::setDirectories(const QString& binDir,const QString&
         cc_prog = CLANG_PROGRAM;
     else
         cc_prog = GCC_PROGRAM;
+    PCompilerProbe probe = pSettings->compilerSets().probeCache()->probe(
+                includeTrailingPathDelimiter(binDir)+cc_prog);
     // Find default directories
     // C include dirs
-    QStringList arguments;
-    arguments.clear();
-    arguments.append("-xc");
-    arguments.append("-v");
-    arguments.append("-E");
-    arguments.append(NULL_FILE);
-    QByteArray output = getCompilerOutput(binDir,cc_prog,arguments);
+    //gcc -xc -v -E NUL
+    QByteArray output = probe->cInfo;
 
     int delimPos1 = output.indexOf("#include <...> search starts here:");
     int delimPos2 = output.indexOf("End of search list.");
@@ -2205,13 +2183,8 @@ void Settings::CompilerSet::setDirectories(const QString& binDir,const QString&
 
     // Find default directories
     // C++ include dirs
-    arguments.clear();
-    arguments.append("-xc++");
-    arguments.append("-E");
-    arguments.append("-v");
-    arguments.append(NULL_FILE);
-    output = getCompilerOutput(binDir,cc_prog,arguments);
     //gcc -xc++ -E -v NUL
+    output = probe->cppInfo;
 
     delimPos1 = output.indexOf("#include <...> search starts here:");
     delimPos2 = output.indexOf("End of search list.");
@@ -2227,10 +2200,8 @@ void Settings::CompilerSet::setDirectories(const QString& binDir,const QString&
     }
 
     // Find default directories
-    arguments.clear();
-    arguments.append("-print-search-dirs");
-    arguments.append(NULL_FILE);
-    output = getCompilerOutput(binDir,cc_prog,arguments);
+    //gcc -print-search-dirs NUL
+    output = probe->searchDirs;
     // bin dirs
     QByteArray targetStr = QByteArray("programs: =");
     delimPos1 = output.indexOf(targetStr);
@@ -2358,20 +2329,6 @@ void Settings::CompilerSet::setIniOptions(const QByteArray &value)
    }
 }
 
-QByteArray Settings::CompilerSet::getCompilerOutput(const QString &binDir, const QString &binFile, const QStringList &arguments)
-{
-    QProcessEnvironment env;
-    env.insert("LANG","en");
-    QByteArray result = runAndGetOutput(
-                includeTrailingPathDelimiter(binDir)+binFile,
-                binDir,
-                arguments,
-                QByteArray(),
-                false,
-                env);
-    return result.trimmed();
-}
-
 Settings::CompilerSet::CompilationStage Settings::CompilerSet::compilationStage() const
 {
     return mCompilationStage;
@@ -2637,7 +2594,7 @@ void Settings::CompilerSets::clearSets()
 void Settings::CompilerSets::findSets()
 {
     clearSets();
-    QSet<QString> searched;
+    QStringList folders;
 
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
     QString path = env.value("PATH");
@@ -2645,32 +2602,40 @@ void Settings::CompilerSets::findSets()
     QString folder;
     for (int i=pathList.count()-1;i>=0;i--) {
         folder = pathList[i];
-        if (searched.contains(folder))
+        if (folders.contains(folder))
             continue;
-        searched.insert(folder);
         if (folder!="/bin") { // /bin/gcc is symbolic link to /usr/bin/gcc
-            addSets(folder);
+            folders.append(folder);
         }
     }
 
 #ifdef Q_OS_WIN
     folder = includeTrailingPathDelimiter(mSettings->dirs().appDir())+"MinGW32"+QDir::separator()+"bin";
-    if (!searched.contains(folder)) {
-        addSets(folder);
-        searched.insert(folder);
-    }
+    if (!folders.contains(folder))
+        folders.append(folder);
     folder = includeTrailingPathDelimiter(mSettings->dirs().appDir())+"MinGW64"+QDir::separator()+"bin";
-    if (!searched.contains(folder)) {
-        addSets(folder);
-        searched.insert(folder);
-    }
+    if (!folders.contains(folder))
+        folders.append(folder);
     folder = includeTrailingPathDelimiter(mSettings->dirs().appDir())+"Clang64"+QDir::separator()+"bin";
-    if (!searched.contains(folder)) {
-        addSets(folder);
-        searched.insert(folder);
-    }
+    if (!folders.contains(folder))
+        folders.append(folder);
 #endif
 
+    //probe all compilers at once, sets are then made from the cached results
+    QStringList programs;
+    foreach (const QString& folder, folders) {
+        if (!directoryExists(folder))
+            continue;
+        if (fileExists(folder, GCC_PROGRAM))
+            programs.append(includeTrailingPathDelimiter(folder)+GCC_PROGRAM);
+        if (fileExists(folder, CLANG_PROGRAM))
+            programs.append(includeTrailingPathDelimiter(folder)+CLANG_PROGRAM);
+    }
+    probeCache()->probeAll(programs);
+
+    foreach (const QString& folder, folders) {
+        addSets(folder);
+    }
 }
 
 void Settings::CompilerSets::saveSets()
@@ -3034,6 +2999,15 @@ void Settings::CompilerSets::prepareCompatibleIndex()
     mCompilerCompatibleIndex.append(CC_CMD_OPT_USE_PIPE);
 }
 
+CompilerProbeCache *Settings::CompilerSets::probeCache()
+{
+    if (!mProbeCache)
+        mProbeCache = std::make_shared<CompilerProbeCache>(
+                    includeTrailingPathDelimiter(mSettings->dirs().config())
+                    + DEV_COMPILER_PROBES_FILE);
+    return mProbeCache.get();
+}
+
 QString Settings::CompilerSets::getKeyFromCompilerCompatibleIndex(int idx) const
 {
     if (idx<0 || idx >= mCompilerCompatibleIndex.length())
@@ -3096,6 +3070,8 @@ void Settings::Environment::doLoad()
 #endif
     mHideNonSupportFilesInFileView=boolValue("hide_non_support_files_file_view",true);
     mOpenFilesInSingleInstance = boolValue("open_files_in_single_instance",false);
+    mBuildJobs = intValue("build_jobs",0);
+    mUseBuiltinProjectBuilder = boolValue("use_builtin_project_builder",false);
 }
 
 int Settings::Environment::interfaceFontSize() const
@@ -3208,6 +3184,26 @@ void Settings::Environment::setOpenFilesInSingleInstance(bool newOpenFilesInSing
     mOpenFilesInSingleInstance = newOpenFilesInSingleInstance;
 }
 
+int Settings::Environment::buildJobs() const
+{
+    return mBuildJobs;
+}
+
+void Settings::Environment::setBuildJobs(int newBuildJobs)
+{
+    mBuildJobs = newBuildJobs;
+}
+
+bool Settings::Environment::useBuiltinProjectBuilder() const
+{
+    return mUseBuiltinProjectBuilder;
+}
+
+void Settings::Environment::setUseBuiltinProjectBuilder(bool newUseBuiltinProjectBuilder)
+{
+    mUseBuiltinProjectBuilder = newUseBuiltinProjectBuilder;
+}
+
 void Settings::Environment::doSave()
 {
     //Appearence
@@ -3228,6 +3224,8 @@ void Settings::Environment::doSave()
 
     saveValue("hide_non_support_files_file_view",mHideNonSupportFilesInFileView);
     saveValue("open_files_in_single_instance",mOpenFilesInSingleInstance);
+    saveValue("build_jobs",mBuildJobs);
+    saveValue("use_builtin_project_builder",mUseBuiltinProjectBuilder);
 }
 
 QString Settings::Environment::interfaceFont() const
@@ -3325,6 +3323,16 @@ void Settings::Executor::setIgnoreSpacesWhenValidatingCases(bool newIgnoreSpaces
     mIgnoreSpacesWhenValidatingCases = newIgnoreSpacesWhenValidatingCases;
 }
 
+int Settings::Executor::caseValidationFloatPrecision() const
+{
+    return mCaseValidationFloatPrecision;
+}
+
+void Settings::Executor::setCaseValidationFloatPrecision(int newCaseValidationFloatPrecision)
+{
+    mCaseValidationFloatPrecision = newCaseValidationFloatPrecision;
+}
+
 bool Settings::Executor::caseEditorFontOnlyMonospaced() const
 {
     return mCaseEditorFontOnlyMonospaced;
@@ -3345,6 +3353,46 @@ void Settings::Executor::setCaseTimeout(int newCaseTimeout)
     mCaseTimeout = newCaseTimeout;
 }
 
+int Settings::Executor::caseRunnerJobs() const
+{
+    return mCaseRunnerJobs;
+}
+
+void Settings::Executor::setCaseRunnerJobs(int newCaseRunnerJobs)
+{
+    mCaseRunnerJobs = newCaseRunnerJobs;
+}
+
+bool Settings::Executor::runTimeLimitedCasesSerially() const
+{
+    return mRunTimeLimitedCasesSerially;
+}
+
+void Settings::Executor::setRunTimeLimitedCasesSerially(bool newRunTimeLimitedCasesSerially)
+{
+    mRunTimeLimitedCasesSerially = newRunTimeLimitedCasesSerially;
+}
+
+bool Settings::Executor::enableCaseMemoryLimit() const
+{
+    return mEnableCaseMemoryLimit;
+}
+
+void Settings::Executor::setEnableCaseMemoryLimit(bool newEnableCaseMemoryLimit)
+{
+    mEnableCaseMemoryLimit = newEnableCaseMemoryLimit;
+}
+
+int Settings::Executor::caseMemoryLimit() const
+{
+    return mCaseMemoryLimit;
+}
+
+void Settings::Executor::setCaseMemoryLimit(int newCaseMemoryLimit)
+{
+    mCaseMemoryLimit = newCaseMemoryLimit;
+}
+
 bool Settings::Executor::enableCaseTimeout() const
 {
     return mEnableCaseTimeout;
@@ -3408,12 +3456,17 @@ void Settings::Executor::doSave()
     saveValue("enable_competivie_companion", mEnableCompetitiveCompanion);
     saveValue("competitive_companion_port", mCompetivieCompanionPort);
     saveValue("ignore_spaces_when_validating_cases", mIgnoreSpacesWhenValidatingCases);
+    saveValue("case_validation_float_precision", mCaseValidationFloatPrecision);
     saveValue("case_editor_font_name",mCaseEditorFontName);
     saveValue("case_editor_font_size",mCaseEditorFontSize);
     saveValue("case_editor_font_only_monospaced",mCaseEditorFontOnlyMonospaced);
     saveValue("case_timeout_ms", mCaseTimeout);
     remove("case_timeout");
     saveValue("enable_case_timeout", mEnableCaseTimeout);
+    saveValue("enable_case_memory_limit", mEnableCaseMemoryLimit);
+    saveValue("case_memory_limit_mb", mCaseMemoryLimit);
+    saveValue("case_runner_jobs", mCaseRunnerJobs);
+    saveValue("run_time_limited_cases_serially", mRunTimeLimitedCasesSerially);
 }
 
 bool Settings::Executor::pauseConsole() const
@@ -3439,6 +3492,7 @@ void Settings::Executor::doLoad()
     mEnableCompetitiveCompanion = boolValue("enable_competivie_companion",true);
     mCompetivieCompanionPort = intValue("competitive_companion_port",10045);
     mIgnoreSpacesWhenValidatingCases = boolValue("ignore_spaces_when_validating_cases",false);
+    mCaseValidationFloatPrecision = intValue("case_validation_float_precision",0);
 #ifdef Q_OS_WIN
     mCaseEditorFontName = stringValue("case_editor_font_name","consolas");
 #elif defined(Q_OS_MACOS)
@@ -3454,6 +3508,10 @@ void Settings::Executor::doLoad()
     else
         mCaseTimeout = intValue("case_timeout_ms", 2000);
     mEnableCaseTimeout = boolValue("enable_case_timeout", true);
+    mEnableCaseMemoryLimit = boolValue("enable_case_memory_limit", false);
+    mCaseMemoryLimit = intValue("case_memory_limit_mb", 256);
+    mCaseRunnerJobs = intValue("case_runner_jobs", 0);
+    mRunTimeLimitedCasesSerially = boolValue("run_time_limited_cases_serially", false);
 }
 
 
@@ -3572,24 +3630,24 @@ void Settings::Debugger::setGDBServerPort(int newGDBServerPort)
     mGDBServerPort = newGDBServerPort;
 }
 
-int Settings::Debugger::memoryViewRows() const
+int Settings::Debugger::memoryViewColumns() const
 {
-    return mMemoryViewRows;
+    return mMemoryViewColumns;
 }
 
-void Settings::Debugger::setMemoryViewRows(int newMemoryViewRows)
+void Settings::Debugger::setMemoryViewColumns(int newMemoryViewColumns)
 {
-    mMemoryViewRows = newMemoryViewRows;
+    mMemoryViewColumns = newMemoryViewColumns;
 }
 
-int Settings::Debugger::memoryViewColumns() const
+int Settings::Debugger::traceSampleInterval() const
 {
-    return mMemoryViewColumns;
+    return mTraceSampleInterval;
 }
 
-void Settings::Debugger::setMemoryViewColumns(int newMemoryViewColumns)
+void Settings::Debugger::setTraceSampleInterval(int newTraceSampleInterval)
 {
-    mMemoryViewColumns = newMemoryViewColumns;
+    mTraceSampleInterval = newTraceSampleInterval;
 }
 
 bool Settings::Debugger::autosaveBreakpoints() const
@@ -3649,8 +3707,10 @@ void Settings::Debugger::doSave()
     saveValue("open_cpu_info_when_signaled",mOpenCPUInfoWhenSignaled);
     saveValue("use_gdb_server", mUseGDBServer);
     saveValue("gdb_server_port",mGDBServerPort);
-    saveValue("memory_view_rows",mMemoryViewRows);
     saveValue("memory_view_columns",mMemoryViewColumns);
+    //the memory view shows all rows since 1.5
+    remove("memory_view_rows");
+    saveValue("trace_sample_interval",mTraceSampleInterval);
 
 }
 
@@ -3679,8 +3739,8 @@ void Settings::Debugger::doLoad()
     mUseGDBServer = boolValue("use_gdb_server", true);
 #endif
     mGDBServerPort = intValue("gdb_server_port",41234);
-    mMemoryViewRows = intValue("memory_view_rows",8);
     mMemoryViewColumns = intValue("memory_view_columns",8);
+    mTraceSampleInterval = intValue("trace_sample_interval",20);
 }
 
 Settings::History::History(Settings *settings):_Base(settings, SETTING_HISTORY)
@@ -52,6 +52,7 @@
 extern const char ValueToChar[28];
 
 class Settings;
+class CompilerProbeCache;
 
 enum CompilerSetType {
     CST_RELEASE,
@@ -536,6 +537,12 @@ public:
         bool openFilesInSingleInstance() const;
         void setOpenFilesInSingleInstance(bool newOpenFilesInSingleInstance);
 
+        int buildJobs() const;
+        void setBuildJobs(int newBuildJobs);
+
+        bool useBuiltinProjectBuilder() const;
+        void setUseBuiltinProjectBuilder(bool newUseBuiltinProjectBuilder);
+
     private:
 
         //Appearence
@@ -553,6 +560,8 @@ public:
         QString mAStylePath;
         bool mHideNonSupportFilesInFileView;
         bool mOpenFilesInSingleInstance;
+        int mBuildJobs; // 0 means use all cpu cores
+        bool mUseBuiltinProjectBuilder;
         // _Base interface
     protected:
         void doSave() override;
@@ -870,6 +879,9 @@ public:
         bool ignoreSpacesWhenValidatingCases() const;
         void setIgnoreSpacesWhenValidatingCases(bool newIgnoreSpacesWhenValidatingCases);
 
+        int caseValidationFloatPrecision() const;
+        void setCaseValidationFloatPrecision(int newCaseValidationFloatPrecision);
+
         const QString &caseEditorFontName() const;
         void setCaseEditorFontName(const QString &newCaseEditorFontName);
 
@@ -885,6 +897,19 @@ public:
         int caseTimeout() const;
         void setCaseTimeout(int newCaseTimeout);
 
+        bool enableCaseMemoryLimit() const;
+        void setEnableCaseMemoryLimit(bool newEnableCaseMemoryLimit);
+
+        //in MB
+        int caseMemoryLimit() const;
+        void setCaseMemoryLimit(int newCaseMemoryLimit);
+
+        int caseRunnerJobs() const;
+        void setCaseRunnerJobs(int newCaseRunnerJobs);
+
+        bool runTimeLimitedCasesSerially() const;
+        void setRunTimeLimitedCasesSerially(bool newRunTimeLimitedCasesSerially);
+
     private:
         // general
         bool mPauseConsole;
@@ -899,11 +924,16 @@ public:
         bool mEnableCompetitiveCompanion;
         int mCompetivieCompanionPort;
         bool mIgnoreSpacesWhenValidatingCases;
+        int mCaseValidationFloatPrecision;
         QString mCaseEditorFontName;
         int mCaseEditorFontSize;
         bool mCaseEditorFontOnlyMonospaced;
         bool mEnableCaseTimeout;
         int mCaseTimeout;
+        bool mEnableCaseMemoryLimit;
+        int mCaseMemoryLimit;
+        int mCaseRunnerJobs;
+        bool mRunTimeLimitedCasesSerially;
 
     protected:
         void doSave() override;
@@ -1140,12 +1170,13 @@ public:
         int GDBServerPort() const;
         void setGDBServerPort(int newGDBServerPort);
 
-        int memoryViewRows() const;
-        void setMemoryViewRows(int newMemoryViewRows);
 
         int memoryViewColumns() const;
         void setMemoryViewColumns(int newMemoryViewColumns);
 
+        int traceSampleInterval() const;
+        void setTraceSampleInterval(int newTraceSampleInterval);
+
     private:
         bool mEnableDebugConsole;
         bool mShowDetailLog;
@@ -1162,8 +1193,8 @@ public:
         bool mOpenCPUInfoWhenSignaled;
         bool mUseGDBServer;
         int mGDBServerPort;
-        int mMemoryViewRows;
         int mMemoryViewColumns;
+        int mTraceSampleInterval;
 
         // _Base interface
     protected:
@@ -1299,8 +1330,6 @@ public:
 
         QString findProgramInBinDirs(const QString name);
 
-        QByteArray getCompilerOutput(const QString& binDir, const QString& binFile,
-                                     const QStringList& arguments);
     private:
         bool mFullLoaded;
         // Executables, most are hardcoded
@@ -1375,6 +1404,9 @@ public:
 
         QString getKeyFromCompilerCompatibleIndex(int idx) const;
 
+        //what the compilers tell about themselves, saved across runs
+        CompilerProbeCache* probeCache();
+
     private:
         PCompilerSet addSet(const QString& folder, const QString& cc_prog);
         PCompilerSet addSet(const PCompilerSet &pSet);
@@ -1391,6 +1423,7 @@ public:
         int mDefaultIndex;
         Settings* mSettings;
         QStringList mCompilerCompatibleIndex; // index for old settings compatibility
+        std::shared_ptr<CompilerProbeCache> mProbeCache;
     };
 
 public:
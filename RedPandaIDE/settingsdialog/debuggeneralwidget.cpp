@@ -55,8 +55,8 @@ void DebugGeneralWidget::doLoad()
     ui->grpUseGDBServer->setChecked(pSettings->debugger().useGDBServer());
 #endif
     ui->spinGDBServerPort->setValue(pSettings->debugger().GDBServerPort());
-    ui->spinMemoryViewRows->setValue(pSettings->debugger().memoryViewRows());
     ui->spinMemoryViewColumns->setValue(pSettings->debugger().memoryViewColumns());
+    ui->spinTraceSampleInterval->setValue(pSettings->debugger().traceSampleInterval());
 }
 
 void DebugGeneralWidget::doSave()
@@ -78,8 +78,8 @@ void DebugGeneralWidget::doSave()
     pSettings->debugger().setUseGDBServer(ui->grpUseGDBServer->isChecked());
 #endif
     pSettings->debugger().setGDBServerPort(ui->spinGDBServerPort->value());
-    pSettings->debugger().setMemoryViewRows(ui->spinMemoryViewRows->value());
     pSettings->debugger().setMemoryViewColumns(ui->spinMemoryViewColumns->value());
+    pSettings->debugger().setTraceSampleInterval(ui->spinTraceSampleInterval->value());
     pSettings->debugger().save();
     pMainWindow->updateDebuggerSettings();
 }
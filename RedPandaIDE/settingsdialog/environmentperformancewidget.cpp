@@ -45,6 +45,8 @@ void EnvironmentPerformanceWidget::doLoad()
         pSettings->codeCompletion().setClearWhenEditorHidden(true);
     }
 #endif
+    ui->spinBuildJobs->setValue(pSettings->environment().buildJobs());
+    ui->chkUseBuiltinProjectBuilder->setChecked(pSettings->environment().useBuiltinProjectBuilder());
 }
 
 void EnvironmentPerformanceWidget::doSave()
@@ -52,4 +54,7 @@ void EnvironmentPerformanceWidget::doSave()
     pSettings->codeCompletion().setClearWhenEditorHidden(ui->chkClearWhenEditorHidden->isChecked());
 
     pSettings->codeCompletion().save();
+    pSettings->environment().setBuildJobs(ui->spinBuildJobs->value());
+    pSettings->environment().setUseBuiltinProjectBuilder(ui->chkUseBuiltinProjectBuilder->isChecked());
+    pSettings->environment().save();
 }
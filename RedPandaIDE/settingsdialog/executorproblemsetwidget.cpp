@@ -37,6 +37,7 @@ void ExecutorProblemSetWidget::doLoad()
     ui->grpCompetitiveCompanion->setChecked(pSettings->executor().enableCompetitiveCompanion());
     ui->spinPortNumber->setValue(pSettings->executor().competivieCompanionPort());
     ui->chkIgnoreSpacesWhenValidatingCases->setChecked(pSettings->executor().ignoreSpacesWhenValidatingCases());
+    ui->spinFloatPrecision->setValue(pSettings->executor().caseValidationFloatPrecision());
 
     ui->cbFont->setCurrentFont(QFont(pSettings->executor().caseEditorFontName()));
     ui->spinFontSize->setValue(pSettings->executor().caseEditorFontSize());
@@ -44,6 +45,10 @@ void ExecutorProblemSetWidget::doLoad()
     ui->grpEnableTimeout->setChecked(pSettings->executor().enableCaseTimeout());
 
     ui->spinCaseTimeout->setValue(pSettings->executor().caseTimeout());
+    ui->grpEnableMemoryLimit->setChecked(pSettings->executor().enableCaseMemoryLimit());
+    ui->spinCaseMemoryLimit->setValue(pSettings->executor().caseMemoryLimit());
+    ui->spinCaseRunnerJobs->setValue(pSettings->executor().caseRunnerJobs());
+    ui->chkRunTimeLimitedCasesSerially->setChecked(pSettings->executor().runTimeLimitedCasesSerially());
 }
 
 void ExecutorProblemSetWidget::doSave()
@@ -52,11 +57,16 @@ void ExecutorProblemSetWidget::doSave()
     pSettings->executor().setEnableCompetitiveCompanion(ui->grpCompetitiveCompanion->isChecked());
     pSettings->executor().setCompetivieCompanionPort(ui->spinPortNumber->value());
     pSettings->executor().setIgnoreSpacesWhenValidatingCases(ui->chkIgnoreSpacesWhenValidatingCases->isChecked());
+    pSettings->executor().setCaseValidationFloatPrecision(ui->spinFloatPrecision->value());
     pSettings->executor().setCaseEditorFontName(ui->cbFont->currentFont().family());
     pSettings->executor().setCaseEditorFontOnlyMonospaced(ui->chkOnlyMonospaced->isChecked());
     pSettings->executor().setCaseEditorFontSize(ui->spinFontSize->value());
     pSettings->executor().setEnableCaseTimeout(ui->grpEnableTimeout->isChecked());
     pSettings->executor().setCaseTimeout(ui->spinCaseTimeout->value());
+    pSettings->executor().setEnableCaseMemoryLimit(ui->grpEnableMemoryLimit->isChecked());
+    pSettings->executor().setCaseMemoryLimit(ui->spinCaseMemoryLimit->value());
+    pSettings->executor().setCaseRunnerJobs(ui->spinCaseRunnerJobs->value());
+    pSettings->executor().setRunTimeLimitedCasesSerially(ui->chkRunTimeLimitedCasesSerially->isChecked());
     pSettings->executor().save();
     pMainWindow->applySettings();
 }
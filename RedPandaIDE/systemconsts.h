@@ -75,9 +75,11 @@
 #define RES_EXT "res"
 #define H_EXT "h"
 #define OBJ_EXT "o"
+#define DEP_EXT "d"
 #define DEF_EXT "def"
 #define LIB_EXT "a"
 #define GCH_EXT "gch"
+#define BUILD_FLAGS_EXT "flags"
 #define TEMPLATE_EXT "template"
 #define TEMPLATE_INFO_FILE "info.template"
 #define DEV_INTERNAL_OPEN "$__DEV_INTERNAL_OPEN"
@@ -91,6 +93,7 @@
 #define DEV_BOOKMARK_FILE "bookmarks.json"
 #define DEV_BREAKPOINTS_FILE "breakpoints.json"
 #define DEV_WATCH_FILE "watch.json"
+#define DEV_COMPILER_PROBES_FILE "compilerprobes.json"
 
 #ifdef Q_OS_WIN
 #   define PATH_SENSITIVITY Qt::CaseInsensitive
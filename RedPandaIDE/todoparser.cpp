@@ -18,82 +18,280 @@
 #include "mainwindow.h"
 #include "editor.h"
 #include "editorlist.h"
-#include "HighlighterManager.h"
-#include "qsynedit/Constants.h"
 
-TodoParser::TodoParser(QObject *parent) : QObject(parent),
-    mMutex(QMutex::Recursive)
+namespace {
+//what the lexer is in at the start of a line
+struct LexState {
+    enum class Type {
+        Code,
+        BlockComment,
+        LineComment, //continued by a backslash at the end of the previous line
+        String, //continued by a backslash at the end of the previous line
+        RawString
+    };
+    Type type;
+    QString delimiter; //of raw string
+
+    LexState():type(Type::Code) {}
+    bool operator==(const LexState& other) const {
+        return type == other.type && delimiter == other.delimiter;
+    }
+};
+
+bool isIdentChar(const QChar& ch)
 {
-    mThread = nullptr;
+    return ch=='_' || ch.isLetterOrNumber();
 }
 
-void TodoParser::parseFile(const QString &filename)
+void findTodo(const QString& line, int start, int end, QVector<int>& todos)
 {
-    QMutexLocker locker(&mMutex);
-    if (mThread) {
-        return;
-    }
-    mThread = new TodoThread(filename);
-    connect(mThread,&QThread::finished,
-            [this] {
-        QMutexLocker locker(&mMutex);
-        if (mThread) {
-            mThread->deleteLater();
-            mThread = nullptr;
+    int pos = line.indexOf("TODO:",start,Qt::CaseInsensitive);
+    if (pos>=0 && pos+5<=end)
+        todos.append(pos);
+}
+
+//only comments and literals are recognized, the rest of the code is skipped
+LexState scanLine(const QString& line, LexState state, QVector<int>& todos)
+{
+    todos.clear();
+    int pos = 0;
+    int len = line.length();
+    while (pos<len) {
+        switch (state.type) {
+        case LexState::Type::LineComment:
+            findTodo(line,pos,len,todos);
+            pos = len;
+            break;
+        case LexState::Type::BlockComment: {
+            int end = line.indexOf("*/",pos);
+            if (end<0) {
+                findTodo(line,pos,len,todos);
+                pos = len;
+            } else {
+                findTodo(line,pos,end,todos);
+                pos = end+2;
+                state.type = LexState::Type::Code;
+            }
+        }
+            break;
+        case LexState::Type::String:
+            if (line[pos]=='\\') {
+                pos+=2;
+            } else {
+                if (line[pos]==state.delimiter[0])
+                    state.type = LexState::Type::Code;
+                pos++;
+            }
+            break;
+        case LexState::Type::RawString: {
+            int end = line.indexOf(')'+state.delimiter+'"',pos);
+            if (end<0) {
+                pos = len;
+            } else {
+                pos = end+state.delimiter.length()+2;
+                state.type = LexState::Type::Code;
+            }
+        }
+            break;
+        case LexState::Type::Code: {
+            QChar ch = line[pos];
+            if (ch=='/' && pos+1<len && line[pos+1]=='/') {
+                state.type = LexState::Type::LineComment;
+            } else if (ch=='/' && pos+1<len && line[pos+1]=='*') {
+                state.type = LexState::Type::BlockComment;
+                pos+=2;
+            } else if (ch=='"' || ch=='\'') {
+                state.type = LexState::Type::String;
+                state.delimiter = ch;
+                pos++;
+            } else if (ch>='0' && ch<='9') {
+                //digit separators like 1'000 don't start char literals
+                while (pos<len && (isIdentChar(line[pos]) || line[pos]=='.' || line[pos]=='\''))
+                    pos++;
+            } else if (isIdentChar(ch)) {
+                int start = pos;
+                while (pos<len && isIdentChar(line[pos]))
+                    pos++;
+                //raw string literals, with optional encoding prefixes like u8R"(...)"
+                if (pos<len && line[pos]=='"' && line[pos-1]=='R'
+                        && QStringList({"R","LR","uR","UR","u8R"}).contains(line.mid(start,pos-start))) {
+                    int parenthesis = line.indexOf('(',pos+1);
+                    if (parenthesis>0) {
+                        state.type = LexState::Type::RawString;
+                        state.delimiter = line.mid(pos+1,parenthesis-pos-1);
+                        pos = parenthesis+1;
+                    }
+                }
+            } else {
+                pos++;
+            }
+        }
+            break;
         }
-    });
+    }
+    //line comments and strings end with the line, unless it's continued
+    if (state.type == LexState::Type::LineComment || state.type == LexState::Type::String) {
+        if (!line.endsWith('\\'))
+            state = LexState();
+    }
+    return state;
+}
+}
+
+struct TodoFileCache {
+    uint hash;
+    QStringList lines;
+    QVector<LexState> states; // state at the start of each line, and at the end of the file
+    QVector<QVector<int>> todos; // columns of the todo marks in each line
+};
+
+TodoParser::TodoParser(QObject *parent) : QObject(parent)
+{
+    mThread = new TodoThread();
     connect(mThread, &TodoThread::parseStarted,
-            pMainWindow, &MainWindow::onTodoParseStarted);
+            this, &TodoParser::parseStarted);
     connect(mThread, &TodoThread::todoFound,
-            pMainWindow, &MainWindow::onTodoParsing);
+            this, &TodoParser::todoFound);
     connect(mThread, &TodoThread::parseFinished,
-            pMainWindow, &MainWindow::onTodoParseFinished);
+            this, &TodoParser::parseFinished);
     mThread->start();
 }
 
+TodoParser::~TodoParser()
+{
+    mThread->stop();
+    mThread->wait();
+    delete mThread;
+}
+
+void TodoParser::parseFile(const QString &filename)
+{
+    QStringList lines;
+    if (!pMainWindow->editorList()->getContentFromOpenedEditor(filename,lines)) {
+        return;
+    }
+    mThread->addFile(filename,lines);
+}
+
 bool TodoParser::parsing() const
 {
-    return (mThread!=nullptr);
+    return mThread->busy();
 }
 
-TodoThread::TodoThread(const QString& filename, QObject *parent): QThread(parent)
+TodoThread::TodoThread(QObject *parent): QThread(parent),
+    mStop(false),
+    mBusy(false)
 {
-    mFilename = filename;
 }
 
-void TodoThread::run()
+void TodoThread::addFile(const QString &filename, const QStringList &lines)
 {
-    QSynedit::PHighlighter highlighter = highlighterManager.getCppHighlighter();
-    emit parseStarted(mFilename);
-    auto action = finally([this]{
-        emit parseFinished();
-    });
-    QStringList lines;
-    if (!pMainWindow->editorList()->getContentFromOpenedEditor(mFilename,lines)) {
-        return;
+    QMutexLocker locker(&mMutex);
+    //a file waiting in the queue is scanned with its latest contents
+    if (!mPendingContents.contains(filename)) {
+        if (mQueue.count()>=TODO_QUEUE_SIZE)
+            mPendingContents.remove(mQueue.takeFirst());
+        mQueue.append(filename);
     }
-    QSynedit::PHighlighterAttribute commentAttr = highlighter->getAttribute(SYNS_AttrComment);
-
-    highlighter->resetState();
-    for (int i =0;i<lines.count();i++) {
-        highlighter->setLine(lines[i],i);
-        while (!highlighter->eol()) {
-            QSynedit::PHighlighterAttribute attr;
-            attr = highlighter->getTokenAttribute();
-            if (attr == commentAttr) {
-                QString token = highlighter->getToken();
-                int pos = token.indexOf("TODO:",0,Qt::CaseInsensitive);
-                if (pos>=0) {
-                    emit todoFound(
-                                mFilename,
-                                i+1,
-                                pos+highlighter->getTokenPos(),
-                                lines[i].trimmed()
-                                );
-                }
+    mPendingContents.insert(filename,lines);
+    mCondition.wakeOne();
+}
+
+void TodoThread::stop()
+{
+    QMutexLocker locker(&mMutex);
+    mStop = true;
+    mCondition.wakeOne();
+}
+
+bool TodoThread::busy()
+{
+    QMutexLocker locker(&mMutex);
+    return mBusy || !mQueue.isEmpty();
+}
+
+PTodoFileCache TodoThread::scan(const QString &filename, const QStringList &lines)
+{
+    PTodoFileCache oldCache = mCache.value(filename);
+    uint hash = qHash(lines);
+    touchCache(filename);
+    if (oldCache && oldCache->hash == hash && oldCache->lines == lines)
+        return oldCache;
+
+    PTodoFileCache cache = std::make_shared<TodoFileCache>();
+    cache->hash = hash;
+    cache->lines = lines;
+    int count = lines.count();
+    cache->states.resize(count+1);
+    cache->todos.resize(count);
+
+    //lines not changed since the last scan
+    int first = 0;
+    int last = count;
+    int oldCount = 0;
+    if (oldCache) {
+        oldCount = oldCache->lines.count();
+        int minCount = std::min(count, oldCount);
+        while (first<minCount && oldCache->lines[first]==lines[first])
+            first++;
+        while (last>first && count-last<minCount-first
+               && oldCache->lines[oldCount-count+last-1]==lines[last-1])
+            last--;
+        for (int i=0;i<first;i++) {
+            cache->states[i] = oldCache->states[i];
+            cache->todos[i] = oldCache->todos[i];
+        }
+        cache->states[first] = oldCache->states[first];
+    }
+    int i=first;
+    while (i<count) {
+        //unchanged lines after the edit can be reused once they start in the same state
+        if (i>=last && cache->states[i]==oldCache->states[oldCount-count+i]) {
+            for (;i<count;i++) {
+                cache->states[i+1] = oldCache->states[oldCount-count+i+1];
+                cache->todos[i] = oldCache->todos[oldCount-count+i];
             }
-            highlighter->next();
+            break;
         }
+        cache->states[i+1] = scanLine(lines[i],cache->states[i],cache->todos[i]);
+        i++;
+    }
+    mCache.insert(filename,cache);
+    return cache;
+}
+
+void TodoThread::touchCache(const QString &filename)
+{
+    mCacheOrder.removeOne(filename);
+    mCacheOrder.append(filename);
+    while (mCacheOrder.count()>TODO_CACHE_SIZE)
+        mCache.remove(mCacheOrder.takeFirst());
+}
+
+void TodoThread::run()
+{
+    while (true) {
+        QString filename;
+        QStringList lines;
+        {
+            QMutexLocker locker(&mMutex);
+            mBusy = false;
+            while (!mStop && mQueue.isEmpty())
+                mCondition.wait(&mMutex);
+            if (mStop)
+                return;
+            filename = mQueue.takeFirst();
+            lines = mPendingContents.take(filename);
+            mBusy = true;
+        }
+        emit parseStarted(filename);
+        PTodoFileCache cache = scan(filename, lines);
+        for (int i=0;i<cache->todos.count();i++) {
+            foreach (int ch, cache->todos[i]) {
+                emit todoFound(filename, i+1, ch, cache->lines[i].trimmed());
+            }
+        }
+        emit parseFinished();
     }
 }
 
@@ -19,7 +19,9 @@
 
 #include <QObject>
 #include <QThread>
+#include <QHash>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QAbstractListModel>
 
 struct TodoItem {
@@ -53,36 +55,66 @@ public:
     int columnCount(const QModelIndex &parent) const override;
 };
 
+//max number of files waiting to be scanned
+#define TODO_QUEUE_SIZE 64
+//max number of files whose scan results are kept
+#define TODO_CACHE_SIZE 128
+
+struct TodoFileCache;
+using PTodoFileCache = std::shared_ptr<TodoFileCache>;
+
+/**
+ * @brief The worker thread scanning files for TODO comments.
+ *
+ * Requests for the same file are coalesced while they wait in the queue.
+ * Scan results are cached per file, and only lines changed since the last
+ * scan of a file are scanned again.
+ */
 class TodoThread: public QThread
 {
     Q_OBJECT
 public:
-    explicit TodoThread(const QString& filename, QObject* parent = nullptr);
+    explicit TodoThread(QObject* parent = nullptr);
+    void addFile(const QString& filename, const QStringList& lines);
+    void stop();
+    bool busy();
 signals:
     void parseStarted(const QString& filename);
     void todoFound(const QString& filename, int lineNo, int ch, const QString& line);
     void parseFinished();
 private:
-    QString mFilename;
+    PTodoFileCache scan(const QString& filename, const QStringList& lines);
+    void touchCache(const QString& filename);
+private:
+    QMutex mMutex;
+    QWaitCondition mCondition;
+    QStringList mQueue;
+    QHash<QString,QStringList> mPendingContents;
+    bool mStop;
+    bool mBusy;
+    //only used in the thread
+    QHash<QString,PTodoFileCache> mCache;
+    QStringList mCacheOrder;
 
     // QThread interface
 protected:
     void run() override;
 };
 
-using PTodoThread = std::shared_ptr<TodoThread>;
-
 class TodoParser : public QObject
 {
     Q_OBJECT
 public:
     explicit TodoParser(QObject *parent = nullptr);
+    ~TodoParser();
     void parseFile(const QString& filename);
     bool parsing() const;
-
+signals:
+    void parseStarted(const QString& filename);
+    void todoFound(const QString& filename, int lineNo, int ch, const QString& line);
+    void parseFinished();
 private:
     TodoThread* mThread;
-    QMutex mMutex;
 };
 
 using PTodoParser = std::shared_ptr<TodoParser>;
@@ -11,6 +11,9 @@
 #include "parser/cppparser.h"
 #include "compiler/executablerunner.h"
 #include <QMimeDatabase>
+#include <QFile>
+#include <QSet>
+#include <QVector>
 #ifdef Q_OS_WIN
 #include <windows.h>
 #endif
@@ -391,6 +394,47 @@ bool isGreenEdition()
 #endif
 }
 
+int physicalCoreCount()
+{
+    static int count = 0;
+    if (count>0)
+        return count;
+#ifdef Q_OS_WIN
+    DWORD size = 0;
+    GetLogicalProcessorInformation(NULL, &size);
+    if (size>0) {
+        QVector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infos(size/sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        if (GetLogicalProcessorInformation(infos.data(), &size)) {
+            foreach(const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& info, infos) {
+                if (info.Relationship == RelationProcessorCore)
+                    count++;
+            }
+        }
+    }
+#elif defined(Q_OS_LINUX)
+    QFile file("/proc/cpuinfo");
+    if (file.open(QFile::ReadOnly)) {
+        QSet<QString> cores;
+        QString physicalId;
+        foreach (const QByteArray& line, file.readAll().split('\n')) {
+            int pos = line.indexOf(':');
+            if (pos<0)
+                continue;
+            QString name = QString::fromLatin1(line.left(pos)).trimmed();
+            QString value = QString::fromLatin1(line.mid(pos+1)).trimmed();
+            if (name == "physical id")
+                physicalId = value;
+            else if (name == "core id")
+                cores.insert(physicalId+":"+value);
+        }
+        count = cores.count();
+    }
+#endif
+    if (count<=0)
+        count = std::max(1,QThread::idealThreadCount());
+    return count;
+}
+
 QByteArray runAndGetOutput(const QString &cmd, const QString& workingDir, const QStringList& arguments,
                            const QByteArray &inputContent, bool inheritEnvironment,
                            const QProcessEnvironment& env)
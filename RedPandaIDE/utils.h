@@ -125,6 +125,9 @@ void executeFile(const QString& fileName,
 
 bool isGreenEdition();
 
+//number of physical cpu cores (logical processors if it can't be detected)
+int physicalCoreCount();
+
 #ifdef Q_OS_WIN
 bool readRegistry(HKEY key,const QByteArray& subKey, const QByteArray& name, QString& value);
 #endif
@@ -65,6 +65,69 @@ QString GitManager::rootFolder(const QString &folder)
     return runGit(folder,args).trimmed();
 }
 
+bool GitManager::getStatus(const QString &folder, GitStatus &status)
+{
+    status = GitStatus();
+    QStringList args;
+    //don't refresh the index, or the watchers on it will fire again
+    args.append("--no-optional-locks");
+    args.append("status");
+    args.append("--porcelain=v2");
+    args.append("-z");
+    args.append("--branch");
+    args.append("--untracked-files=no");
+    QList<QByteArray> records = runGitRaw(folder,args).split('\0');
+    for (int i=0;i<records.length();i++) {
+        const QByteArray& record = records[i];
+        if (record.startsWith("# branch.")) {
+            status.inRepository = true;
+            if (record.startsWith("# branch.head "))
+                status.branch = QString::fromUtf8(record.mid(QByteArray("# branch.head ").length()));
+            continue;
+        }
+        if (record.length()<5 || record[1]!=' ')
+            continue;
+        // 1 XY sub mH mI mW hH hI path
+        // 2 XY sub mH mI mW hH hI score path<NUL>origPath
+        // u XY sub m1 m2 m3 mW h1 h2 h3 path
+        int fieldsBeforePath;
+        switch(record[0]) {
+        case '1':
+            fieldsBeforePath = 8;
+            break;
+        case '2':
+            fieldsBeforePath = 9;
+            break;
+        case 'u':
+            fieldsBeforePath = 10;
+            break;
+        default:
+            continue;
+        }
+        int pos = 0;
+        for (int j=0;j<fieldsBeforePath && pos>=0;j++) {
+            pos = record.indexOf(' ',pos);
+            if (pos>=0)
+                pos++;
+        }
+        if (record[0]=='2')
+            i++; //skip the original path of the renamed file
+        if (pos<0)
+            continue;
+        QString path = QString::fromUtf8(record.mid(pos));
+        if (record[0]=='u') {
+            status.conflicts.append(path);
+            status.changedFiles.append(path);
+            continue;
+        }
+        if (record[2]!='.')
+            status.stagedFiles.append(path);
+        if (record[3]!='.')
+            status.changedFiles.append(path);
+    }
+    return status.inRepository;
+}
+
 bool GitManager::isFileInRepository(const QFileInfo& fileInfo)
 {
     QStringList args;
@@ -199,7 +262,14 @@ QStringList GitManager::listFiles(const QString &folder)
 {
     QStringList args;
     args.append("ls-files");
-    return textToLines(runGit(folder,args));
+    //-z: paths are neither quoted nor escaped
+    args.append("-z");
+    QStringList result;
+    foreach (const QByteArray& path, runGitRaw(folder,args).split('\0')) {
+        if (!path.isEmpty())
+            result.append(QString::fromUtf8(path));
+    }
+    return result;
 }
 
 QStringList GitManager::listStagedFiles(const QString &folder)
@@ -575,9 +645,20 @@ bool GitManager::isValid()
 }
 
 QString GitManager::runGit(const QString& workingFolder, const QStringList &args)
+{
+    QString output = runGitRaw(workingFolder, args);
+    output = escapeUTF8String(output.toUtf8());
+//    qDebug()<<output;
+    emit gitCmdFinished(output);
+//    if (output.startsWith("fatal:"))
+//        throw GitError(output);
+    return output;
+}
+
+QByteArray GitManager::runGitRaw(const QString &workingFolder, const QStringList &args)
 {
     if (!isValid())
-        return "";
+        return QByteArray();
     QFileInfo fileInfo(pSettings->vcs().gitPath());
     if (!fileInfo.exists())
         return "fatal: git doesn't exist";
@@ -597,19 +678,13 @@ QString GitManager::runGit(const QString& workingFolder, const QStringList &args
     env.insert("LANGUAGE","en");
     env.insert("GIT_ASKPASS",includeTrailingPathDelimiter(pSettings->dirs().appLibexecDir())+"redpanda-git-askpass");
 #endif
-    QString output = runAndGetOutput(
+    return runAndGetOutput(
                 fileInfo.absoluteFilePath(),
                 workingFolder,
                 args,
                 "",
                 false,
                 env);
-    output = escapeUTF8String(output.toUtf8());
-//    qDebug()<<output;
-    emit gitCmdFinished(output);
-//    if (output.startsWith("fatal:"))
-//        throw GitError(output);
-    return output;
 }
 
 QString GitManager::escapeUTF8String(const QByteArray &rawString)
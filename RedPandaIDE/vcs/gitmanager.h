@@ -23,6 +23,7 @@ public:
     bool hasRepository(const QString& folder, QString& currentBranch);
 
     QString rootFolder(const QString& folder);
+    bool getStatus(const QString& folder, GitStatus& status);
 
     bool isFileInRepository(const QFileInfo& fileInfo);
     bool isFileStaged(const QFileInfo& fileInfo);
@@ -100,6 +101,7 @@ signals:
     void gitCmdFinished(const QString& message);
 private:
     QString runGit(const QString& workingFolder, const QStringList& args);
+    QByteArray runGitRaw(const QString& workingFolder, const QStringList& args);
 
     QString escapeUTF8String(const QByteArray& rawString);
 private:
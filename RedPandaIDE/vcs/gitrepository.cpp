@@ -2,17 +2,85 @@
 #include "gitmanager.h"
 
 #include <QDir>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+static void readStatusSnapshot(GitManager& manager, const QString& folder, const QString& gitDir,
+                               bool listFiles, GitStatusSnapshot& snapshot)
+{
+    //take the times first, changes made while git is running will be seen next time
+    QDir dir(gitDir);
+    snapshot.indexTime = gitDir.isEmpty()?QDateTime():QFileInfo(dir.filePath("index")).lastModified();
+    snapshot.headTime = gitDir.isEmpty()?QDateTime():QFileInfo(dir.filePath("HEAD")).lastModified();
+    manager.getStatus(folder, snapshot.status);
+    snapshot.filesListed = listFiles;
+    snapshot.files.clear();
+    if (listFiles && snapshot.status.inRepository)
+        snapshot.files = manager.listFiles(folder);
+}
+
+GitStatusThread::GitStatusThread(const QString &folder, const QString &gitDir,
+                                 bool listFiles, int serial, QObject *parent):
+    QThread(parent),
+    mFolder(folder),
+    mGitDir(gitDir),
+    mListFiles(listFiles),
+    mSerial(serial)
+{
+}
+
+const QString &GitStatusThread::folder() const
+{
+    return mFolder;
+}
+
+int GitStatusThread::serial() const
+{
+    return mSerial;
+}
+
+const GitStatusSnapshot &GitStatusThread::snapshot() const
+{
+    return mSnapshot;
+}
+
+void GitStatusThread::run()
+{
+    GitManager manager;
+    readStatusSnapshot(manager, mFolder, mGitDir, mListFiles, mSnapshot);
+}
 
 GitRepository::GitRepository(const QString& folder, QObject *parent)
     : QObject{parent},
-      mInRepository(false)
+      mInRepository(false),
+      mStatusOutdated(true),
+      mFilesListOutdated(true),
+      mStatusSerial(0),
+      mStatusThread(nullptr),
+      mRefreshPending(false)
 {
     mManager = new GitManager();
+    mWatcher = new QFileSystemWatcher(this);
+    connect(mWatcher, &QFileSystemWatcher::fileChanged,
+            this, &GitRepository::onWatchedPathChanged);
+    connect(mWatcher, &QFileSystemWatcher::directoryChanged,
+            this, &GitRepository::onWatchedPathChanged);
+    mRefreshTimer = new QTimer(this);
+    mRefreshTimer->setSingleShot(true);
+    mRefreshTimer->setInterval(GIT_STATUS_REFRESH_DELAY);
+    connect(mRefreshTimer, &QTimer::timeout,
+            this, &GitRepository::startBackgroundRefresh);
     setFolder(folder);
 }
 
 GitRepository::~GitRepository()
 {
+    if (mStatusThread) {
+        disconnect(mStatusThread, nullptr, this, nullptr);
+        mStatusThread->wait();
+        delete mStatusThread;
+    }
     delete mManager;
 }
 
@@ -24,6 +92,9 @@ const QString &GitRepository::folder() const
 void GitRepository::createRepository()
 {
     mManager->createRepository(mRealFolder);
+    mGitDir = findGitDir(mRealFolder);
+    mFilesListOutdated = true;
+    outdate();
 }
 
 bool GitRepository::hasRepository(QString& currentBranch)
@@ -34,28 +105,38 @@ bool GitRepository::hasRepository(QString& currentBranch)
 
 bool GitRepository::add(const QString &path, QString& output)
 {
-    return mManager->add(mFolder,path, output);
+    bool result = mManager->add(mFolder,path, output);
+    outdate();
+    return result;
 }
 
 bool GitRepository::remove(const QString &path, QString& output)
 {
-    return mManager->remove(mFolder,path, output);
+    bool result = mManager->remove(mFolder,path, output);
+    outdate();
+    return result;
 }
 
 bool GitRepository::rename(const QString &oldName, const QString &newName, QString& output)
 {
-    return mManager->rename(mFolder, oldName, newName,output);
+    bool result = mManager->rename(mFolder, oldName, newName,output);
+    outdate();
+    return result;
 }
 
 bool GitRepository::restore(const QString &path, QString& output)
 {
-    return mManager->restore(mFolder, path, output);
+    bool result = mManager->restore(mFolder, path, output);
+    outdate();
+    return result;
 }
 
 QSet<QString> GitRepository::listFiles(bool refresh)
 {
-    if (refresh)
+    if (refresh) {
+        outdate();
         update();
+    }
     return mFilesInRepositories;
 }
 
@@ -66,43 +147,98 @@ bool GitRepository::clone(const QString &url, QString& output)
 
 bool GitRepository::commit(const QString &message, QString& output, bool autoStage)
 {
-    return mManager->commit(mRealFolder, message, autoStage, output);
+    bool result = mManager->commit(mRealFolder, message, autoStage, output);
+    outdate();
+    return result;
 }
 
 bool GitRepository::revert(QString& output)
 {
-    return mManager->revert(mRealFolder, output);
+    bool result = mManager->revert(mRealFolder, output);
+    outdate();
+    return result;
 }
 
 void GitRepository::setFolder(const QString &newFolder)
 {
+    //the root of a repository doesn't move, only look for it again when there's none
+    if (newFolder == mFolder && !mGitDir.isEmpty()) {
+        update();
+        return;
+    }
     mFolder = newFolder;
-    if (!newFolder.isEmpty())
-        mRealFolder = mManager->rootFolder(mFolder);
-    else
-        mRealFolder = newFolder;
+    mRealFolder = newFolder;
+    mGitDir.clear();
+    if (!newFolder.isEmpty() && mManager->isValid()) {
+        QString rootFolder = mManager->rootFolder(mFolder);
+        if (QDir::isAbsolutePath(rootFolder) && QFileInfo(rootFolder).isDir()) {
+            mRealFolder = rootFolder;
+            mGitDir = findGitDir(rootFolder);
+        }
+    }
+    mFilesListOutdated = true;
+    //nothing is cached for the new folder yet
+    outdate();
     update();
 }
 
 void GitRepository::update()
 {
     if (!mManager->isValid() || mFolder.isEmpty()) {
-        mInRepository = false;
-        mBranch = "";
-        mFilesInRepositories.clear();
-        mChangedFiles.clear();
-        mStagedFiles.clear();
-        mConflicts.clear();
-    } else {
-        mInRepository = mManager->hasRepository(mRealFolder,mBranch);
-        convertFilesListToSet(mManager->listFiles(mRealFolder),mFilesInRepositories);
-        convertFilesListToSet(mManager->listChangedFiles(mRealFolder),mChangedFiles);
-        convertFilesListToSet(mManager->listStagedFiles(mRealFolder),mStagedFiles);
-        convertFilesListToSet(mManager->listConflicts(mRealFolder),mConflicts);
-//        qDebug()<<"update"<<mRealFolder<<mBranch;
-//        qDebug()<<mFilesInRepositories;
-//        qDebug()<<mChangedFiles;
-//        qDebug()<<mStagedFiles;
+        clearStatus();
+    } else if (mStatusOutdated) {
+        refresh();
+    } else if (gitFilesChanged() && !mStatusThread && !mRefreshTimer->isActive()) {
+        //changed by other git commands before the watcher tells us
+        startBackgroundRefresh();
+    }
+}
+
+void GitRepository::invalidate()
+{
+    //the cached status is used until the background refresh ends
+    mRefreshTimer->start();
+}
+
+void GitRepository::outdate()
+{
+    mStatusOutdated = true;
+}
+
+void GitRepository::onWatchedPathChanged()
+{
+    mRefreshTimer->start();
+}
+
+void GitRepository::startBackgroundRefresh()
+{
+    if (!mManager->isValid() || mFolder.isEmpty())
+        return;
+    if (mStatusThread) {
+        mRefreshPending = true;
+        return;
+    }
+    mStatusThread = new GitStatusThread(mRealFolder, mGitDir, needListFiles(), mStatusSerial);
+    connect(mStatusThread, &QThread::finished,
+            this, &GitRepository::onStatusThreadFinished);
+    mStatusThread->start();
+}
+
+void GitRepository::onStatusThreadFinished()
+{
+    GitStatusThread* thread = mStatusThread;
+    mStatusThread = nullptr;
+    //a status read after the thread started is newer
+    if (thread->serial() == mStatusSerial && thread->folder() == mRealFolder) {
+        //if it's changed again while git was running, the pending refresh reads it
+        bool changed = applySnapshot(thread->snapshot());
+        if (changed)
+            emit statusChanged();
+    }
+    thread->deleteLater();
+    if (mRefreshPending) {
+        mRefreshPending = false;
+        mRefreshTimer->start();
     }
 }
 
@@ -120,3 +256,143 @@ void GitRepository::convertFilesListToSet(const QStringList &filesList, QSet<QSt
     }
 }
 
+bool GitRepository::gitFilesChanged() const
+{
+    return !mGitDir.isEmpty()
+            && (gitFileTime("index") != mIndexTime
+                || gitFileTime("HEAD") != mHeadTime);
+}
+
+bool GitRepository::needListFiles() const
+{
+    //tracked files only change with the index
+    return mFilesListOutdated || gitFileTime("index") != mListedIndexTime;
+}
+
+QDateTime GitRepository::gitFileTime(const QString &name) const
+{
+    if (mGitDir.isEmpty())
+        return QDateTime();
+    return QFileInfo(QDir(mGitDir).filePath(name)).lastModified();
+}
+
+void GitRepository::refresh()
+{
+    mRefreshTimer->stop();
+    mRefreshPending = false;
+    mStatusSerial++;
+    if (mGitDir.isEmpty())
+        mGitDir = findGitDir(mRealFolder);
+    GitStatusSnapshot snapshot;
+    readStatusSnapshot(*mManager, mRealFolder, mGitDir, needListFiles(), snapshot);
+    applySnapshot(snapshot);
+}
+
+bool GitRepository::applySnapshot(const GitStatusSnapshot &snapshot)
+{
+    bool oldInRepository = mInRepository;
+    QString oldBranch = mBranch;
+    QSet<QString> oldFiles = mFilesInRepositories;
+    QSet<QString> oldChangedFiles = mChangedFiles;
+    QSet<QString> oldStagedFiles = mStagedFiles;
+    QSet<QString> oldConflicts = mConflicts;
+
+    mInRepository = snapshot.status.inRepository;
+    mBranch = snapshot.status.branch;
+    convertFilesListToSet(snapshot.status.changedFiles,mChangedFiles);
+    convertFilesListToSet(snapshot.status.stagedFiles,mStagedFiles);
+    convertFilesListToSet(snapshot.status.conflicts,mConflicts);
+    if (snapshot.filesListed) {
+        convertFilesListToSet(snapshot.files,mFilesInRepositories);
+        mListedIndexTime = snapshot.indexTime;
+        mFilesListOutdated = false;
+    }
+    mIndexTime = snapshot.indexTime;
+    mHeadTime = snapshot.headTime;
+    mStatusOutdated = false;
+    updateWatchedPaths();
+//        qDebug()<<"update"<<mRealFolder<<mBranch;
+//        qDebug()<<mFilesInRepositories;
+//        qDebug()<<mChangedFiles;
+//        qDebug()<<mStagedFiles;
+    return oldInRepository != mInRepository
+            || oldBranch != mBranch
+            || oldFiles != mFilesInRepositories
+            || oldChangedFiles != mChangedFiles
+            || oldStagedFiles != mStagedFiles
+            || oldConflicts != mConflicts;
+}
+
+void GitRepository::clearStatus()
+{
+    mRefreshTimer->stop();
+    mRefreshPending = false;
+    mStatusSerial++;
+    mInRepository = false;
+    mBranch = "";
+    mFilesInRepositories.clear();
+    mChangedFiles.clear();
+    mStagedFiles.clear();
+    mConflicts.clear();
+    mFilesListOutdated = true;
+    mStatusOutdated = true;
+    updateWatchedPaths();
+}
+
+void GitRepository::updateWatchedPaths()
+{
+    QSet<QString> paths;
+    if (mInRepository && !mGitDir.isEmpty()) {
+        //index and HEAD are replaced by renaming, watching the folder sees that too
+        QDir gitDir(mGitDir);
+        paths.insert(mGitDir);
+        paths.insert(gitDir.filePath("index"));
+        paths.insert(gitDir.filePath("HEAD"));
+        paths.insert(mRealFolder);
+        foreach (const QString& file, mFilesInRepositories) {
+            if (paths.count() >= GIT_MAX_WATCHED_PATHS)
+                break;
+            paths.insert(QFileInfo(file).absolutePath());
+        }
+        foreach (const QString& file, mFilesInRepositories) {
+            if (paths.count() >= GIT_MAX_WATCHED_PATHS)
+                break;
+            paths.insert(file);
+        }
+    }
+    QStringList watchedPaths = mWatcher->files() + mWatcher->directories();
+    QStringList oldPaths;
+    foreach (const QString& path, watchedPaths) {
+        if (!paths.contains(path))
+            oldPaths.append(path);
+        else
+            paths.remove(path);
+    }
+    if (!oldPaths.isEmpty())
+        mWatcher->removePaths(oldPaths);
+    QStringList newPaths;
+    foreach (const QString& path, paths) {
+        if (QFileInfo::exists(path))
+            newPaths.append(path);
+    }
+    if (!newPaths.isEmpty())
+        mWatcher->addPaths(newPaths);
+}
+
+QString GitRepository::findGitDir(const QString &rootFolder)
+{
+    QDir dir(rootFolder);
+    QFileInfo info(dir.filePath(".git"));
+    if (info.isDir())
+        return info.absoluteFilePath();
+    //worktrees and submodules have a .git file pointing to the real one
+    if (info.isFile()) {
+        QFile file(info.absoluteFilePath());
+        if (file.open(QFile::ReadOnly)) {
+            QString line = QString::fromUtf8(file.readLine()).trimmed();
+            if (line.startsWith("gitdir:"))
+                return QDir::cleanPath(dir.absoluteFilePath(line.mid(7).trimmed()));
+        }
+    }
+    return QString();
+}
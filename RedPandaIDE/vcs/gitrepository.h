@@ -1,13 +1,50 @@
 #ifndef GITREPOSITORY_H
 #define GITREPOSITORY_H
 
+#include <QDateTime>
 #include <QFileInfo>
 #include <QObject>
 #include <QSet>
+#include <QThread>
 #include <memory>
 #include "gitutils.h"
 
+//wait for file changes to settle before refreshing the status
+#define GIT_STATUS_REFRESH_DELAY 500
+#define GIT_MAX_WATCHED_PATHS 1024
+
+struct GitStatusSnapshot {
+    GitStatus status;
+    bool filesListed;
+    QStringList files;
+    //modification times of .git/index and .git/HEAD when the status was read
+    QDateTime indexTime;
+    QDateTime headTime;
+};
+
 class GitManager;
+class GitStatusThread : public QThread {
+    Q_OBJECT
+public:
+    GitStatusThread(const QString& folder, const QString& gitDir,
+                    bool listFiles, int serial, QObject *parent = nullptr);
+    const QString &folder() const;
+    int serial() const;
+    const GitStatusSnapshot &snapshot() const;
+
+    // QThread interface
+protected:
+    void run() override;
+private:
+    QString mFolder;
+    QString mGitDir;
+    bool mListFiles;
+    int mSerial;
+    GitStatusSnapshot mSnapshot;
+};
+
+class QFileSystemWatcher;
+class QTimer;
 class GitRepository : public QObject
 {
     Q_OBJECT
@@ -66,11 +103,21 @@ public:
 
 
     void setFolder(const QString &newFolder);
+    //re-read the status only if it's outdated by our own git commands;
+    //changes made by others are read in the background
     void update();
+    //the status may be changed, re-read it in the background
+    void invalidate();
 
     const QString &realFolder() const;
 
 signals:
+    //status is refreshed in the background after the repository is changed
+    void statusChanged();
+private slots:
+    void onWatchedPathChanged();
+    void startBackgroundRefresh();
+    void onStatusThreadFinished();
 private:
     QString mRealFolder;
     QString mFolder;
@@ -81,8 +128,30 @@ private:
     QSet<QString> mChangedFiles;
     QSet<QString> mStagedFiles;
     QSet<QString> mConflicts;
+    QString mGitDir;
+    bool mStatusOutdated;
+    bool mFilesListOutdated;
+    QDateTime mIndexTime;
+    QDateTime mHeadTime;
+    QDateTime mListedIndexTime;
+    int mStatusSerial;
+    QFileSystemWatcher* mWatcher;
+    QTimer* mRefreshTimer;
+    GitStatusThread* mStatusThread;
+    bool mRefreshPending;
 private:
     void convertFilesListToSet(const QStringList& filesList,QSet<QString>& set);
+    //the next update() re-reads the status, the results of our own git
+    //commands are wanted right away
+    void outdate();
+    bool gitFilesChanged() const;
+    bool needListFiles() const;
+    QDateTime gitFileTime(const QString& name) const;
+    void refresh();
+    bool applySnapshot(const GitStatusSnapshot& snapshot);
+    void clearStatus();
+    void updateWatchedPaths();
+    static QString findGitDir(const QString& rootFolder);
 };
 
 #endif // GITREPOSITORY_H
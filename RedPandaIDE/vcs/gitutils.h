@@ -3,6 +3,7 @@
 
 #include <QDateTime>
 #include <QString>
+#include <QStringList>
 #include <memory>
 
 
@@ -45,4 +46,14 @@ struct GitCommitInfo {
 
 using PGitCommitInfo = std::shared_ptr<GitCommitInfo>;
 
+struct GitStatus {
+    bool inRepository;
+    QString branch;
+    //paths are relative to the repository root
+    QStringList stagedFiles;
+    QStringList changedFiles;
+    QStringList conflicts;
+    GitStatus():inRepository(false) {}
+};
+
 #endif // GITUTILS_H
@@ -31,7 +31,8 @@ ClassBrowserModel::ClassBrowserModel(QObject *parent):QAbstractItemModel(parent)
     mRoot = new ClassBrowserNode();
     mRoot->parent = nullptr;
     mRoot->statement = PStatement();
-//    mRoot->childrenFetched = true;
+    mRoot->childrenFetched = true;
+    mRoot->hasChildren = false;
     mUpdating = false;
     mUpdateCount = 0;
 }
@@ -77,11 +78,9 @@ bool ClassBrowserModel::hasChildren(const QModelIndex &parent) const
         return mRoot->children.count()>0;
     } else {
         parentNode = static_cast<ClassBrowserNode *>(parent.internalPointer());
-//        if (parentNode->childrenFetched)
-        return parentNode->children.count()>0;
-//        if (parentNode->statement)
-//            return !parentNode->statement->children.isEmpty();
-//        return false;
+        if (parentNode->childrenFetched)
+            return parentNode->children.count()>0;
+        return parentNode->hasChildren;
     }
 }
 
@@ -101,37 +100,43 @@ int ClassBrowserModel::columnCount(const QModelIndex&) const
     return 1;
 }
 
-//void ClassBrowserModel::fetchMore(const QModelIndex &parent)
-//{
-//    if (!parent.isValid()) { // top level
-//        return;
-//    }
-
-//    ClassBrowserNode *parentNode = static_cast<ClassBrowserNode *>(parent.internalPointer());
-//    if (!parentNode->childrenFetched) {
-//        parentNode->childrenFetched = true;
-//        if (parentNode->statement && !parentNode->statement->children.isEmpty()) {
-//            filterChildren(parentNode, parentNode->statement->children);
-//            beginInsertRows(parent,0,parentNode->children.count());
-//            endInsertRows();
-//        }
-//    }
-//}
-
-//bool ClassBrowserModel::canFetchMore(const QModelIndex &parent) const
-//{
-//    if (!parent.isValid()) { // top level
-//        return false;
-//    }
-//    ClassBrowserNode *parentNode = static_cast<ClassBrowserNode *>(parent.internalPointer());
-//    if (!parentNode->childrenFetched) {
-//        if (parentNode->statement && !parentNode->statement->children.isEmpty())
-//            return true;
-//        else
-//            parentNode->childrenFetched = true;
-//    }
-//    return false;
-//}
+void ClassBrowserModel::fetchMore(const QModelIndex &parent)
+{
+    if (!parent.isValid()) { // top level
+        return;
+    }
+
+    ClassBrowserNode *parentNode = static_cast<ClassBrowserNode *>(parent.internalPointer());
+    if (parentNode->childrenFetched)
+        return;
+    //if the parser is busy, the children are filled when it ends
+    parentNode->childrenFetched = true;
+    if (!mParser || !mParser->freeze())
+        return;
+    auto action = finally([this]{
+        mParser->unFreeze();
+    });
+    ClassBrowserNode newNode;
+    newNode.parent = nullptr;
+    newNode.statement = parentNode->statement;
+    fetchChildren(&newNode);
+    if (newNode.children.isEmpty())
+        return;
+    beginInsertRows(parent,0,newNode.children.count()-1);
+    parentNode->children = newNode.children;
+    foreach (ClassBrowserNode* child, parentNode->children)
+        child->parent = parentNode;
+    endInsertRows();
+}
+
+bool ClassBrowserModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) { // top level
+        return false;
+    }
+    ClassBrowserNode *parentNode = static_cast<ClassBrowserNode *>(parent.internalPointer());
+    return !parentNode->childrenFetched && parentNode->hasChildren;
+}
 
 QVariant ClassBrowserModel::data(const QModelIndex &index, int role) const
 {
@@ -189,6 +194,8 @@ void ClassBrowserModel::setParser(const PCppParser &newCppParser)
                    this,
                    &ClassBrowserModel::fillStatements);
     }
+    if (mParser != newCppParser)
+        mFilledFile.clear();
     mParser = newCppParser;
     if (mParser) {
         connect(mParser.get(),
@@ -206,6 +213,7 @@ void ClassBrowserModel::clear()
     mRoot->children.clear();
     mNodes.clear();
     mDummyStatements.clear();
+    mFilledFile.clear();
     endResetModel();
 }
 
@@ -217,57 +225,187 @@ void ClassBrowserModel::fillStatements()
             return;
         mUpdating = true;
     }
-    beginResetModel();
-    clear();
-    {
-        auto action = finally([this]{
-            endResetModel();
-            mUpdating = false;
-        });
-        if (!mParser)
-            return;
-        if (!mParser->enabled())
-            return;
-        if (!mParser->freeze())
-            return;
-        {
-            auto action2 = finally([this]{
-                mParser->unFreeze();
-            });
-            QString mParserSerialId = mParser->serialId();
-            if (!mCurrentFile.isEmpty()) {
-                // QSet<QString> includedFiles = mParser->getFileIncludes(mCurrentFile);
-
-                addMembers();
-                // Remember selection
-//                  if fLastSelection <> '' then
-//                    ReSelect;
-            }
+    auto action = finally([this]{
+        mUpdating = false;
+    });
+    if (!mParser || !mParser->enabled() || mCurrentFile.isEmpty()) {
+        clear();
+        return;
+    }
+    //keep showing the last statements while parsing
+    if (!mParser->freeze())
+        return;
+    auto action2 = finally([this]{
+        mParser->unFreeze();
+    });
+    //build the new tree aside, and merge it into the shown one;
+    //only the children of the nodes expanded in the view are built
+    ClassBrowserNode newRoot;
+    newRoot.parent = nullptr;
+    newRoot.childrenFetched = true;
+    newRoot.hasChildren = false;
+    QVector<PClassBrowserNode> oldNodes;
+    oldNodes.swap(mNodes);
+    mDummyStatements.clear();
+    addMembers(&newRoot);
+    if (mFilledFile != mCurrentFile) {
+        beginResetModel();
+        mRoot->children = newRoot.children;
+        foreach (ClassBrowserNode* child, mRoot->children)
+            child->parent = mRoot;
+        mFilledFile = mCurrentFile;
+        endResetModel();
+        return;
+    }
+    //nodes kept in the tree keep their model indexes, so the view keeps
+    //their expand states and the selection
+    mergeChildren(mRoot, QModelIndex(), &newRoot);
+
+    //free nodes not in the tree anymore
+    QSet<ClassBrowserNode*> nodesInTree;
+    QVector<ClassBrowserNode*> queue = mRoot->children;
+    while (!queue.isEmpty()) {
+        ClassBrowserNode* node = queue.takeLast();
+        nodesInTree.insert(node);
+        queue.append(node->children);
+    }
+    QVector<PClassBrowserNode> newNodes;
+    newNodes.swap(mNodes);
+    newNodes.append(oldNodes);
+    foreach (const PClassBrowserNode& node, newNodes) {
+        if (nodesInTree.contains(node.get()))
+            mNodes.append(node);
+    }
+}
+
+static QStringList nodeKeys(const QVector<ClassBrowserNode *> &nodes)
+{
+    //overloaded functions have the same full name
+    QStringList keys;
+    QHash<QString,int> counts;
+    foreach (ClassBrowserNode* node, nodes) {
+        QString key = QString::number(static_cast<int>(node->statement->kind))
+                + ' ' + node->statement->fullName + node->statement->noNameArgs;
+        int count = counts.value(key,0);
+        counts.insert(key,count+1);
+        if (count>0)
+            key += QString("#%1").arg(count);
+        keys.append(key);
+    }
+    return keys;
+}
 
+void ClassBrowserModel::mergeChildren(ClassBrowserNode *node, const QModelIndex &nodeIndex, ClassBrowserNode *newNode)
+{
+    QStringList keys = nodeKeys(node->children);
+    QStringList newKeys = nodeKeys(newNode->children);
+    QSet<QString> newKeySet(newKeys.begin(),newKeys.end());
+    QSet<QString> keySet(keys.begin(),keys.end());
+    //remove children not in the new tree, a run of rows at a time
+    int i = keys.count()-1;
+    while (i>=0) {
+        if (newKeySet.contains(keys[i])) {
+            i--;
+            continue;
+        }
+        int last = i;
+        while (i>=0 && !newKeySet.contains(keys[i]))
+            i--;
+        beginRemoveRows(nodeIndex,i+1,last);
+        node->children.remove(i+1,last-i);
+        for (int k=i+1;k<=last;k++)
+            keySet.remove(keys[k]);
+        keys.erase(keys.begin()+i+1,keys.begin()+last+1);
+        endRemoveRows();
+    }
+    //the remaining children are all in the new tree, insert the new ones
+    //and move the ones whose position changed (e.g. the sort order is changed)
+    for (int j=0;j<newKeys.count();j++) {
+        ClassBrowserNode* newChild = newNode->children[j];
+        if (j<keys.count() && keys[j]==newKeys[j]) {
+            mergeNode(node->children[j], nodeIndex, j, newChild);
+            continue;
+        }
+        //only moved children are searched for
+        int k = keySet.contains(newKeys[j])?keys.indexOf(newKeys[j],j+1):-1;
+        if (k>j) {
+            beginMoveRows(nodeIndex,k,k,nodeIndex,j);
+            node->children.move(k,j);
+            keys.move(k,j);
+            endMoveRows();
+            mergeNode(node->children[j], nodeIndex, j, newChild);
+        } else {
+            beginInsertRows(nodeIndex,j,j);
+            newChild->parent = node;
+            node->children.insert(j,newChild);
+            keys.insert(j,newKeys[j]);
+            endInsertRows();
         }
     }
 }
 
+void ClassBrowserModel::mergeNode(ClassBrowserNode *node, const QModelIndex &parentIndex, int row, ClassBrowserNode *newNode)
+{
+    PStatement oldStatement = node->statement;
+    PStatement statement = newNode->statement;
+    node->statement = statement;
+    QModelIndex nodeIndex = index(row,0,parentIndex);
+    bool hadChildren = node->hasChildren;
+    node->hasChildren = newNode->hasChildren;
+    if (oldStatement->command != statement->command
+            || oldStatement->args != statement->args
+            || oldStatement->type != statement->type
+            || oldStatement->classScope != statement->classScope
+            || oldStatement->isStatic != statement->isStatic
+            || (!node->childrenFetched && hadChildren != node->hasChildren)) {
+        emit dataChanged(nodeIndex,nodeIndex);
+    }
+    if (!node->childrenFetched)
+        return;
+    fetchChildren(newNode);
+    mergeChildren(node, nodeIndex, newNode);
+}
+
 void ClassBrowserModel::addChild(ClassBrowserNode *node, PStatement statement)
 {
     PClassBrowserNode newNode = std::make_shared<ClassBrowserNode>();
     newNode->parent = node;
     newNode->statement = statement;
-//    newNode->childrenFetched = false;
+    newNode->childrenFetched = false;
+    newNode->hasChildren = false;
     node->children.append(newNode.get());
     mNodes.append(newNode);
+}
+
+static bool hasShownChildren(const PStatement& statement)
+{
     //don't show enum type's children values (they are displayed in parent scope)
-    if (statement->kind != StatementKind::skEnumType)
-        filterChildren(newNode.get(), statement->children);
+    if (statement->kind == StatementKind::skEnumType)
+        return false;
+    foreach (const PStatement& child, statement->children) {
+        if (child->kind != StatementKind::skBlock
+                && (!child->isInherited || pSettings->ui().classBrowserShowInherited())
+                && child != statement
+                && child->scope != StatementScope::ssLocal)
+            return true;
+    }
+    return false;
+}
+
+void ClassBrowserModel::fetchChildren(ClassBrowserNode *node)
+{
+    node->childrenFetched = true;
+    if (node->statement && node->statement->kind != StatementKind::skEnumType)
+        filterChildren(node, node->statement->children);
 }
 
-void ClassBrowserModel::addMembers()
+void ClassBrowserModel::addMembers(ClassBrowserNode *root)
 {
     // show statements in the file
     PFileIncludes p = mParser->findFileIncludes(mCurrentFile);
     if (!p)
         return;
-    filterChildren(mRoot,p->statements);
+    filterChildren(root,p->statements);
 }
 
 void ClassBrowserModel::filterChildren(ClassBrowserNode *node, const StatementMap &statements)
@@ -343,6 +481,9 @@ void ClassBrowserModel::filterChildren(ClassBrowserNode *node, const StatementMa
             addChild(node,statement);
         }
     }
+    //dummy statements get their children in the loop
+    foreach (ClassBrowserNode* child, node->children)
+        child->hasChildren = hasShownChildren(child->statement);
     if (pSettings->ui().classBrowserSortAlpha()
             && pSettings->ui().classBrowserSortType()) {
         std::sort(node->children.begin(),node->children.end(),
@@ -24,7 +24,9 @@ struct ClassBrowserNode {
     ClassBrowserNode* parent;
     PStatement statement;
     QVector<ClassBrowserNode *> children;
-//    bool childrenFetched;
+    //children are only filtered when the node is expanded
+    bool childrenFetched;
+    bool hasChildren; // found when the node is added, the statements may be parsed later
 };
 
 using PClassBrowserNode = std::shared_ptr<ClassBrowserNode>;
@@ -44,8 +46,8 @@ public:
     bool hasChildren(const QModelIndex &parent) const override;
     int rowCount(const QModelIndex &parent) const override;
     int columnCount(const QModelIndex &parent) const override;
-//    void fetchMore(const QModelIndex &parent) override;
-//    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    bool canFetchMore(const QModelIndex &parent) const override;
     QVariant data(const QModelIndex &index, int role) const override;
     const PCppParser &parser() const;
     void setParser(const PCppParser &newCppParser);
@@ -63,7 +65,10 @@ public slots:
     void fillStatements();
 private:
     void addChild(ClassBrowserNode* node, PStatement statement);
-    void addMembers();
+    void addMembers(ClassBrowserNode* root);
+    void fetchChildren(ClassBrowserNode* node);
+    void mergeChildren(ClassBrowserNode* node, const QModelIndex& nodeIndex, ClassBrowserNode* newNode);
+    void mergeNode(ClassBrowserNode* node, const QModelIndex& parentIndex, int row, ClassBrowserNode* newNode);
     void filterChildren(ClassBrowserNode * node, const StatementMap& statements);
     PStatement createDummy(PStatement statement);
 private:
@@ -75,6 +80,7 @@ private:
     int mUpdateCount;
     QMutex mMutex;
     QString mCurrentFile;
+    QString mFilledFile; // file of the statements in the tree
     std::shared_ptr<QHash<StatementKind, std::shared_ptr<ColorSchemeItem> > > mColors;
 
 };
@@ -26,7 +26,9 @@
 
 CPUDialog::CPUDialog(QWidget *parent) :
     QDialog(parent),
-    ui(new Ui::CPUDialog)
+    ui(new Ui::CPUDialog),
+    mShown(false),
+    mActiveLine(-1)
 {
     setWindowFlags(windowFlags() | Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint);
     setWindowFlag(Qt::WindowContextHelpButtonHint,false);
@@ -84,12 +86,9 @@ void CPUDialog::updateInfo()
 {
     if (pMainWindow->debugger()->executing()) {
         // Load the registers..
-        sendSyntaxCommand();
         pMainWindow->debugger()->sendCommand("-data-list-register-values", "N");
-        if (ui->chkBlendMode->isChecked())
-            pMainWindow->debugger()->sendCommand("disas", "/s");
-        else
-            pMainWindow->debugger()->sendCommand("disas", "");
+        pMainWindow->debugger()->requestDisassembly(ui->rdIntel->isChecked(),
+                                                   ui->chkBlendMode->isChecked());
     }
 }
 
@@ -112,9 +111,37 @@ void CPUDialog::updateDPI(float dpi)
     resetEditorFont(dpi);
 }
 
+bool CPUDialog::isShowing(const QString &file, const QString &funcName) const
+{
+    return mShown && mFile == file && mFuncName == funcName;
+}
+
+void CPUDialog::setCurrentLine(int line)
+{
+    QSynedit::PDocument document = ui->txtCode->document();
+    if (mActiveLine>=0 && mActiveLine<document->count()) {
+        QString s = document->getString(mActiveLine);
+        if (s.startsWith("=>")) {
+            s.replace(0,2,"  ");
+            document->putString(mActiveLine,s);
+        }
+    }
+    mActiveLine = -1;
+    if (line<0 || line>=document->count())
+        return;
+    QString s = document->getString(line);
+    s.replace(0,2,"=>");
+    document->putString(line,s);
+    mActiveLine = line;
+    ui->txtCode->setCaretXYEx(true,QSynedit::BufferCoord{1,line+1});
+}
+
 void CPUDialog::setDisassembly(const QString& file, const QString& funcName,const QStringList& lines)
 {
     ui->txtFunctionName->setText(QString("%1:%2").arg(file, funcName));
+    mFile = file;
+    mFuncName = funcName;
+    mShown = true;
     int activeLine = -1;
     ui->txtCode->document()->clear();
     for (int i=0;i<lines.size();i++) {
@@ -124,6 +151,7 @@ void CPUDialog::setDisassembly(const QString& file, const QString& funcName,cons
         }
         ui->txtCode->document()->add(line);
     }
+    mActiveLine = activeLine;
     if (activeLine!=-1)
         ui->txtCode->setCaretXYEx(true,QSynedit::BufferCoord{1,activeLine+1});
 }
@@ -140,16 +168,6 @@ void CPUDialog::resetEditorFont(float dpi)
     ui->txtCode->setFontForNonAscii(f2);
 }
 
-void CPUDialog::sendSyntaxCommand()
-{
-    // Set disassembly flavor
-    if (ui->rdIntel->isChecked()) {
-        pMainWindow->debugger()->sendCommand("-gdb-set", "disassembly-flavor intel");
-    } else {
-        pMainWindow->debugger()->sendCommand("-gdb-set", "disassembly-flavor att");
-    }
-}
-
 void CPUDialog::closeEvent(QCloseEvent *event)
 {
     pSettings->ui().setCPUDialogWidth(width());
@@ -164,6 +182,8 @@ void CPUDialog::closeEvent(QCloseEvent *event)
 
 void CPUDialog::on_rdIntel_toggled(bool)
 {
+    //the lines of the other flavor must be loaded
+    mShown = false;
     updateInfo();
     pSettings->debugger().setUseIntelStyle(ui->rdIntel->isChecked());
     pSettings->debugger().save();
@@ -171,6 +191,7 @@ void CPUDialog::on_rdIntel_toggled(bool)
 
 void CPUDialog::on_rdATT_toggled(bool)
 {
+    mShown = false;
     updateInfo();
     pSettings->debugger().setUseIntelStyle(ui->rdIntel->isChecked());
     pSettings->debugger().save();
@@ -178,6 +199,7 @@ void CPUDialog::on_rdATT_toggled(bool)
 
 void CPUDialog::on_chkBlendMode_stateChanged(int)
 {
+    mShown = false;
     updateInfo();
     pSettings->debugger().setBlendMode(ui->chkBlendMode->isCheckable());
     pSettings->debugger().save();
@@ -32,16 +32,22 @@ public:
     ~CPUDialog();
     void updateInfo();
     void updateButtonStates(bool enable);
+    //the function's disassembly is shown, only the current line may change
+    bool isShowing(const QString& file, const QString& funcName) const;
+    //move the "=>" marker, without loading the lines again
+    void setCurrentLine(int line);
 public slots:
     void updateDPI(float dpi);
     void setDisassembly(const QString& file, const QString& funcName,const QStringList& lines);
     void resetEditorFont(float dpi);
 signals:
     void closed();
-private:
-    void sendSyntaxCommand();
 private:
     Ui::CPUDialog *ui;
+    QString mFile;
+    QString mFuncName;
+    bool mShown;
+    int mActiveLine;
     // QWidget interface
 protected:
     void closeEvent(QCloseEvent *event) override;
@@ -121,6 +121,23 @@ void IssuesModel::clearIssues()
     }
 }
 
+void IssuesModel::removeIssues(const QString &filename)
+{
+    Editor *e=pMainWindow->editorList()->getOpenedEditorByFilename(filename);
+    if (e)
+        e->clearSyntaxIssues();
+    QVector<PCompileIssue> issues;
+    foreach(const PCompileIssue& issue, mIssues) {
+        if (issue->filename.compare(filename, PATH_SENSITIVITY)!=0)
+            issues.append(issue);
+    }
+    if (issues.size()!=mIssues.size()) {
+        beginResetModel();
+        mIssues = issues;
+        endResetModel();
+    }
+}
+
 void IssuesModel::setErrorColor(QColor color)
 {
     mErrorColor = color;
@@ -177,6 +194,11 @@ void IssuesTable::clearIssues()
     mModel->clearIssues();
 }
 
+void IssuesTable::removeIssues(const QString &filename)
+{
+    mModel->removeIssues(filename);
+}
+
 int IssuesModel::rowCount(const QModelIndex &) const
 {
     return mIssues.size();
@@ -31,6 +31,8 @@ public:
 public slots:
     void addIssue(PCompileIssue issue);
     void clearIssues();
+    //remove the issues of the file, and its editor's issue marks
+    void removeIssues(const QString& filename);
 
     void setErrorColor(QColor color);
     void setWarningColor(QColor color);
@@ -74,6 +76,7 @@ public slots:
     int count();
 
     void clearIssues();
+    void removeIssues(const QString& filename);
 
 private:
     IssuesModel * mModel;
@@ -16,12 +16,16 @@
  */
 #include "ojproblemsetmodel.h"
 
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QIcon>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QMimeData>
+#include <QSet>
 #include "../utils.h"
 #include "../iconsmanager.h"
 #include "../systemconsts.h"
@@ -31,6 +35,79 @@ OJProblemSetModel::OJProblemSetModel(QObject *parent) : QAbstractListModel(paren
 
 }
 
+static QString caseDataFolder(const QString& problemSetFileName)
+{
+    QFileInfo info(problemSetFileName);
+    return includeTrailingPathDelimiter(info.absolutePath())+info.completeBaseName()+"_data";
+}
+
+static bool isCaseDataFileName(const QString& name)
+{
+    //data files are named by the sha1 of their content
+    if (name.length()!=40)
+        return false;
+    foreach (const QChar& ch, name) {
+        if (!((ch>='0' && ch<='9') || (ch>='a' && ch<='f')))
+            return false;
+    }
+    return true;
+}
+
+static void writeCaseDataFile(const QString& fileName, const QByteArray& content)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate))
+        throw FileError(QObject::tr("Can't open file '%1' for write.")
+                        .arg(fileName));
+    file.write(content);
+}
+
+static void saveCaseData(QJsonObject& caseObj, const QString& key,
+                         OJProblemCaseData& data, const QString& dataFolder)
+{
+    if (data.hash().isEmpty()) {
+        if (data.text().length()<OJ_CASE_DATA_SPILL_SIZE) {
+            caseObj[key]=data.text();
+            return;
+        }
+        QByteArray content = data.text().toUtf8();
+        QString hash = QCryptographicHash::hash(content,QCryptographicHash::Sha1).toHex();
+        QString target = includeTrailingPathDelimiter(dataFolder)+hash;
+        if (!fileExists(target))
+            writeCaseDataFile(target,content);
+        data.setDataFile(target,hash,content.size(),data.text().left(OJ_CASE_DATA_PREVIEW_LENGTH));
+    } else {
+        //the data is not changed since it was loaded or saved,
+        //it only needs to be copied when the problem set is saved to another folder
+        QString target = includeTrailingPathDelimiter(dataFolder)+data.hash();
+        if (!fileExists(target)) {
+            if (!data.pendingDataFile().isEmpty())
+                QFile::copy(data.pendingDataFile(),target);
+            else
+                writeCaseDataFile(target,data.text().toUtf8());
+        }
+        data.setDataFile(target,data.hash(),data.size(),data.preview());
+    }
+    caseObj[key+"_data"]=data.hash();
+    caseObj[key+"_size"]=data.size();
+    caseObj[key+"_preview"]=data.preview();
+}
+
+static void loadCaseData(const QJsonObject& caseObj, const QString& key,
+                         OJProblemCaseData& data, const QString& dataFolder)
+{
+    //problem sets saved by older versions have all the data in the json file
+    if (!caseObj.contains(key+"_data")) {
+        data.setText(caseObj[key].toString());
+        return;
+    }
+    QString hash = caseObj[key+"_data"].toString();
+    data.setDataFile(includeTrailingPathDelimiter(dataFolder)+hash,
+                     hash,
+                     caseObj[key+"_size"].toVariant().toLongLong(),
+                     caseObj[key+"_preview"].toString());
+}
+
 void OJProblemSetModel::clear()
 {
     beginResetModel();
@@ -107,6 +184,9 @@ void OJProblemSetModel::saveToFile(const QString &fileName)
         QJsonObject obj;
         mProblemSet.exportFilename=fileName;
         obj["name"]=mProblemSet.name;
+        QString dataFolder = caseDataFolder(fileName);
+        QDir().mkpath(dataFolder);
+        QSet<QString> usedDataFiles;
         QJsonArray problemsArray;
         foreach (const POJProblem& problem, mProblemSet.problems) {
             QJsonObject problemObj;
@@ -119,7 +199,10 @@ void OJProblemSetModel::saveToFile(const QString &fileName)
             foreach (const POJProblemCase& problemCase, problem->cases) {
                 QJsonObject caseObj;
                 caseObj["name"]=problemCase->name;
-                caseObj["input"]=problemCase->input;
+                saveCaseData(caseObj,"input",problemCase->input,dataFolder);
+                saveCaseData(caseObj,"expected",problemCase->expected,dataFolder);
+                usedDataFiles.insert(problemCase->input.hash());
+                usedDataFiles.insert(problemCase->expected.hash());
                 QString path = problemCase->inputFileName;
                 QString prefix = includeTrailingPathDelimiter(extractFileDir(fileName));
                 if (path.startsWith(prefix, PATH_SENSITIVITY)) {
@@ -131,7 +214,6 @@ void OJProblemSetModel::saveToFile(const QString &fileName)
                     path = "%ProblemSetPath%/"+ path.mid(prefix.length());
                 }
                 caseObj["expected_output_filename"]=path;
-                caseObj["expected"]=problemCase->expected;
                 cases.append(caseObj);
             }
             problemObj["cases"]=cases;
@@ -142,6 +224,14 @@ void OJProblemSetModel::saveToFile(const QString &fileName)
         doc.setObject(obj);
         file.write(doc.toJson());
         file.close();
+        //remove data files that are not used any more
+        QDir dir(dataFolder);
+        foreach (const QString& dataFile, dir.entryList(QDir::Files)) {
+            if (isCaseDataFileName(dataFile) && !usedDataFiles.contains(dataFile))
+                dir.remove(dataFile);
+        }
+        if (dir.isEmpty())
+            QDir().rmdir(dataFolder);
     } else {
         throw FileError(QObject::tr("Can't open file '%1' for read.")
                         .arg(fileName));
@@ -162,6 +252,7 @@ void OJProblemSetModel::loadFromFile(const QString &fileName)
         }
         beginResetModel();
         QJsonObject obj = doc.object();
+        QString dataFolder = caseDataFolder(fileName);
         mProblemSet.name = obj["name"].toString();
         mProblemSet.problems.clear();
         QJsonArray problemsArray = obj["problems"].toArray();
@@ -177,8 +268,8 @@ void OJProblemSetModel::loadFromFile(const QString &fileName)
                 QJsonObject caseObj = caseVal.toObject();
                 POJProblemCase problemCase = std::make_shared<OJProblemCase>();
                 problemCase->name = caseObj["name"].toString();
-                problemCase->input = caseObj["input"].toString();
-                problemCase->expected = caseObj["expected"].toString();
+                loadCaseData(caseObj,"input",problemCase->input,dataFolder);
+                loadCaseData(caseObj,"expected",problemCase->expected,dataFolder);
                 QString path = caseObj["input_filename"].toString();
                 if (path.startsWith("%ProblemSetPath%/")) {
                     path = includeTrailingPathDelimiter(extractFileDir(fileName))+
@@ -376,7 +467,7 @@ int OJProblemModel::count()
 
 void OJProblemModel::update(int row)
 {
-    emit dataChanged(index(row,0),index(row,0));
+    emit dataChanged(index(row,0),index(row,columnCount(QModelIndex())-1));
 }
 
 QString OJProblemModel::getTitle()
@@ -438,16 +529,68 @@ QVariant OJProblemModel::data(const QModelIndex &index, int role) const
             default:
                 return QVariant();
             }
+        } else if (role == Qt::ToolTipRole) {
+            POJProblemCase problemCase = mProblem->cases[index.row()];
+            if (!problemCase->input.dataFile().isEmpty()) {
+                return tr("Input (%1):").arg(getSizeString(problemCase->input.size()))
+                        +"\n"+problemCase->input.preview();
+            }
         }
         break;
     case 1:
         if (role == Qt::DisplayRole) {
-             POJProblemCase problemCase = mProblem->cases[index.row()];
-             if (problemCase->testState == ProblemCaseTestState::Passed
-                     || problemCase->testState == ProblemCaseTestState::Failed)
-                 return problemCase->runningTime;
-             else
-                 return "";
+            POJProblemCase problemCase = mProblem->cases[index.row()];
+            switch (problemCase->verdict) {
+            case ProblemCaseVerdict::TimeLimitExceeded:
+                return "TLE";
+            case ProblemCaseVerdict::MemoryLimitExceeded:
+                return "MLE";
+            case ProblemCaseVerdict::RuntimeError:
+                return "RE";
+            default:
+                break;
+            }
+            if (problemCase->testState == ProblemCaseTestState::Passed)
+                return "AC";
+            else if (problemCase->testState == ProblemCaseTestState::Failed)
+                return "WA";
+        } else if (role == Qt::ToolTipRole) {
+            POJProblemCase problemCase = mProblem->cases[index.row()];
+            switch (problemCase->verdict) {
+            case ProblemCaseVerdict::TimeLimitExceeded:
+                return tr("Time Limit Exceeded");
+            case ProblemCaseVerdict::MemoryLimitExceeded:
+                return tr("Memory Limit Exceeded");
+            case ProblemCaseVerdict::RuntimeError:
+                return tr("Runtime Error (exit code: %1)").arg(problemCase->exitCode);
+            default:
+                break;
+            }
+            if (problemCase->testState == ProblemCaseTestState::Passed)
+                return tr("Accepted");
+            else if (problemCase->testState == ProblemCaseTestState::Failed)
+                return tr("Wrong Answer");
+        }
+        break;
+    case 2:
+    case 3:
+    case 4:
+        if (role == Qt::DisplayRole) {
+            POJProblemCase problemCase = mProblem->cases[index.row()];
+            if (problemCase->testState != ProblemCaseTestState::Passed
+                    && problemCase->testState != ProblemCaseTestState::Failed)
+                return "";
+            int value;
+            if (index.column()==2)
+                value = problemCase->runningTime;
+            else if (index.column()==3)
+                value = problemCase->cpuTime;
+            else
+                value = problemCase->peakMemory;
+            //not measured
+            if (value<0)
+                return "";
+            return value;
         }
         break;
     }
@@ -486,7 +629,7 @@ Qt::ItemFlags OJProblemModel::flags(const QModelIndex &idx) const
 
 int OJProblemModel::columnCount(const QModelIndex &/*parent*/) const
 {
-    return 2;
+    return 5;
 }
 
 QVariant OJProblemModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -496,7 +639,13 @@ QVariant OJProblemModel::headerData(int section, Qt::Orientation orientation, in
         case 0:
             return tr("Name");
         case 1:
+            return tr("Verdict");
+        case 2:
             return tr("Time(ms)");
+        case 3:
+            return tr("CPU Time(ms)");
+        case 4:
+            return tr("Memory(KB)");
         }
     }
     return QVariant();
@@ -23,6 +23,7 @@
 #include <QPainter>
 #include <QRect>
 #include <QScrollBar>
+#include <algorithm>
 #include <cmath>
 #include <QDebug>
 #include <QTimer>
@@ -68,6 +69,7 @@ QConsole::QConsole(QWidget *parent):
     connect(&mContents,&ConsoleLines::rowsAdded,this, &QConsole::contentsRowsAdded);
     connect(&mContents,&ConsoleLines::lastRowsChanged,this, &QConsole::contentsLastRowsChanged);
     connect(&mContents,&ConsoleLines::lastRowsRemoved,this, &QConsole::contentsLastRowsRemoved);
+    connect(&mContents,&ConsoleLines::rowCountChanged,this, &QConsole::contentsLayouted);
     connect(verticalScrollBar(),&QScrollBar::valueChanged,
             this, &QConsole::doScrolled);
 
@@ -261,12 +263,18 @@ void QConsole::recalcCharExtent() {
     mColumnWidth = fontMetrics().horizontalAdvance("M");
 }
 
-void QConsole::sizeOrFontChanged(bool)
+void QConsole::sizeOrFontChanged(bool bFont)
 {
     if (mColumnWidth != 0) {
-        mColumnsPerRow = std::max(clientWidth()-2,0) / mColumnWidth;
+        int columnsPerRow = std::max(clientWidth()-2,0) / mColumnWidth;
         mRowsInWindow = clientHeight() / mRowHeight;
-        mContents.layout();
+        //lines only need to be broken again when the width or the font is changed
+        if (bFont || columnsPerRow != mColumnsPerRow) {
+            mColumnsPerRow = columnsPerRow;
+            mContents.layout();
+        } else {
+            updateScrollbars();
+        }
     }
 
 }
@@ -997,12 +1005,13 @@ void QConsole::wheelEvent(QWheelEvent *event)
 
 int ConsoleLines::rows() const
 {
+    ensureRowIndex();
     return mRows;
 }
 
 int ConsoleLines::lines() const
 {
-    return mLines.count();
+    return mCount;
 }
 
 void ConsoleLines::layout()
@@ -1016,14 +1025,9 @@ void ConsoleLines::layout()
     mLayouting = true;
     mNeedRelayout = false;
     emit layoutStarted();
-    mRows = 0;
-    bool forceUpdate = (mOldTabSize!=mConsole->tabSize());
-    for (PConsoleLine consoleLine: mLines) {
-        if (forceUpdate || consoleLine->maxColumns > mConsole->columnsPerRow()) {
-            consoleLine->maxColumns = breakLine(consoleLine->text,consoleLine->fragments);
-        }
-        mRows+=consoleLine->fragments.count();
-    }
+    //lines are broken again when they are shown, until then their rows are estimated
+    mLayoutVersion++;
+    invalidateRowIndex();
     emit layoutFinished();
     mLayouting = false;
     if (mNeedRelayout)
@@ -1033,29 +1037,31 @@ void ConsoleLines::layout()
 ConsoleLines::ConsoleLines(QConsole *console)
 {
     mConsole = console;
+    mFirst = 0;
+    mCount = 0;
     mRows = 0;
+    mRowIndexValid = true;
+    mLayoutVersion = 0;
     mLayouting = false;
     mNeedRelayout = false;
-    mOldTabSize = -1;
     mMaxLines = 1000;
     connect(this,&ConsoleLines::needRelayout,this,&ConsoleLines::layout);
+    mRowCountTimer.setSingleShot(true);
+    connect(&mRowCountTimer,&QTimer::timeout,this,&ConsoleLines::rowCountChanged);
 }
 
 void ConsoleLines::addLine(const QString &line)
 {
     PConsoleLine consoleLine=std::make_shared<ConsoleLine>();
     consoleLine->text = line;
-    consoleLine->maxColumns = breakLine(line,consoleLine->fragments);
-    if (mLines.count()<mMaxLines || mMaxLines <= 0) {
-        mLines.append(consoleLine);
-        mRows += consoleLine->fragments.count();
-        emit rowsAdded(consoleLine->fragments.count());
+    consoleLine->rows = 0;
+    breakLine(consoleLine);
+    if (mCount<mMaxLines || mMaxLines <= 0) {
+        appendLine(consoleLine);
+        emit rowsAdded(consoleLine->rows);
     } else {
-        PConsoleLine firstLine = mLines[0];
-        mLines.pop_front();
-        mRows -= firstLine->fragments.count();
-        mLines.append(consoleLine);
-        mRows += consoleLine->fragments.count();
+        removeFirstLine();
+        appendLine(consoleLine);
         emit layoutStarted();
         emit layoutFinished();
     }
@@ -1063,30 +1069,32 @@ void ConsoleLines::addLine(const QString &line)
 
 void ConsoleLines::RemoveLastLine()
 {
-    if (mLines.count()<=0)
+    if (mCount<=0)
         return;
-    PConsoleLine consoleLine = mLines[mLines.count()-1];
-    mLines.pop_back();
-    mRows -= consoleLine->fragments.count();
-    emit lastRowsRemoved(consoleLine->fragments.count());
+    int slot = slotOf(mCount-1);
+    int rows = mLines[slot]->rows;
+    setLineRows(slot,0);
+    mLines[slot].reset();
+    mCount--;
+    emit lastRowsRemoved(rows);
 }
 
 void ConsoleLines::changeLastLine(const QString &newLine)
 {
-    if (mLines.count()<=0) {
+    if (mCount<=0) {
         return;
     }
-    PConsoleLine consoleLine = mLines[mLines.count()-1];
-    int oldRows = consoleLine->fragments.count();
+    int slot = slotOf(mCount-1);
+    PConsoleLine consoleLine = mLines[slot];
+    int oldRows = consoleLine->rows;
     consoleLine->text = newLine;
-    breakLine(newLine,consoleLine->fragments);
-    int newRows = consoleLine->fragments.count();
+    breakLine(consoleLine);
+    int newRows = consoleLine->breaks.count()+1;
     if (newRows == oldRows) {
         emit lastRowsChanged(oldRows);
         return ;
     } else {
-        mRows -= oldRows;
-        mRows += newRows;
+        setLineRows(slot,newRows);
         emit layoutStarted();
         emit layoutFinished();
     }
@@ -1094,15 +1102,15 @@ void ConsoleLines::changeLastLine(const QString &newLine)
 
 QString ConsoleLines::getLastLine()
 {
-    if (mLines.count()<=0)
+    if (mCount<=0)
         return "";
-    return mLines[mLines.count()-1]->text;
+    return lineAt(mCount-1)->text;
 }
 
 QString ConsoleLines::getLine(int line)
 {
-    if (line>=0 && line < mLines.count()) {
-        return mLines[line]->text;
+    if (line>=0 && line < mCount) {
+        return lineAt(line)->text;
     }
     return "";
 }
@@ -1124,21 +1132,20 @@ QChar ConsoleLines::getChar(const LineChar &lineChar)
 
 QStringList ConsoleLines::getRows(int startRow, int endRow)
 {
-    if (startRow>mRows)
+    if (startRow>rows())
         return QStringList();
     if (startRow > endRow)
         return QStringList();
     QStringList lst;
-    int row = 0;
-    for (PConsoleLine line:mLines) {
-        for (const QString& s:line->fragments) {
-            row+=1;
-            if (row>endRow) {
-                return lst;
-            }
-            if (row>=startRow) {
-                lst.append(s);
-            }
+    int row = std::max(startRow,1)-1;
+    //breaking a line doesn't move the rows before it
+    for (int line = lineAtRow(row);line>=0 && line<mCount && row<endRow;line++) {
+        ensureLineBroken(line);
+        PConsoleLine consoleLine = lineAt(line);
+        int lineStartRow = rowsBefore(line);
+        for (int r=row-lineStartRow;r<consoleLine->rows && row<endRow;r++) {
+            lst.append(rowText(consoleLine,r));
+            row++;
         }
     }
     return lst;
@@ -1151,27 +1158,35 @@ LineChar ConsoleLines::rowColumnToLineChar(const RowColumn &rowColumn)
 
 LineChar ConsoleLines::rowColumnToLineChar(int row, int column)
 {
-    LineChar result{column,mLines.size()-1};
-    int rows=0;
-    for (int i=0;i<mLines.size();i++) {
-        PConsoleLine line = mLines[i];
-        if (row >= rows && row<rows+line->fragments.size()) {
-            int r=row - rows;
-            QString fragment = line->fragments[r];
-            int columnsBefore = 0;
-            for (int j=0;j<fragment.size();j++) {
-                QChar ch = fragment[j];
-                int charColumns= mConsole->charColumns(ch, columnsBefore);
-                if (column>=columnsBefore && column<columnsBefore+charColumns) {
-                    result.ch = j;
-                    break;
-                }
-            }
-            result.line = i;
+    LineChar result{column,mCount-1};
+    if (row<0 || row>=rows())
+        return result;
+    int line = lineAtRow(row);
+    int lineStartRow;
+    while (true) {
+        ensureLineBroken(line);
+        lineStartRow = rowsBefore(line);
+        if (row < lineStartRow + lineAt(line)->rows)
+            break;
+        line++;
+        if (line>=mCount)
+            return result;
+    }
+    PConsoleLine consoleLine = lineAt(line);
+    int r = row - lineStartRow;
+    int start = (r==0)?0:consoleLine->breaks[r-1];
+    int end = (r<consoleLine->breaks.count())?consoleLine->breaks[r]:consoleLine->text.length();
+    result.ch = end;
+    int columnsBefore = 0;
+    for (int j=start;j<end;j++) {
+        int charColumns= mConsole->charColumns(consoleLine->text[j], columnsBefore);
+        if (column>=columnsBefore && column<columnsBefore+charColumns) {
+            result.ch = j;
             break;
         }
-        rows += line->fragments.size();
+        columnsBefore += charColumns;
     }
+    result.line = line;
     return result;
 }
 
@@ -1182,34 +1197,20 @@ RowColumn ConsoleLines::lineCharToRowColumn(const LineChar &lineChar)
 
 RowColumn ConsoleLines::lineCharToRowColumn(int line, int ch)
 {
-    RowColumn result{ch,std::max(0,mRows-1)};
-    int rowsBefore = 0;
-    if (line>=0 && line < mLines.size()) {
-        for (int i=0;i<line;i++) {
-            int rows = mLines[i]->fragments.size();
-            rowsBefore += rows;
-        }
-        PConsoleLine consoleLine = mLines[line];
-        int charsBefore = 0;
-        for (int r=0;r<consoleLine->fragments.size();r++) {
-            int chars = consoleLine->fragments[r].size();
-            if (r==consoleLine->fragments.size()-1 || (ch>=charsBefore && ch<charsBefore+chars)) {
-                QString fragment = consoleLine->fragments[r];
-                int columnsBefore = 0;
-                int len = std::min(ch-charsBefore,fragment.size());
-                for (int j=0;j<len;j++) {
-                    QChar ch = fragment[j];
-                    int charColumns = mConsole->charColumns(ch,columnsBefore);
-                    columnsBefore += charColumns;
-                }
-                result.column=columnsBefore;
-                result.row = rowsBefore + r;
-                break;
-            }
-            charsBefore += chars;
+    if (line>=0 && line < mCount) {
+        ensureLineBroken(line);
+        PConsoleLine consoleLine = lineAt(line);
+        int r = std::upper_bound(consoleLine->breaks.begin(),consoleLine->breaks.end(),ch)
+                - consoleLine->breaks.begin();
+        int start = (r==0)?0:consoleLine->breaks[r-1];
+        int end = std::min(ch,consoleLine->text.length());
+        int columnsBefore = 0;
+        for (int j=start;j<end;j++) {
+            columnsBefore += mConsole->charColumns(consoleLine->text[j],columnsBefore);
         }
+        return RowColumn{columnsBefore,rowsBefore(line) + r};
     }
-    return result;
+    return RowColumn{ch,std::max(0,rows()-1)};
 }
 
 bool ConsoleLines::layouting() const
@@ -1217,40 +1218,220 @@ bool ConsoleLines::layouting() const
     return mLayouting;
 }
 
-int ConsoleLines::breakLine(const QString &line, QStringList &fragments)
+void ConsoleLines::breakLine(const PConsoleLine& line)
 {
-    fragments.clear();
-    QString s = "";
-    int maxColLen = 0;
+    line->breaks.clear();
+    line->layoutVersion = mLayoutVersion;
+    int columnsPerRow = mConsole->columnsPerRow();
+    if (columnsPerRow<=0)
+        return;
+    const QString& text = line->text;
+    int rowStart = 0;
     int columnsBefore = 0;
-    for (QChar ch:line) {
+    for (int i=0;i<text.length();i++) {
+        QChar ch = text[i];
         int charColumn = mConsole->charColumns(ch,columnsBefore);
-        if (charColumn + columnsBefore > mConsole->columnsPerRow()) {
-            if (ch == '\t') {
-                if  (columnsBefore != mConsole->columnsPerRow()) {
-                    charColumn = 0;
-                } else
-                    charColumn = mConsole->tabSize();
-            }
-            fragments.append(s);
-            if (columnsBefore > maxColLen) {
-                maxColLen = columnsBefore;
+        if (charColumn + columnsBefore > columnsPerRow && i>rowStart) {
+            if (ch == '\t' && columnsBefore < columnsPerRow) {
+                //the tab fills the rest of the row
+                if (i+1<text.length()) {
+                    rowStart = i+1;
+                    line->breaks.append(rowStart);
+                }
+                columnsBefore = 0;
+                continue;
             }
-            s = "";
+            rowStart = i;
+            line->breaks.append(rowStart);
             columnsBefore = 0;
+            charColumn = mConsole->charColumns(ch,columnsBefore);
         }
-        if (charColumn > 0) {
-            columnsBefore += charColumn;
-            s += ch;
+        columnsBefore += charColumn;
+    }
+}
+
+void ConsoleLines::ensureLineBroken(int line)
+{
+    int slot = slotOf(line);
+    PConsoleLine consoleLine = mLines[slot];
+    if (consoleLine->layoutVersion == mLayoutVersion)
+        return;
+    breakLine(consoleLine);
+    int rows = consoleLine->breaks.count()+1;
+    if (rows != consoleLine->rows) {
+        setLineRows(slot,rows);
+        if (!mRowCountTimer.isActive())
+            mRowCountTimer.start(0);
+    }
+}
+
+int ConsoleLines::estimateRows(const QString &text) const
+{
+    int columnsPerRow = mConsole->columnsPerRow();
+    if (columnsPerRow<=0 || text.length()<=columnsPerRow)
+        return 1;
+    return (text.length()+columnsPerRow-1)/columnsPerRow;
+}
+
+QString ConsoleLines::rowText(const PConsoleLine &line, int row) const
+{
+    int start = (row==0)?0:line->breaks[row-1];
+    int end = (row<line->breaks.count())?line->breaks[row]:line->text.length();
+    return line->text.mid(start,end-start);
+}
+
+PConsoleLine ConsoleLines::lineAt(int line) const
+{
+    return mLines[slotOf(line)];
+}
+
+int ConsoleLines::slotOf(int line) const
+{
+    return (mFirst+line) % mLines.count();
+}
+
+void ConsoleLines::setLineRows(int slot, int rows)
+{
+    if (!mRowIndexValid) {
+        //counted when the index is rebuilt
+        mLines[slot]->rows = rows;
+        return;
+    }
+    int delta = rows - mLines[slot]->rows;
+    mLines[slot]->rows = rows;
+    addToRowIndex(slot,delta);
+    mRows += delta;
+}
+
+void ConsoleLines::appendLine(const PConsoleLine &line)
+{
+    if (mCount == mLines.count()) {
+        int capacity = std::max(64,mLines.count()*2);
+        if (mMaxLines>0)
+            capacity = std::min(capacity,mMaxLines);
+        resizeBuffer(std::max(capacity,mCount+1),0);
+    }
+    int slot = slotOf(mCount);
+    int rows = line->breaks.count()+1;
+    line->rows = 0;
+    mLines[slot] = line;
+    mCount++;
+    setLineRows(slot,rows);
+}
+
+void ConsoleLines::removeFirstLine()
+{
+    setLineRows(mFirst,0);
+    mLines[mFirst].reset();
+    mFirst = (mFirst+1) % mLines.count();
+    mCount--;
+}
+
+void ConsoleLines::resizeBuffer(int capacity, int firstLine)
+{
+    ConsoleLineList lines(capacity);
+    int count = std::min(mCount-firstLine,capacity);
+    for (int i=0;i<count;i++) {
+        lines[i] = lineAt(firstLine+i);
+    }
+    mLines = lines;
+    mFirst = 0;
+    mCount = count;
+    invalidateRowIndex();
+}
+
+int ConsoleLines::rowsBefore(int line) const
+{
+    ensureRowIndex();
+    int slot = slotOf(line);
+    int firstPrefix = rowIndexPrefix(mFirst);
+    if (slot >= mFirst)
+        return rowIndexPrefix(slot) - firstPrefix;
+    //the line is wrapped around to the start of the ring buffer
+    return (mRows - firstPrefix) + rowIndexPrefix(slot);
+}
+
+int ConsoleLines::lineAtRow(int row) const
+{
+    if (mCount<=0)
+        return -1;
+    ensureRowIndex();
+    if (row>=mRows)
+        return mCount-1;
+    int firstPrefix = rowIndexPrefix(mFirst);
+    int tailRows = mRows - firstPrefix;
+    int slot;
+    if (row < tailRows)
+        slot = findInRowIndex(row+firstPrefix);
+    else
+        slot = findInRowIndex(row-tailRows);
+    return (slot - mFirst + mLines.count()) % mLines.count();
+}
+
+void ConsoleLines::ensureRowIndex() const
+{
+    if (!mRowIndexValid)
+        rebuildRowIndex();
+}
+
+void ConsoleLines::invalidateRowIndex()
+{
+    mRowIndexValid = false;
+}
+
+void ConsoleLines::rebuildRowIndex() const
+{
+    int n = mLines.count();
+    mRowIndex.fill(0,n+1);
+    mRows = 0;
+    for (int i=0;i<n;i++) {
+        const PConsoleLine& consoleLine = mLines[i];
+        if (consoleLine) {
+            if (consoleLine->layoutVersion != mLayoutVersion)
+                consoleLine->rows = estimateRows(consoleLine->text);
+            mRowIndex[i+1] += consoleLine->rows;
+            mRows += consoleLine->rows;
         }
     }
-    if (fragments.count() == 0 || !s.isEmpty()) {
-        fragments.append(s);
-        if (columnsBefore > maxColLen) {
-            maxColLen = columnsBefore;
+    for (int i=1;i<=n;i++) {
+        int parent = i + (i & -i);
+        if (parent<=n)
+            mRowIndex[parent] += mRowIndex[i];
+    }
+    mRowIndexValid = true;
+}
+
+void ConsoleLines::addToRowIndex(int slot, int rows)
+{
+    for (int i=slot+1;i<mRowIndex.count();i+=(i & -i)) {
+        mRowIndex[i] += rows;
+    }
+}
+
+int ConsoleLines::rowIndexPrefix(int slot) const
+{
+    int sum = 0;
+    for (int i=slot;i>0;i-=(i & -i)) {
+        sum += mRowIndex[i];
+    }
+    return sum;
+}
+
+int ConsoleLines::findInRowIndex(int rows) const
+{
+    //the slot whose rows contain the row 'rows' (0-based, counted from slot 0)
+    int n = mRowIndex.count()-1;
+    int step = 1;
+    while (step*2<=n)
+        step*=2;
+    int pos = 0;
+    for (;step>0;step/=2) {
+        if (pos+step<=n && mRowIndex[pos+step]<=rows) {
+            pos += step;
+            rows -= mRowIndex[pos];
         }
     }
-    return maxColLen;
+    return pos;
 }
 
 int ConsoleLines::getMaxLines() const
@@ -1266,15 +1447,19 @@ int ConsoleLines::maxLines() const
 void ConsoleLines::setMaxLines(int maxLines)
 {
     mMaxLines = maxLines;
-    if (mMaxLines > 0) {
-        while (mLines.count()>mMaxLines) {
-            mLines.pop_front();
-        }
+    if (mMaxLines > 0 && mCount>mMaxLines) {
+        resizeBuffer(mMaxLines,mCount-mMaxLines);
+        emit layoutStarted();
+        emit layoutFinished();
     }
 }
 
 void ConsoleLines::clear()
 {
     mLines.clear();
+    mRowIndex.clear();
+    mRowIndexValid = true;
+    mFirst = 0;
+    mCount = 0;
     mRows = 0;
 }
@@ -18,13 +18,15 @@
 #define QCONSOLE_H
 
 #include <QAbstractScrollArea>
+#include <QTimer>
 #include <QVector>
 #include <memory>
 
 struct ConsoleLine {
     QString text;
-    QStringList fragments;
-    int maxColumns;
+    QVector<int> breaks; // index of the first char of each row except the first one
+    int rows; // rows of the line counted in the row index, estimated if it's not broken
+    int layoutVersion; // the layout that breaks are made for, -1 if not broken yet
 };
 
 enum class ConsoleCaretType {
@@ -94,16 +96,43 @@ signals:
     void rowsAdded(int rowCount);
     void lastRowsRemoved(int rowCount);
     void lastRowsChanged(int rowCount);
+    //rows are changed when lines are broken for the current layout,
+    //emitted at most once per pass of the event loop
+    void rowCountChanged();
 private:
-    int breakLine(const QString& line, QStringList& fragments);
+    void breakLine(const PConsoleLine& line);
+    void ensureLineBroken(int line);
+    int estimateRows(const QString& text) const;
+    QString rowText(const PConsoleLine& line, int row) const;
+    PConsoleLine lineAt(int line) const;
+    int slotOf(int line) const;
+    void setLineRows(int slot, int rows);
+    void appendLine(const PConsoleLine& line);
+    void removeFirstLine();
+    void resizeBuffer(int capacity, int firstLine);
+    int rowsBefore(int line) const;
+    int lineAtRow(int row) const;
+    //row index: a fenwick tree of the rows of each slot in the ring buffer,
+    //rebuilt when it's first used after a relayout
+    void ensureRowIndex() const;
+    void invalidateRowIndex();
+    void rebuildRowIndex() const;
+    void addToRowIndex(int slot, int rows);
+    int rowIndexPrefix(int slot) const;
+    int findInRowIndex(int rows) const;
 private:
-    ConsoleLineList mLines;
-    int mRows;
+    ConsoleLineList mLines; // ring buffer, line 0 is in slot mFirst
+    int mFirst;
+    int mCount;
+    mutable QVector<int> mRowIndex;
+    mutable int mRows;
+    mutable bool mRowIndexValid;
+    int mLayoutVersion;
     bool mLayouting;
     bool mNeedRelayout;
-    int mOldTabSize;
     QConsole* mConsole;
     int mMaxLines;
+    QTimer mRowCountTimer;
 };
 
 
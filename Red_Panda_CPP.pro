@@ -31,6 +31,20 @@ redpanda-git-askpass.subdir = tools/redpanda-git-askpass
 RedPandaIDE.depends += redpanda-git-askpass
 }
 
+linux: {
+SUBDIRS += \
+    casesupervisor
+casesupervisor.subdir = tools/casesupervisor
+RedPandaIDE.depends += casesupervisor
+}
+
+# unit tests and benchmarks, enabled by "qmake CONFIG+=tests", run by "make check"
+tests: {
+SUBDIRS += \
+    tests
+tests.depends = qsynedit redpanda_qt_utils
+}
+
 APP_NAME = RedPandaCPP
 
 APP_VERSION = 1.5
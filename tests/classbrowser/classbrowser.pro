@@ -0,0 +1,6 @@
+include(../test.pri)
+
+TARGET = tst_classbrowser
+
+SOURCES += \
+    tst_classbrowser.cpp
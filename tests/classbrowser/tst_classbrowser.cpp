@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <QtTest>
+#include "testenvironment.h"
+#include "widgets/classbrowser.h"
+
+//10000 functions and 100 structs of 99 members
+#define TEST_FUNCTIONS 10000
+#define TEST_STRUCTS 100
+#define TEST_STRUCT_MEMBERS 99
+//structs expanded in the view
+#define TEST_EXPANDED_STRUCTS 10
+//edits measured by a regular run, set CLASSBROWSER_BENCHMARK_EDITS for a longer one
+#define TEST_EDITS 30
+
+class TestClassBrowser : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void editKeepsNodes();
+    void edits();
+private:
+    void writeSource(int edit);
+    void fill(ClassBrowserModel& model);
+    void reparse(ClassBrowserModel& model, int edit);
+    QList<QPersistentModelIndex> expandStructs(ClassBrowserModel& model, int count);
+private:
+    TestEnvironment* mEnvironment;
+    PCppParser mParser;
+    QString mFileName;
+};
+
+void TestClassBrowser::initTestCase()
+{
+    mEnvironment = new TestEnvironment();
+    mFileName = mEnvironment->tempPath("big.cpp");
+    mParser = std::make_shared<CppParser>();
+    mParser->reset();
+    mParser->setEnabled(true);
+}
+
+void TestClassBrowser::cleanupTestCase()
+{
+    mParser.reset();
+    delete mEnvironment;
+}
+
+//an edit renames one of the functions
+void TestClassBrowser::writeSource(int edit)
+{
+    QFile file(mFileName);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    QTextStream stream(&file);
+    for (int i=0;i<TEST_FUNCTIONS;i++) {
+        if (edit>=0 && i == edit % TEST_FUNCTIONS)
+            stream << QString("int edited%1(int a);\n").arg(edit);
+        else
+            stream << QString("int f%1(int a);\n").arg(i);
+    }
+    for (int i=0;i<TEST_STRUCTS;i++) {
+        stream << QString("struct S%1 {\n").arg(i);
+        for (int j=0;j<TEST_STRUCT_MEMBERS;j++)
+            stream << QString("    int m%1;\n").arg(j);
+        stream << "};\n";
+    }
+}
+
+void TestClassBrowser::fill(ClassBrowserModel &model)
+{
+    writeSource(-1);
+    model.beginUpdate();
+    model.setParser(mParser);
+    model.setCurrentFile(mFileName);
+    mParser->parseFile(mFileName, false);
+    model.endUpdate();
+}
+
+void TestClassBrowser::reparse(ClassBrowserModel &model, int edit)
+{
+    writeSource(edit);
+    //the model is filled when the update ends, as the ide does after parsing
+    model.beginUpdate();
+    mParser->parseFile(mFileName, false);
+    model.endUpdate();
+}
+
+QList<QPersistentModelIndex> TestClassBrowser::expandStructs(ClassBrowserModel &model, int count)
+{
+    QList<QPersistentModelIndex> structs;
+    int rows = model.rowCount(QModelIndex());
+    for (int i=0;i<rows && structs.count()<count;i++) {
+        QModelIndex index = model.index(i,0,QModelIndex());
+        if (!model.data(index,Qt::DisplayRole).toString().startsWith("S"))
+            continue;
+        if (model.canFetchMore(index))
+            model.fetchMore(index);
+        structs.append(index);
+    }
+    return structs;
+}
+
+void TestClassBrowser::editKeepsNodes()
+{
+    ClassBrowserModel model;
+    fill(model);
+    QCOMPARE(model.rowCount(QModelIndex()), TEST_FUNCTIONS + TEST_STRUCTS);
+    QList<QPersistentModelIndex> structs = expandStructs(model, 1);
+    QCOMPARE(structs.count(), 1);
+    QCOMPARE(model.rowCount(structs[0]), TEST_STRUCT_MEMBERS);
+    QString structName = model.data(structs[0],Qt::DisplayRole).toString();
+
+    reparse(model, 0);
+    QCOMPARE(model.rowCount(QModelIndex()), TEST_FUNCTIONS + TEST_STRUCTS);
+    //the expanded struct keeps its index and its members
+    QVERIFY(structs[0].isValid());
+    QCOMPARE(model.data(structs[0],Qt::DisplayRole).toString(), structName);
+    QCOMPARE(model.rowCount(structs[0]), TEST_STRUCT_MEMBERS);
+    bool found = false;
+    for (int i=0;i<model.rowCount(QModelIndex()) && !found;i++) {
+        QModelIndex index = model.index(i,0,QModelIndex());
+        found = model.data(index,Qt::DisplayRole).toString().startsWith("edited0");
+    }
+    QVERIFY(found);
+}
+
+void TestClassBrowser::edits()
+{
+    ClassBrowserModel model;
+    fill(model);
+    QList<QPersistentModelIndex> structs = expandStructs(model, TEST_EXPANDED_STRUCTS);
+    QCOMPARE(structs.count(), TEST_EXPANDED_STRUCTS);
+    //only the model's update is measured, not the parsing
+    int edits = qEnvironmentVariableIntValue("CLASSBROWSER_BENCHMARK_EDITS");
+    if (edits<=0)
+        edits = TEST_EDITS;
+    qint64 total = 0;
+    QElapsedTimer timer;
+    for (int i=0;i<edits;i++) {
+        writeSource(i);
+        model.beginUpdate();
+        mParser->parseFile(mFileName, false);
+        timer.start();
+        model.endUpdate();
+        total += timer.nsecsElapsed();
+    }
+    QTest::setBenchmarkResult(total / 1000000.0 / edits, QTest::WalltimeMilliseconds);
+    QCOMPARE(model.rowCount(QModelIndex()), TEST_FUNCTIONS + TEST_STRUCTS);
+    foreach (const QPersistentModelIndex& index, structs) {
+        QVERIFY(index.isValid());
+        QCOMPARE(model.rowCount(index), TEST_STRUCT_MEMBERS);
+    }
+}
+
+QTEST_MAIN(TestClassBrowser)
+
+#include "tst_classbrowser.moc"
@@ -0,0 +1,6 @@
+include(../test.pri)
+
+TARGET = tst_competitivecompanionreceiver
+
+SOURCES += \
+    tst_competitivecompanionreceiver.cpp
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include "problems/competitivecompanionreceiver.h"
+
+//short limits, so the error cases don't take long
+#define TEST_MAX_REQUEST_SIZE 4096
+#define TEST_REQUEST_TIMEOUT 500
+
+/*
+ * Each test is a scripted client on the loopback interface: it sends the
+ * request in the given parts, with a pause between them so the receiver gets
+ * them in separate reads, and returns the status code of the reply.
+ */
+class TestCompetitiveCompanionReceiver : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void splitHeaders();
+    void chunkedBody();
+    void oversizedHeader();
+    void oversizedBody();
+    void timeout();
+    void badMethod();
+    void badVersion();
+    void badJson();
+private:
+    int request(const QList<QByteArray>& parts, int pause = 20);
+    static QByteArray problemJson();
+private:
+    CompetitiveCompanionReceiver* mReceiver;
+    int mPort;
+    QList<POJProblem> mProblems;
+};
+
+void TestCompetitiveCompanionReceiver::initTestCase()
+{
+    qRegisterMetaType<POJProblem>("POJProblem");
+    //find a free port
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+    mPort = server.serverPort();
+    server.close();
+
+    mReceiver = new CompetitiveCompanionReceiver(mPort);
+    mReceiver->setMaxRequestSize(TEST_MAX_REQUEST_SIZE);
+    mReceiver->setRequestTimeout(TEST_REQUEST_TIMEOUT);
+    //problems are emitted in the receiver's thread
+    connect(mReceiver, &CompetitiveCompanionReceiver::problemReceived,
+            this, [this](POJProblem problem){
+        mProblems.append(problem);
+    }, Qt::QueuedConnection);
+    mReceiver->start();
+
+    //wait until the receiver listens
+    bool listening = false;
+    for (int i=0;i<50 && !listening;i++) {
+        QTcpSocket socket;
+        socket.connectToHost(QHostAddress::LocalHost, mPort);
+        listening = socket.waitForConnected(100);
+        if (!listening)
+            QThread::msleep(100);
+    }
+    QVERIFY(listening);
+}
+
+void TestCompetitiveCompanionReceiver::cleanupTestCase()
+{
+    mReceiver->quit();
+    mReceiver->wait();
+    delete mReceiver;
+}
+
+void TestCompetitiveCompanionReceiver::init()
+{
+    mProblems.clear();
+}
+
+int TestCompetitiveCompanionReceiver::request(const QList<QByteArray> &parts, int pause)
+{
+    QTcpSocket socket;
+    socket.connectToHost(QHostAddress::LocalHost, mPort);
+    if (!socket.waitForConnected(5000))
+        return -1;
+    for (int i=0;i<parts.length();i++) {
+        if (i>0)
+            QThread::msleep(pause);
+        socket.write(parts[i]);
+        socket.waitForBytesWritten(5000);
+    }
+    //the receiver closes the connection after the reply
+    QByteArray response;
+    while (socket.state() == QAbstractSocket::ConnectedState
+           && socket.waitForReadyRead(5000)) {
+        response.append(socket.readAll());
+    }
+    response.append(socket.readAll());
+    //"HTTP/1.1 200 OK"
+    QList<QByteArray> statusLine = response.left(response.indexOf('\r')).split(' ');
+    if (statusLine.length()<2 || !statusLine[0].startsWith("HTTP/1."))
+        return -1;
+    return statusLine[1].toInt();
+}
+
+QByteArray TestCompetitiveCompanionReceiver::problemJson()
+{
+    return "{\"name\":\"A. Test\",\"url\":\"http://localhost/a\","
+           "\"tests\":[{\"input\":\"1 2\\n\",\"output\":\"3\\n\"}]}";
+}
+
+void TestCompetitiveCompanionReceiver::splitHeaders()
+{
+    QByteArray body = problemJson();
+    int half = body.length()/2;
+    QList<QByteArray> parts;
+    parts << "POST / HTTP/1.1\r\nHost: local"
+          << "host\r\nContent-Le"
+          << QString("ngth: %1\r").arg(body.length()).toLatin1()
+          << "\n\r\n" + body.left(half)
+          << body.mid(half);
+    QCOMPARE(request(parts), 200);
+    QTRY_COMPARE(mProblems.length(), 1);
+    QCOMPARE(mProblems[0]->name, QString("A. Test"));
+    QCOMPARE(mProblems[0]->cases.length(), 1);
+    QCOMPARE(mProblems[0]->cases[0]->input.text(), QString("1 2\n"));
+    QCOMPARE(mProblems[0]->cases[0]->expected.text(), QString("3\n"));
+}
+
+void TestCompetitiveCompanionReceiver::chunkedBody()
+{
+    QByteArray body = problemJson();
+    int third = body.length()/3;
+    QByteArray chunk1 = body.left(third);
+    QByteArray chunk2 = body.mid(third);
+    QList<QByteArray> parts;
+    parts << "POST / HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\n\r\n"
+          << QByteArray::number(chunk1.length(),16) + "\r\n" + chunk1.left(5)
+          << chunk1.mid(5) + "\r\n" + QByteArray::number(chunk2.length(),16)
+          << ";ext=1\r\n" + chunk2 + "\r\n0\r"
+          << "\n\r\n";
+    QCOMPARE(request(parts), 200);
+    QTRY_COMPARE(mProblems.length(), 1);
+    QCOMPARE(mProblems[0]->url, QString("http://localhost/a"));
+    QCOMPARE(mProblems[0]->cases.length(), 1);
+}
+
+void TestCompetitiveCompanionReceiver::oversizedHeader()
+{
+    //the header is too long only with its last byte, so the receiver has read
+    //everything when it replies, and the reply is not lost in a reset
+    QByteArray header = "X-Padding: ";
+    header.append(QByteArray(HTTP_MAX_HEADER_SIZE+1-header.length(),'a'));
+    QList<QByteArray> parts;
+    parts << "POST / HTTP/1.1\r\n"
+          << header;
+    QCOMPARE(request(parts), 431);
+    QCOMPARE(mProblems.length(), 0);
+}
+
+void TestCompetitiveCompanionReceiver::oversizedBody()
+{
+    QList<QByteArray> parts;
+    parts << QString("POST / HTTP/1.1\r\nContent-Length: %1\r\n")
+             .arg(TEST_MAX_REQUEST_SIZE+1).toLatin1();
+    QCOMPARE(request(parts), 413);
+
+    //chunks are counted together
+    parts.clear();
+    parts << "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+          << QByteArray::number(TEST_MAX_REQUEST_SIZE/2,16) + "\r\n"
+             + QByteArray(TEST_MAX_REQUEST_SIZE/2,'a') + "\r\n"
+          << QByteArray::number(TEST_MAX_REQUEST_SIZE/2+1,16) + "\r\n";
+    QCOMPARE(request(parts), 413);
+    QCOMPARE(mProblems.length(), 0);
+}
+
+void TestCompetitiveCompanionReceiver::timeout()
+{
+    QElapsedTimer timer;
+    timer.start();
+    QList<QByteArray> parts;
+    parts << "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\n12345";
+    QCOMPARE(request(parts), 408);
+    QVERIFY(timer.elapsed() >= TEST_REQUEST_TIMEOUT);
+    QCOMPARE(mProblems.length(), 0);
+}
+
+void TestCompetitiveCompanionReceiver::badMethod()
+{
+    QList<QByteArray> parts;
+    parts << "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    QCOMPARE(request(parts), 405);
+}
+
+void TestCompetitiveCompanionReceiver::badVersion()
+{
+    QList<QByteArray> parts;
+    parts << "POST / HTTP/2.0\r\nHost: localhost\r\n\r\n";
+    QCOMPARE(request(parts), 505);
+}
+
+void TestCompetitiveCompanionReceiver::badJson()
+{
+    QList<QByteArray> parts;
+    QByteArray body = problemJson();
+    body.chop(1);
+    parts << QString("POST / HTTP/1.1\r\nContent-Length: %1\r\n\r\n")
+             .arg(body.length()).toLatin1() + body;
+    QCOMPARE(request(parts), 400);
+
+    //valid json, but not a problem
+    body = "{\"name\":\"A. Test\"}";
+    parts.clear();
+    parts << QString("POST / HTTP/1.1\r\nContent-Length: %1\r\n\r\n")
+             .arg(body.length()).toLatin1() + body;
+    QCOMPARE(request(parts), 400);
+    QCOMPARE(mProblems.length(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestCompetitiveCompanionReceiver)
+
+#include "tst_competitivecompanionreceiver.moc"
@@ -0,0 +1,6 @@
+include(../test.pri)
+
+TARGET = tst_gdbmilinebuffer
+
+SOURCES += \
+    tst_gdbmilinebuffer.cpp
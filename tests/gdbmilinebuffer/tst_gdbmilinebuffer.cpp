@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <QtTest>
+#include "gdbmiresultparser.h"
+
+class TestGDBMILineBuffer : public QObject
+{
+    Q_OBJECT
+private slots:
+    void splitLines_data();
+    void splitLines();
+    void longResponse();
+};
+
+void TestGDBMILineBuffer::splitLines_data()
+{
+    QTest::addColumn<int>("chunkSize");
+    QTest::newRow("whole") << 1024;
+    QTest::newRow("bytes") << 1;
+    QTest::newRow("pairs") << 2;
+    QTest::newRow("odd") << 7;
+}
+
+void TestGDBMILineBuffer::splitLines()
+{
+    QFETCH(int, chunkSize);
+    QByteArray output = "^done,value=\"1\"\r\n(gdb) \n\n~\"text\"\r\n*stopped";
+    GDBMILineBuffer buffer;
+    QList<QByteArray> lines;
+    QByteArray line;
+    for (int i=0;i<output.length();i+=chunkSize) {
+        buffer.append(output.mid(i, chunkSize));
+        while (buffer.takeLine(line))
+            lines.append(line);
+    }
+    QCOMPARE(lines, (QList<QByteArray>{"^done,value=\"1\"", "(gdb) ", "", "~\"text\""}));
+    //the incomplete line is kept until its end arrives
+    buffer.append("\n");
+    QVERIFY(buffer.takeLine(line));
+    QCOMPARE(line, QByteArray("*stopped"));
+    QVERIFY(!buffer.takeLine(line));
+}
+
+void TestGDBMILineBuffer::longResponse()
+{
+    //a 10 MB result (e.g. a big memory dump) read in pipe sized chunks
+    const int responseSize = 10*1024*1024;
+    const int chunkSize = 64*1024;
+    QByteArray response = "^done,memory=[{begin=\"0x0\",contents=\"";
+    response.append(QByteArray(responseSize, 'f'));
+    response.append("\"}]\n(gdb) \n");
+    QList<QByteArray> chunks;
+    for (int i=0;i<response.length();i+=chunkSize)
+        chunks.append(response.mid(i, chunkSize));
+    int lineCount = 0;
+    int length = 0;
+    QBENCHMARK {
+        GDBMILineBuffer buffer;
+        QByteArray line;
+        lineCount = 0;
+        length = 0;
+        foreach (const QByteArray& chunk, chunks) {
+            buffer.append(chunk);
+            while (buffer.takeLine(line)) {
+                lineCount++;
+                length = std::max(length, line.length());
+            }
+        }
+    }
+    QCOMPARE(lineCount, 2);
+    QCOMPARE(length, response.indexOf('\n'));
+}
+
+QTEST_APPLESS_MAIN(TestGDBMILineBuffer)
+
+#include "tst_gdbmilinebuffer.moc"
@@ -0,0 +1,6 @@
+include(../test.pri)
+
+TARGET = tst_gdbmiresultparser
+
+SOURCES += \
+    tst_gdbmiresultparser.cpp
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <QtTest>
+#include "gdbmiresultparser.h"
+
+/**
+ * Parse throughput of the results gdb sends in bulk: deep stacks, arrays
+ * with many children and big memory dumps.
+ */
+class TestGDBMIResultParser : public QObject
+{
+    Q_OBJECT
+private slots:
+    void parseValues();
+    void parseUnknownEscapes();
+    void parseStack();
+    void parseVarChildren();
+    void parseMemory();
+private:
+    static QByteArray makeStack(int frames);
+    static QByteArray makeVarChildren(int children);
+    static QByteArray makeMemory(int bytes);
+};
+
+void TestGDBMIResultParser::parseValues()
+{
+    GDBMIResultParser parser;
+    GDBMIResultType type;
+    GDBMIResultParser::ParseObject multiValues;
+    QByteArray record = "value=\"say \\\"hi\\\"\\n\",list=[\"1\",\"2\"],obj={a=\"0x10\",b=\"7\"}";
+    QVERIFY(parser.parse(record, "-data-evaluate-expression", type, multiValues));
+    QVERIFY(type == GDBMIResultType::Evaluation);
+    QCOMPARE(multiValues["value"].value(), QByteArray("say \"hi\"\n"));
+    QCOMPARE(multiValues["list"].array().count(), 2);
+    QCOMPARE(multiValues["list"].array()[1].intValue(), 2);
+    QCOMPARE(multiValues["obj"].object()["a"].hexValue(), 16);
+    QCOMPARE(multiValues["obj"].object()["b"].intValue(), 7);
+    QVERIFY(!multiValues["missing"].isValid());
+}
+
+void TestGDBMIResultParser::parseUnknownEscapes()
+{
+    GDBMIResultParser parser;
+    GDBMIResultType type;
+    GDBMIResultParser::ParseObject multiValues;
+    //only the backslash of an unknown escape is dropped
+    QByteArray record = "value=\"\\e[0m\\x41\\q\\101\"";
+    QVERIFY(parser.parse(record, "-data-evaluate-expression", type, multiValues));
+    QCOMPARE(multiValues["value"].value(), QByteArray("e[0mx41qA"));
+}
+
+QByteArray TestGDBMIResultParser::makeStack(int frames)
+{
+    QByteArray record = "stack=[";
+    for (int i=0;i<frames;i++) {
+        if (i>0)
+            record += ",";
+        record += QString("frame={level=\"%1\",addr=\"0x0000000000401%2\",func=\"recurse\","
+                          "file=\"main.cpp\",fullname=\"/home/user/project/main.cpp\",line=\"%3\",arch=\"i386:x86-64\"}")
+                .arg(i).arg(i % 1000, 3, 10, QChar('0')).arg(10+i).toLatin1();
+    }
+    record += "]";
+    return record;
+}
+
+QByteArray TestGDBMIResultParser::makeVarChildren(int children)
+{
+    QByteArray record = QString("numchild=\"%1\",children=[").arg(children).toLatin1();
+    for (int i=0;i<children;i++) {
+        if (i>0)
+            record += ",";
+        record += QString("child={name=\"var1.[%1]\",exp=\"%1\",numchild=\"0\",value=\"%2\",type=\"int\",thread-id=\"1\"}")
+                .arg(i).arg(i*7).toLatin1();
+    }
+    record += "],has_more=\"0\"";
+    return record;
+}
+
+QByteArray TestGDBMIResultParser::makeMemory(int bytes)
+{
+    return "memory=[{begin=\"0x0000000000404000\",offset=\"0x0000000000000000\",end=\"0x0000000000504000\",contents=\""
+            + QByteArray(bytes*2, 'a') + "\"}]";
+}
+
+void TestGDBMIResultParser::parseStack()
+{
+    QByteArray record = makeStack(10000);
+    GDBMIResultParser parser;
+    int count = 0;
+    QBENCHMARK {
+        GDBMIResultType type;
+        GDBMIResultParser::ParseObject multiValues;
+        QVERIFY(parser.parse(record, "-stack-list-frames", type, multiValues));
+        count = 0;
+        foreach (const GDBMIResultParser::ParseValue& frame, multiValues["stack"].array()) {
+            if (frame.object()["line"].intValue()>0)
+                count++;
+        }
+    }
+    QCOMPARE(count, 10000);
+}
+
+void TestGDBMIResultParser::parseVarChildren()
+{
+    QByteArray record = makeVarChildren(100000);
+    GDBMIResultParser parser;
+    int count = 0;
+    QBENCHMARK {
+        GDBMIResultType type;
+        GDBMIResultParser::ParseObject multiValues;
+        QVERIFY(parser.parse(record, "-var-list-children", type, multiValues));
+        count = multiValues["children"].array().count();
+    }
+    QCOMPARE(count, 100000);
+}
+
+void TestGDBMIResultParser::parseMemory()
+{
+    QByteArray record = makeMemory(1024*1024);
+    GDBMIResultParser parser;
+    int length = 0;
+    QBENCHMARK {
+        GDBMIResultType type;
+        GDBMIResultParser::ParseObject multiValues;
+        QVERIFY(parser.parse(record, "-data-read-memory-bytes", type, multiValues));
+        length = multiValues["memory"].array()[0].object()["contents"].value().length();
+    }
+    QCOMPARE(length, 2*1024*1024);
+}
+
+QTEST_APPLESS_MAIN(TestGDBMIResultParser)
+
+#include "tst_gdbmiresultparser.moc"
@@ -0,0 +1,6 @@
+include(../test.pri)
+
+TARGET = tst_gitrepository
+
+SOURCES += \
+    tst_gitrepository.cpp
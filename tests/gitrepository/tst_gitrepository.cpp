@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <QtTest>
+#include <QTemporaryDir>
+#include "testenvironment.h"
+#include "vcs/gitrepository.h"
+
+//time to wait for a background refresh
+#define TEST_REFRESH_TIMEOUT 10000
+
+/*
+ * Each test works on a new repository in a temporary folder. Changes made by
+ * other git commands or editors must be read in the background, while the
+ * results of the repository's own commands must be there right away.
+ */
+class TestGitRepository : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+    void ownCommandsRefreshNow();
+    void fileChangesRefreshInBackground();
+    void otherGitCommandsRefreshInBackground();
+    void invalidateRefreshesInBackground();
+private:
+    bool runGit(const QStringList& args);
+    void writeFile(const QString& name, const QByteArray& content);
+    QString filePath(const QString& name) const;
+private:
+    TestEnvironment* mEnvironment;
+    QTemporaryDir* mDir;
+    QString mFolder;
+    GitRepository* mRepository;
+};
+
+void TestGitRepository::initTestCase()
+{
+    mEnvironment = new TestEnvironment();
+    pSettings->vcs().detectGitInPath();
+    if (!pSettings->vcs().gitOk())
+        QSKIP("git is not found");
+}
+
+void TestGitRepository::cleanupTestCase()
+{
+    delete mEnvironment;
+}
+
+void TestGitRepository::init()
+{
+    mRepository = nullptr;
+    mDir = new QTemporaryDir();
+    QVERIFY(mDir->isValid());
+    mFolder = mDir->path();
+    QVERIFY(runGit({"init"}));
+    QVERIFY(runGit({"config","user.name","test"}));
+    QVERIFY(runGit({"config","user.email","test@localhost"}));
+    writeFile("main.cpp", "int main() {}\n");
+    QVERIFY(runGit({"add","main.cpp"}));
+    QVERIFY(runGit({"commit","-m","init"}));
+    mRepository = new GitRepository(mDir->path());
+    //the repository keeps the folder git reports, with links resolved
+    mFolder = mRepository->folder();
+    QString branch;
+    QVERIFY(mRepository->hasRepository(branch));
+    QVERIFY(mRepository->isFileInRepository(filePath("main.cpp")));
+    QVERIFY(!mRepository->hasChangedFiles());
+}
+
+void TestGitRepository::cleanup()
+{
+    delete mRepository;
+    delete mDir;
+}
+
+bool TestGitRepository::runGit(const QStringList &args)
+{
+    QProcess process;
+    process.setWorkingDirectory(mDir->path());
+    process.start(pSettings->vcs().gitPath(), args);
+    return process.waitForFinished()
+            && process.exitStatus() == QProcess::NormalExit
+            && process.exitCode() == 0;
+}
+
+void TestGitRepository::writeFile(const QString &name, const QByteArray &content)
+{
+    QFile file(filePath(name));
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    file.write(content);
+}
+
+QString TestGitRepository::filePath(const QString &name) const
+{
+    return QDir(mFolder).absoluteFilePath(name);
+}
+
+void TestGitRepository::ownCommandsRefreshNow()
+{
+    writeFile("a.cpp", "int a;\n");
+    QString output;
+    QVERIFY(mRepository->add("a.cpp", output));
+    mRepository->update();
+    QVERIFY(mRepository->isFileStaged(filePath("a.cpp")));
+
+    QVERIFY(mRepository->commit("add a.cpp", output));
+    mRepository->update();
+    QVERIFY(!mRepository->hasStagedFiles());
+    QVERIFY(mRepository->isFileInRepository(filePath("a.cpp")));
+}
+
+void TestGitRepository::fileChangesRefreshInBackground()
+{
+    QSignalSpy spy(mRepository, &GitRepository::statusChanged);
+    writeFile("main.cpp", "int main() { return 0; }\n");
+    //let the watcher see the change, but not the refresh delay end
+    QTest::qWait(GIT_STATUS_REFRESH_DELAY / 5);
+    mRepository->update();
+    QVERIFY(!mRepository->isFileChanged(filePath("main.cpp")));
+
+    QVERIFY(spy.wait(TEST_REFRESH_TIMEOUT));
+    QVERIFY(mRepository->isFileChanged(filePath("main.cpp")));
+}
+
+void TestGitRepository::otherGitCommandsRefreshInBackground()
+{
+    QSignalSpy spy(mRepository, &GitRepository::statusChanged);
+    writeFile("b.cpp", "int b;\n");
+    QVERIFY(runGit({"add","b.cpp"}));
+    //the index is changed, but the cached status is used until git has read it
+    mRepository->update();
+    QVERIFY(!mRepository->isFileStaged(filePath("b.cpp")));
+
+    QVERIFY(spy.wait(TEST_REFRESH_TIMEOUT));
+    QVERIFY(mRepository->isFileStaged(filePath("b.cpp")));
+    QVERIFY(mRepository->isFileInRepository(filePath("b.cpp")));
+}
+
+void TestGitRepository::invalidateRefreshesInBackground()
+{
+    QSignalSpy spy(mRepository, &GitRepository::statusChanged);
+    writeFile("main.cpp", "int main() { return 1; }\n");
+    mRepository->invalidate();
+    mRepository->update();
+    QVERIFY(!mRepository->isFileChanged(filePath("main.cpp")));
+
+    QVERIFY(spy.wait(TEST_REFRESH_TIMEOUT));
+    QVERIFY(mRepository->isFileChanged(filePath("main.cpp")));
+}
+
+QTEST_MAIN(TestGitRepository)
+
+#include "tst_gitrepository.moc"
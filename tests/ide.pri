@@ -0,0 +1,56 @@
+# Compile settings shared by the ide library and the tests linked with it
+
+QT += core gui printsupport network svg
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++17
+CONFIG += nokey
+
+IDE_DIR = $$PWD/../RedPandaIDE
+
+isEmpty(APP_NAME) {
+    APP_NAME = RedPandaCPP
+}
+
+isEmpty(APP_VERSION) {
+    APP_VERSION=1.5
+}
+
+isEmpty(PREFIX) {
+    PREFIX = /usr/local
+}
+
+macos: {
+    INCLUDEPATH += \
+        /opt/homebrew/opt/icu4c/include
+
+    QT += gui-private
+}
+
+win32: {
+DEFINES += _WIN32_WINNT=0x0601
+}
+
+DEFINES += PREFIX=\\\"$${PREFIX}\\\"
+DEFINES += APP_NAME=\\\"$${APP_NAME}\\\"
+DEFINES += REDPANDA_CPP_VERSION=\\\"$${APP_VERSION}\\\"
+
+gcc {
+    QMAKE_CXXFLAGS_RELEASE += -Werror=return-type
+    QMAKE_CXXFLAGS_DEBUG += -Werror=return-type
+}
+
+msvc {
+    DEFINES += NOMINMAX
+}
+
+CONFIG(debug_and_release_target) {
+    CONFIG(debug, debug|release) {
+        OBJ_OUT_PWD = debug
+    }
+    CONFIG(release, debug|release) {
+        OBJ_OUT_PWD = release
+    }
+}
+
+INCLUDEPATH += $$IDE_DIR $$PWD/../libs/qsynedit $$PWD/../libs/redpanda_qt_utils
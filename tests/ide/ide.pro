@@ -0,0 +1,22 @@
+# The ide's sources (except main.cpp) as a static library, so each test
+# doesn't compile them again.
+
+include(../ide.pri)
+
+TEMPLATE = lib
+CONFIG += staticlib
+
+# the source lists are read from the ide's project file, so they can't go stale
+IDE_SOURCES = $$fromfile($$IDE_DIR/RedPandaIDE.pro, SOURCES)
+IDE_HEADERS = $$fromfile($$IDE_DIR/RedPandaIDE.pro, HEADERS)
+IDE_FORMS = $$fromfile($$IDE_DIR/RedPandaIDE.pro, FORMS)
+
+for(file, IDE_SOURCES) {
+    !equals(file, main.cpp): SOURCES += $$IDE_DIR/$$file
+}
+for(file, IDE_HEADERS) {
+    HEADERS += $$IDE_DIR/$$file
+}
+for(file, IDE_FORMS) {
+    FORMS += $$IDE_DIR/$$file
+}
@@ -0,0 +1,6 @@
+include(../test.pri)
+
+TARGET = tst_ojproblemcasesrunner
+
+SOURCES += \
+    tst_ojproblemcasesrunner.cpp
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <QtTest>
+#include <QStandardPaths>
+#include "testenvironment.h"
+#include "compiler/ojproblemcasesrunner.h"
+
+class TestOJProblemCasesRunner : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void trivialCases_data();
+    void trivialCases();
+    void stopIsImmediate();
+private:
+    QVector<POJProblemCase> makeCases(int count);
+private:
+    TestEnvironment* mEnvironment;
+    QString mCat;
+};
+
+void TestOJProblemCasesRunner::initTestCase()
+{
+    mEnvironment = new TestEnvironment();
+    //a program that does (almost) nothing, so the time is the runner's overhead
+    mCat = QStandardPaths::findExecutable("cat");
+    if (mCat.isEmpty())
+        QSKIP("cat is not found");
+}
+
+void TestOJProblemCasesRunner::cleanupTestCase()
+{
+    delete mEnvironment;
+}
+
+QVector<POJProblemCase> TestOJProblemCasesRunner::makeCases(int count)
+{
+    QVector<POJProblemCase> cases;
+    for (int i=0;i<count;i++) {
+        POJProblemCase problemCase = std::make_shared<OJProblemCase>();
+        problemCase->name = QString("case %1").arg(i);
+        problemCase->input.setText(QString("%1\n").arg(i));
+        problemCase->expected.setText(QString("%1\n").arg(i));
+        cases.append(problemCase);
+    }
+    return cases;
+}
+
+void TestOJProblemCasesRunner::trivialCases_data()
+{
+    QTest::addColumn<int>("jobs");
+    QTest::newRow("serial") << 1;
+    QTest::newRow("parallel") << 4;
+}
+
+void TestOJProblemCasesRunner::trivialCases()
+{
+    QFETCH(int, jobs);
+    QVector<POJProblemCase> cases = makeCases(100);
+    QBENCHMARK {
+        OJProblemCasesRunner runner(mCat, "", QDir::tempPath(), cases);
+        runner.setJobs(jobs);
+        runner.start();
+        QVERIFY(runner.wait(60000));
+    }
+    foreach (const POJProblemCase& problemCase, cases) {
+        QCOMPARE(problemCase->output, problemCase->expected.text());
+        QVERIFY(problemCase->verdict == ProblemCaseVerdict::None);
+    }
+}
+
+void TestOJProblemCasesRunner::stopIsImmediate()
+{
+    QString sleep = QStandardPaths::findExecutable("sleep");
+    if (sleep.isEmpty())
+        QSKIP("sleep is not found");
+    OJProblemCasesRunner runner(sleep, "30", QDir::tempPath(), makeCases(1));
+    QSignalSpy startedSpy(&runner, &OJProblemCasesRunner::caseStarted);
+    runner.start();
+    QTRY_COMPARE(startedSpy.count(), 1);
+    //give the process time to start
+    QTest::qWait(200);
+    QElapsedTimer timer;
+    timer.start();
+    runner.stop();
+    QVERIFY(runner.wait(5000));
+    //stop requests wake up the runner's loop, there is no polling delay
+    QVERIFY(timer.elapsed() < 1000);
+}
+
+QTEST_MAIN(TestOJProblemCasesRunner)
+
+#include "tst_ojproblemcasesrunner.moc"
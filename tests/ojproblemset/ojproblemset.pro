@@ -0,0 +1,6 @@
+include(../test.pri)
+
+TARGET = tst_ojproblemset
+
+SOURCES += \
+    tst_ojproblemset.cpp
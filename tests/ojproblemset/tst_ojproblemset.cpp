@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <QtTest>
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "testenvironment.h"
+#include "widgets/ojproblemsetmodel.h"
+
+class TestOJProblemSet : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void migrateInlineData();
+private:
+    static QJsonObject readJson(const QString& fileName);
+private:
+    TestEnvironment* mEnvironment;
+};
+
+void TestOJProblemSet::initTestCase()
+{
+    mEnvironment = new TestEnvironment();
+}
+
+void TestOJProblemSet::cleanupTestCase()
+{
+    delete mEnvironment;
+}
+
+QJsonObject TestOJProblemSet::readJson(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly))
+        return QJsonObject();
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+void TestOJProblemSet::migrateInlineData()
+{
+    //a problem set saved by older versions, with all the data in the json file
+    QString bigInput = QString("1 2\n").repeated(OJ_CASE_DATA_SPILL_SIZE/4+1);
+    QString smallExpected = "3\n";
+    QJsonObject caseObj;
+    caseObj["name"]="case 1";
+    caseObj["input"]=bigInput;
+    caseObj["expected"]=smallExpected;
+    QJsonObject problemObj;
+    problemObj["name"]="A";
+    problemObj["cases"]=QJsonArray{caseObj};
+    QJsonObject obj;
+    obj["name"]="old";
+    obj["problems"]=QJsonArray{problemObj};
+    QString oldFile = mEnvironment->tempPath("old.json");
+    QFile file(oldFile);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    file.write(QJsonDocument(obj).toJson());
+    file.close();
+
+    OJProblemSetModel model;
+    model.loadFromFile(oldFile);
+    QCOMPARE(model.count(), 1);
+    POJProblemCase problemCase = model.problem(0)->cases[0];
+    QCOMPARE(problemCase->input.text(), bigInput);
+    QVERIFY(problemCase->input.hash().isEmpty());
+
+    //saving moves the big data to a data file named by its sha1
+    QString newFile = mEnvironment->tempPath("new.json");
+    model.saveToFile(newFile);
+    QByteArray content = bigInput.toUtf8();
+    QString hash = QCryptographicHash::hash(content,QCryptographicHash::Sha1).toHex();
+    QString dataFile = mEnvironment->tempPath("new_data/"+hash);
+    QCOMPARE(problemCase->input.hash(), hash);
+    QCOMPARE(problemCase->input.dataFile(), dataFile);
+    QCOMPARE(problemCase->input.size(), qint64(content.size()));
+    QFile saved(dataFile);
+    QVERIFY(saved.open(QFile::ReadOnly));
+    QCOMPARE(saved.readAll(), content);
+    saved.close();
+
+    QJsonObject savedProblem = readJson(newFile).value("problems").toArray().at(0).toObject();
+    QJsonObject savedCase = savedProblem.value("cases").toArray().at(0).toObject();
+    QCOMPARE(savedCase["input_data"].toString(), hash);
+    QVERIFY(!savedCase.contains("input"));
+    //small data stays in the json file
+    QCOMPARE(savedCase["expected"].toString(), smallExpected);
+    QVERIFY(!savedCase.contains("expected_data"));
+
+    //the data file is only read when the text is used
+    OJProblemSetModel reloaded;
+    reloaded.loadFromFile(newFile);
+    POJProblemCase reloadedCase = reloaded.problem(0)->cases[0];
+    QCOMPARE(reloadedCase->input.pendingDataFile(), dataFile);
+    QCOMPARE(reloadedCase->input.text(), bigInput);
+    QVERIFY(reloadedCase->input.pendingDataFile().isEmpty());
+    QCOMPARE(reloadedCase->expected.text(), smallExpected);
+}
+
+QTEST_GUILESS_MAIN(TestOJProblemSet)
+
+#include "tst_ojproblemset.moc"
@@ -0,0 +1,6 @@
+include(../test.pri)
+
+TARGET = tst_project
+
+SOURCES += \
+    tst_project.cpp
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <QtTest>
+#include <QFileSystemWatcher>
+#include <QSplitter>
+#include <QTabWidget>
+#include "testenvironment.h"
+#include "editorlist.h"
+#include "project.h"
+
+//a project of 100 folders with 100 files each
+#define TEST_FOLDERS 100
+#define TEST_FOLDER_FILES 100
+#define TEST_ADDS 1000
+
+/*
+ * The project is in the file system view, where folder nodes are made from
+ * the paths of the units. Its files are not on the disk, so only the
+ * project's own work is measured.
+ */
+class TestProject : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void open();
+    void addUnits();
+    void renameUnits();
+private:
+    std::shared_ptr<Project> load();
+    QString filePath(const QString& name) const;
+    static QString unitName(int folder, int file);
+    static PProjectModelNode specialNode(const std::shared_ptr<Project>& project, ProjectModelNodeType type);
+    static PProjectModelNode childFolder(const PProjectModelNode& parent, const QString& name);
+private:
+    TestEnvironment* mEnvironment;
+    QTabWidget* mLeftPageWidget;
+    QTabWidget* mRightPageWidget;
+    QSplitter* mSplitter;
+    QWidget* mPanel;
+    EditorList* mEditorList;
+    QFileSystemWatcher mWatcher;
+    QString mProjectFile;
+};
+
+void TestProject::initTestCase()
+{
+    mEnvironment = new TestEnvironment();
+    mPanel = new QWidget();
+    mSplitter = new QSplitter(mPanel);
+    mLeftPageWidget = new QTabWidget(mSplitter);
+    mRightPageWidget = new QTabWidget(mSplitter);
+    mEditorList = new EditorList(mLeftPageWidget, mRightPageWidget, mSplitter, mPanel);
+
+    //no "Ver" key: the project uses the default options
+    mProjectFile = filePath("big.dev");
+    QFile file(mProjectFile);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    QTextStream stream(&file);
+    stream << "[Project]\n"
+           << "FileName=big.dev\n"
+           << "Name=big\n"
+           << QString("UnitCount=%1\n").arg(TEST_FOLDERS*TEST_FOLDER_FILES);
+    int unit = 0;
+    for (int i=0;i<TEST_FOLDERS;i++) {
+        for (int j=0;j<TEST_FOLDER_FILES;j++) {
+            unit++;
+            stream << QString("[Unit%1]\n").arg(unit)
+                   << QString("FileName=%1\n").arg(unitName(i,j));
+        }
+    }
+}
+
+void TestProject::cleanupTestCase()
+{
+    delete mEditorList;
+    delete mPanel;
+    delete mEnvironment;
+}
+
+std::shared_ptr<Project> TestProject::load()
+{
+    return Project::load(mProjectFile, mEditorList, &mWatcher);
+}
+
+QString TestProject::filePath(const QString &name) const
+{
+    return mEnvironment->tempPath(name);
+}
+
+//half of the files in each folder are headers
+QString TestProject::unitName(int folder, int file)
+{
+    return QString("d%1/f%2.%3").arg(folder).arg(file).arg(file%2==0?"cpp":"h");
+}
+
+PProjectModelNode TestProject::specialNode(const std::shared_ptr<Project> &project, ProjectModelNodeType type)
+{
+    foreach (const PProjectModelNode& node, project->rootNode()->children) {
+        if (node->folderNodeType == type)
+            return node;
+    }
+    return PProjectModelNode();
+}
+
+PProjectModelNode TestProject::childFolder(const PProjectModelNode &parent, const QString &name)
+{
+    if (!parent)
+        return PProjectModelNode();
+    foreach (const PProjectModelNode& node, parent->children) {
+        if (node->folderNodeType == ProjectModelNodeType::Folder && node->text == name)
+            return node;
+    }
+    return PProjectModelNode();
+}
+
+void TestProject::open()
+{
+    QElapsedTimer timer;
+    timer.start();
+    std::shared_ptr<Project> project = load();
+    QTest::setBenchmarkResult(timer.nsecsElapsed() / 1000000.0, QTest::WalltimeMilliseconds);
+
+    QCOMPARE(project->unitList().count(), TEST_FOLDERS*TEST_FOLDER_FILES);
+    PProjectModelNode sources = specialNode(project, ProjectModelNodeType::DUMMY_SOURCES_FOLDER);
+    PProjectModelNode headers = specialNode(project, ProjectModelNodeType::DUMMY_HEADERS_FOLDER);
+    QVERIFY(sources);
+    QVERIFY(headers);
+    QCOMPARE(sources->children.count(), TEST_FOLDERS);
+    QCOMPARE(headers->children.count(), TEST_FOLDERS);
+    PProjectModelNode folder = childFolder(sources, "d0");
+    QVERIFY(folder);
+    QCOMPARE(folder->children.count(), TEST_FOLDER_FILES/2);
+}
+
+void TestProject::addUnits()
+{
+    std::shared_ptr<Project> project = load();
+    //10 new folders, each in a new parent folder
+    QList<PProjectUnit> units;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i=0;i<TEST_ADDS;i++) {
+        units.append(project->addUnit(QString("added/a%1/f%2.cpp").arg(i%10).arg(i),
+                                      PProjectModelNode()));
+    }
+    QTest::setBenchmarkResult(timer.nsecsElapsed() / 1000000.0 / TEST_ADDS, QTest::WalltimeMilliseconds);
+
+    foreach (const PProjectUnit& unit, units)
+        QVERIFY(unit);
+    QCOMPARE(project->unitList().count(), TEST_FOLDERS*TEST_FOLDER_FILES + TEST_ADDS);
+    //units are found by the name they are stored under
+    QVERIFY(project->fileAlreadyExists(QDir(project->directory()).absoluteFilePath("added/a0/f0.cpp")));
+    PProjectModelNode sources = specialNode(project, ProjectModelNodeType::DUMMY_SOURCES_FOLDER);
+    PProjectModelNode added = childFolder(sources, "added");
+    QVERIFY(added);
+    QCOMPARE(added->children.count(), 10);
+    PProjectModelNode folder = childFolder(added, "a0");
+    QVERIFY(folder);
+    QCOMPARE(folder->children.count(), TEST_ADDS/10);
+    QCOMPARE(units[0]->node()->parent.lock(), folder);
+}
+
+void TestProject::renameUnits()
+{
+    std::shared_ptr<Project> project = load();
+    QDir dir(project->directory());
+    QList<PProjectUnit> units;
+    for (int i=0;i<TEST_FOLDER_FILES;i++) {
+        PProjectUnit unit = project->findUnit(dir.absoluteFilePath(unitName(0,i)));
+        QVERIFY(unit);
+        units.append(unit);
+    }
+    //move all files of a folder to a new one
+    QElapsedTimer timer;
+    timer.start();
+    for (int i=0;i<units.count();i++) {
+        project->renameUnit(units[i], dir.absoluteFilePath(QString("moved/f%1.%2")
+                                                           .arg(i).arg(i%2==0?"cpp":"h")));
+    }
+    QTest::setBenchmarkResult(timer.nsecsElapsed() / 1000000.0 / units.count(), QTest::WalltimeMilliseconds);
+
+    QCOMPARE(project->unitList().count(), TEST_FOLDERS*TEST_FOLDER_FILES);
+    PProjectModelNode sources = specialNode(project, ProjectModelNodeType::DUMMY_SOURCES_FOLDER);
+    PProjectModelNode headers = specialNode(project, ProjectModelNodeType::DUMMY_HEADERS_FOLDER);
+    QVERIFY(!childFolder(sources, "d0"));
+    QVERIFY(!childFolder(headers, "d0"));
+    PProjectModelNode moved = childFolder(sources, "moved");
+    QVERIFY(moved);
+    QCOMPARE(moved->children.count(), TEST_FOLDER_FILES/2);
+    QVERIFY(!project->findUnit(dir.absoluteFilePath(unitName(0,0))));
+
+    //the emptied folder was forgotten, a new file in it gets a shown node
+    PProjectUnit unit = project->addUnit("d0/again.cpp", PProjectModelNode());
+    QVERIFY(unit);
+    PProjectModelNode folder = childFolder(sources, "d0");
+    QVERIFY(folder);
+    QCOMPARE(unit->node()->parent.lock(), folder);
+}
+
+QTEST_MAIN(TestProject)
+
+#include "tst_project.moc"
@@ -0,0 +1,26 @@
+# Settings of a test program linked with the ide library.
+# Run the tests with "make check".
+
+include(ide.pri)
+
+QT += testlib
+
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+# the forms are compiled in the ide library
+INCLUDEPATH += $$PWD $$OUT_PWD/../ide
+
+LIBS += -L$$OUT_PWD/../ide/$$OBJ_OUT_PWD \
+    -L$$OUT_PWD/../../libs/redpanda_qt_utils/$$OBJ_OUT_PWD \
+    -L$$OUT_PWD/../../libs/qsynedit/$$OBJ_OUT_PWD \
+    -lide -lqsynedit -lredpanda_qt_utils
+
+linux: {
+    LIBS+= \
+    -lrt
+}
+
+HEADERS += \
+    $$PWD/testenvironment.h
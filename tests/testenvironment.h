@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef TESTENVIRONMENT_H
+#define TESTENVIRONMENT_H
+
+#include <QTemporaryDir>
+#include <memory>
+#include "settings.h"
+#include "systemconsts.h"
+#include "parser/parserutils.h"
+#include "qt_utils/charsetinfo.h"
+
+/**
+ * @brief The globals the ide's classes rely on, set up like main() does,
+ * with the settings kept in a temporary folder.
+ */
+class TestEnvironment {
+public:
+    TestEnvironment():
+        mCharsetInfoManager("en")
+    {
+        pSystemConsts = &mSystemConsts;
+        pCharsetInfoManager = &mCharsetInfoManager;
+        initParser();
+        mSettings = std::make_unique<Settings>(mConfigDir.filePath("redpandacpp.ini"));
+        pSettings = mSettings.get();
+        pSettings->load();
+    }
+    ~TestEnvironment() {
+        pSettings = nullptr;
+        mSettings.reset();
+        pCharsetInfoManager = nullptr;
+        pSystemConsts = nullptr;
+    }
+    TestEnvironment(const TestEnvironment&) = delete;
+    TestEnvironment& operator=(const TestEnvironment&) = delete;
+
+    QString tempPath(const QString& fileName) const {
+        return mConfigDir.filePath(fileName);
+    }
+private:
+    QTemporaryDir mConfigDir;
+    SystemConsts mSystemConsts;
+    CharsetInfoManager mCharsetInfoManager;
+    std::unique_ptr<Settings> mSettings;
+};
+
+#endif // TESTENVIRONMENT_H
@@ -0,0 +1,21 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    ide \
+    classbrowser \
+    competitivecompanionreceiver \
+    gdbmilinebuffer \
+    gdbmiresultparser \
+    gitrepository \
+    ojproblemcasesrunner \
+    ojproblemset \
+    project
+
+classbrowser.depends = ide
+competitivecompanionreceiver.depends = ide
+gdbmilinebuffer.depends = ide
+gdbmiresultparser.depends = ide
+gitrepository.depends = ide
+ojproblemcasesrunner.depends = ide
+ojproblemset.depends = ide
+project.depends = ide
@@ -0,0 +1,21 @@
+QT -= gui core
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+isEmpty(APP_NAME) {
+    APP_NAME = RedPandaCPP
+}
+
+SOURCES += \
+    main.cpp
+
+isEmpty(PREFIX) {
+    PREFIX = /usr/local
+}
+
+# Default rules for deployment.
+qnx: target.path = $${PREFIX}/libexec/$${APP_NAME}
+else: unix:!android: target.path = $${PREFIX}/libexec/$${APP_NAME}
+!isEmpty(target.path): INSTALLS += target
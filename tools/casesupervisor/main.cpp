@@ -0,0 +1,313 @@
+/*
+ *  This file is part of Red Panda C++
+ *  Copyright (C) 2020-2022 Roy Qu (royqh1979@gmail.com)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Runs a problem case program under resource limits, and reports how it
+ * ended and what it used.
+ *
+ * Usage: casesupervisor [--trace-allocations] <report_file> <cpu_limit_ms> <memory_limit_kb> <program> [arguments]
+ *
+ * A limit of 0 means no limit. stdin/stdout/stderr are passed to the program.
+ * When the program ends, one line is written to the report file:
+ *
+ *   <started> <exit_code> <signal> <cpu_time_ms> <peak_memory_kb> <memory_limit_hit>
+ *
+ * started is 0 if the program can't be executed, and exit_code is the errno then.
+ *
+ * The memory limit is enforced with RLIMIT_AS. Allocations beyond it fail
+ * before the memory is used, so the limit is taken as hit when the program
+ * fails (exits with an error or is killed by a signal) and its peak memory is
+ * close to the limit.
+ *
+ * With --trace-allocations, the program is traced instead, and the supervisor
+ * stops it at its mmap / mremap calls to see if they fail with ENOMEM. This is
+ * exact, but the stops slow down programs that allocate a lot and skew their
+ * times, so it is off by default. It needs linux 5.3 or later
+ * (PTRACE_GET_SYSCALL_INFO), and is ignored on older kernels.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <sys/prctl.h>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/utsname.h>
+#include <sys/wait.h>
+
+//an untraced program hits the memory limit if its peak is above this part of it
+#define MEMORY_LIMIT_NEAR_PERCENT 90
+
+#ifdef PTRACE_GET_SYSCALL_INFO
+#define ALLOCATIONS_TRACEABLE
+#endif
+
+static bool writeReport(const char* reportFile, int started, int exitCode, int signal,
+                        long long cpuTime, long peakMemory, bool memoryLimitHit)
+{
+    FILE* file = fopen(reportFile, "w");
+    if (!file)
+        return false;
+    fprintf(file, "%d %d %d %lld %ld %d\n", started, exitCode, signal, cpuTime, peakMemory,
+            memoryLimitHit?1:0);
+    return fclose(file)==0;
+}
+
+//PTRACE_GET_SYSCALL_INFO is added in linux 5.3
+static bool kernelCanTraceAllocations()
+{
+#ifdef ALLOCATIONS_TRACEABLE
+    struct utsname name;
+    if (uname(&name) == -1)
+        return false;
+    int major = 0;
+    int minor = 0;
+    if (sscanf(name.release, "%d.%d", &major, &minor) != 2)
+        return false;
+    return major > 5 || (major == 5 && minor >= 3);
+#else
+    return false;
+#endif
+}
+
+#ifdef ALLOCATIONS_TRACEABLE
+//makes the allocation calls of the (traced) program stop for the tracer
+static bool traceAllocations()
+{
+    static const unsigned int allocationCalls[] = {
+        __NR_mmap,
+#ifdef __NR_mmap2
+        __NR_mmap2,
+#endif
+        __NR_mremap
+    };
+    const unsigned int count = sizeof(allocationCalls)/sizeof(allocationCalls[0]);
+    struct sock_filter filter[count+3];
+    filter[0] = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr));
+    for (unsigned int i=0;i<count;i++)
+        filter[i+1] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, allocationCalls[i],
+                               (unsigned char)(count-i), 0);
+    filter[count+1] = BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+    filter[count+2] = BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_TRACE);
+    struct sock_fprog program;
+    program.len = count+3;
+    program.filter = filter;
+    if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == -1)
+        return false;
+    return prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program) == 0;
+}
+
+//resumes a stopped thread of the traced program, and checks the allocations it made
+static void resumeTracee(pid_t tracee, int status, bool& memoryLimitHit)
+{
+    int event = status >> 16;
+    int signal = WSTOPSIG(status);
+    if (event == PTRACE_EVENT_SECCOMP) {
+        //an allocation starts, stop again when it returns
+        ptrace(PTRACE_SYSCALL, tracee, 0, 0);
+    } else if (signal == (SIGTRAP | 0x80)) {
+        struct __ptrace_syscall_info info;
+        memset(&info, 0, sizeof(info));
+        ptrace(PTRACE_GET_SYSCALL_INFO, tracee, sizeof(info), &info);
+        if (info.op == PTRACE_SYSCALL_INFO_ENTRY) {
+            ptrace(PTRACE_SYSCALL, tracee, 0, 0);
+            return;
+        }
+        if (info.op == PTRACE_SYSCALL_INFO_EXIT
+                && info.exit.is_error && info.exit.rval == -ENOMEM)
+            memoryLimitHit = true;
+        ptrace(PTRACE_CONT, tracee, 0, 0);
+    } else if (event == PTRACE_EVENT_STOP
+               && (signal == SIGSTOP || signal == SIGTSTP
+                   || signal == SIGTTIN || signal == SIGTTOU)) {
+        //the program is stopped by a signal, keep it stopped
+        ptrace(PTRACE_LISTEN, tracee, 0, 0);
+    } else if (event != 0) {
+        //new threads / processes (they start stopped), exec, exit
+        ptrace(PTRACE_CONT, tracee, 0, 0);
+    } else {
+        //signals are passed to the program
+        ptrace(PTRACE_CONT, tracee, 0, signal);
+    }
+}
+#endif
+
+static void applyLimits(long long cpuLimit, long long memoryLimit)
+{
+    struct rlimit limit;
+    if (cpuLimit>0) {
+        //RLIMIT_CPU counts in seconds; SIGXCPU is sent at the soft limit,
+        //and the program is killed at the hard limit if it ignores it
+        limit.rlim_cur = (cpuLimit + 999) / 1000;
+        limit.rlim_max = limit.rlim_cur + 1;
+        setrlimit(RLIMIT_CPU, &limit);
+    }
+    if (memoryLimit>0) {
+        limit.rlim_cur = memoryLimit * 1024;
+        limit.rlim_max = limit.rlim_cur;
+        setrlimit(RLIMIT_AS, &limit);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool traceRequested = false;
+    if (argc > 1 && strcmp(argv[1], "--trace-allocations") == 0) {
+        traceRequested = true;
+        argc--;
+        argv++;
+    }
+    if (argc < 5) {
+        fprintf(stderr, "Usage: casesupervisor [--trace-allocations] <report_file> <cpu_limit_ms> <memory_limit_kb> <program> [arguments]\n");
+        return EXIT_FAILURE;
+    }
+    const char* reportFile = argv[1];
+    long long cpuLimit = atoll(argv[2]);
+    long long memoryLimit = atoll(argv[3]);
+    bool traceWanted = traceRequested && memoryLimit>0 && kernelCanTraceAllocations();
+
+    //the child reports exec failures through this pipe; it's closed on a successful exec
+    int execPipe[2];
+    if (pipe(execPipe)==-1) {
+        perror("pipe failed");
+        return EXIT_FAILURE;
+    }
+    fcntl(execPipe[1], F_SETFD, FD_CLOEXEC);
+    //the child waits until it is traced, and is told if it is
+    int tracePipe[2];
+    if (pipe(tracePipe)==-1) {
+        perror("pipe failed");
+        return EXIT_FAILURE;
+    }
+
+    pid_t parentPid = getpid();
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork failed");
+        return EXIT_FAILURE;
+    }
+    if (pid == 0) {
+        close(execPipe[0]);
+        close(tracePipe[1]);
+        //the ide stops a case by killing the supervisor, take the program with it
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (getppid()!=parentPid)
+            _exit(EXIT_FAILURE);
+        char traced = 0;
+        while (read(tracePipe[0], &traced, 1) == -1 && errno == EINTR)
+            ;
+        close(tracePipe[0]);
+#ifdef ALLOCATIONS_TRACEABLE
+        //allocation calls fail with ENOSYS if the filter is set on a program not traced
+        if (traced)
+            traceAllocations();
+#endif
+        applyLimits(cpuLimit, memoryLimit);
+        execv(argv[4], argv+4);
+        int error = errno;
+        ssize_t written = write(execPipe[1], &error, sizeof(error));
+        (void)written;
+        _exit(127);
+    }
+    close(execPipe[1]);
+    close(tracePipe[0]);
+    char traced = 0;
+#ifdef ALLOCATIONS_TRACEABLE
+    //threads and child processes of the program are traced too, or their
+    //allocation calls would fail; the program is killed if the supervisor dies
+    traced = traceWanted
+            && ptrace(PTRACE_SEIZE, pid, 0,
+                      PTRACE_O_TRACESECCOMP | PTRACE_O_TRACESYSGOOD
+                      | PTRACE_O_TRACECLONE | PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK
+                      | PTRACE_O_EXITKILL) == 0;
+#else
+    (void)traceWanted;
+#endif
+    ssize_t tracedWritten = write(tracePipe[1], &traced, 1);
+    (void)tracedWritten;
+    close(tracePipe[1]);
+    //the supervisor doesn't use the standard streams, only the program should hold them
+    int nullFd = open("/dev/null", O_RDWR);
+    if (nullFd!=-1) {
+        dup2(nullFd, STDIN_FILENO);
+        dup2(nullFd, STDOUT_FILENO);
+        close(nullFd);
+    }
+
+    int execError = 0;
+    ssize_t count;
+    do {
+        count = read(execPipe[0], &execError, sizeof(execError));
+    } while (count == -1 && errno == EINTR);
+    close(execPipe[0]);
+
+    int status;
+    struct rusage usage;
+    bool memoryLimitHit = false;
+    while (true) {
+        pid_t w = wait4(traced?-1:pid, &status, traced?__WALL:0, &usage);
+        if (w == -1) {
+            if (errno == EINTR)
+                continue;
+            perror("wait4 failed");
+            return EXIT_FAILURE;
+        }
+        if (w == pid && !WIFSTOPPED(status))
+            break;
+#ifdef ALLOCATIONS_TRACEABLE
+        if (WIFSTOPPED(status))
+            resumeTracee(w, status, memoryLimitHit);
+#endif
+    }
+    if (count == sizeof(execError)) {
+        fprintf(stderr, "Failed to start %s: %s\n", argv[4], strerror(execError));
+        writeReport(reportFile, 0, execError, 0, 0, 0, false);
+        return 127;
+    }
+
+    long long cpuTime = (long long)usage.ru_utime.tv_sec * 1000 + usage.ru_utime.tv_usec / 1000
+            + (long long)usage.ru_stime.tv_sec * 1000 + usage.ru_stime.tv_usec / 1000;
+    //ru_maxrss is in kilobytes on linux
+    long peakMemory = usage.ru_maxrss;
+    int exitCode = 0;
+    int signal = 0;
+    if (WIFEXITED(status)) {
+        exitCode = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        signal = WTERMSIG(status);
+        exitCode = 128 + signal;
+    }
+    if (!traced && memoryLimit>0)
+        memoryLimitHit = (exitCode!=0 || signal!=0)
+                && peakMemory*100 >= memoryLimit*MEMORY_LIMIT_NEAR_PERCENT;
+    if (!writeReport(reportFile, 1, exitCode, signal, cpuTime, peakMemory, memoryLimitHit)) {
+        perror("write report failed");
+        return EXIT_FAILURE;
+    }
+    return exitCode;
+}